@@ -17,6 +17,7 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <thread>
 
 #include <QtCore/QThread>
@@ -26,20 +27,46 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <jass/GraphModel.hpp>
 #include "Analyses.hpp"
 #include "AnalysisWorker.hpp"
+#include "DepthQueryWorker.hpp"
+#include "FlowSimulationWorker.hpp"
 
 #include "analyses/DepthAnalysis.h"
 #include "analyses/IntegrationAnalysis.h"
+#include "analyses/MovementPotentialAnalysis.h"
 
 namespace jass
 {
+	// Depth query results are one float per node, so the number kept is bounded by bytes rather than count
+	static const size_t DEPTH_QUERY_CACHE_MAX_SIZE = 64;
+	static const size_t DEPTH_QUERY_CACHE_BUDGET = 32 * 1024 * 1024;
+
+	static size_t DepthQueryCacheCapacity(size_t node_count)
+	{
+		const auto result_byte_size = std::max<size_t>(1, node_count) * sizeof(float);
+		return std::clamp<size_t>(DEPTH_QUERY_CACHE_BUDGET / result_byte_size, 1, DEPTH_QUERY_CACHE_MAX_SIZE);
+	}
+
+	const QString CAnalyses::DEPTH_FROM_NODE_METRIC = "Depth From Node";
+	const QString CAnalyses::FLOW_OCCUPANCY_METRIC = "Flow Occupancy";
+	const QString CAnalyses::FLOW_METRIC = "Flow";
+
 	CAnalyses::CAnalyses()
 		: m_Worker(new CAnalysisWorker)
+		, m_DepthQueryWorker(new CDepthQueryWorker)
+		, m_DepthQueryCache(DEPTH_QUERY_CACHE_MAX_SIZE)
+		, m_FlowSimulationWorker(new CFlowSimulationWorker)
 	{
 		connect(m_Worker.get(), &CAnalysisWorker::MetricDone, this, &CAnalyses::OnMetricDone, Qt::QueuedConnection);
+		connect(m_Worker.get(), &CAnalysisWorker::DepthMatrixDone, this, &CAnalyses::OnDepthMatrixDone, Qt::QueuedConnection);
 		connect(m_Worker.get(), &CAnalysisWorker::AnalysisPassComplete, this, &CAnalyses::OnAnalysisPassComplete, Qt::QueuedConnection);
+		connect(m_DepthQueryWorker.get(), &CDepthQueryWorker::QueryDone, this, &CAnalyses::OnDepthQueryDone, Qt::QueuedConnection);
+		connect(m_FlowSimulationWorker.get(), &CFlowSimulationWorker::StepDone, this, &CAnalyses::OnFlowSimulationStepDone, Qt::QueuedConnection);
+		connect(m_FlowSimulationWorker.get(), &CFlowSimulationWorker::SimulationDone, this, &CAnalyses::OnFlowSimulationDone, Qt::QueuedConnection);
 
 		AddAnalysis(std::make_shared<CDepthAnalysis>());
-		AddAnalysis(std::make_shared<CIntegrationAnalysis>());
+		AddAnalysis(std::make_shared<CMovementPotentialAnalysis>());
+		m_IntegrationAnalysis = std::make_shared<CIntegrationAnalysis>();
+		AddAnalysis(m_IntegrationAnalysis);
 	}
 
 	CAnalyses::~CAnalyses()
@@ -96,6 +123,164 @@ namespace jass
 		}
 	}
 
+	void CAnalyses::OnDepthMatrixDone()
+	{
+		// Make sure we are on correct thread
+		ASSERT(thread() == QThread::currentThread());
+
+		if (m_UpdateIsPending)
+		{
+			// Depth matrix is no longer valid
+			return;
+		}
+
+		m_Worker->TryGrabDepthMatrix(m_DepthMatrix);
+	}
+
+	void CAnalyses::SetDepthMatrixBudget(size_t byte_budget)
+	{
+		m_IntegrationAnalysis->SetDepthMatrixBudget(byte_budget);
+	}
+
+	size_t CAnalyses::DepthMatrixBudget() const
+	{
+		return m_IntegrationAnalysis->DepthMatrixBudget();
+	}
+
+	void CAnalyses::RequestDepthFromNode(size_t node_index)
+	{
+		m_DepthQuerySourceNodeIndex = node_index;
+
+		if (const auto* depth_values = m_DepthQueryCache.find(node_index))
+		{
+			emit MetricUpdated(DEPTH_FROM_NODE_METRIC, *depth_values);
+			return;
+		}
+
+		const auto& graph = GraphSnapshot();
+		if (node_index >= graph->NodeCount())
+		{
+			return;
+		}
+
+		m_DepthQueryWorker->Request(graph, m_GraphGeneration, node_index);
+	}
+
+	bool CAnalyses::FindShortestPaths(size_t from_node_index, size_t to_node_index, size_t max_path_count, std::vector<path_t>& out_paths)
+	{
+		return m_ShortestPathSearch.FindShortestPaths(*GraphSnapshot(), from_node_index, to_node_index, max_path_count, out_paths);
+	}
+
+	void CAnalyses::RunFlowSimulation(std::vector<size_t> origin_node_indices, std::vector<size_t> destination_node_indices, const CFlowSimulation::SSettings& settings)
+	{
+		m_FlowSimulationWorker->Start(GraphSnapshot(), m_GraphGeneration, std::move(origin_node_indices), std::move(destination_node_indices), settings);
+	}
+
+	int CAnalyses::FlowEdgeTraversals(size_t node_index_a, size_t node_index_b) const
+	{
+		if (m_FlowEdgeTraversals.empty() || std::max(node_index_a, node_index_b) >= m_FlowGraph.NodeCount())
+		{
+			return -1;
+		}
+
+		const auto columns = m_FlowGraph.Columns();
+		auto edge_traversals = [&](size_t from_node_index, size_t to_node_index) -> uint32_t
+		{
+			const auto row_begin = m_FlowGraph.RowOffsets()[from_node_index];
+			const auto row_end = m_FlowGraph.RowOffsets()[from_node_index + 1];
+			for (auto edge_index = row_begin; edge_index < row_end; ++edge_index)
+			{
+				if (columns[edge_index] == to_node_index)
+				{
+					return m_FlowEdgeTraversals[edge_index];
+				}
+			}
+			return 0;
+		};
+		return (int)(edge_traversals(node_index_a, node_index_b) + edge_traversals(node_index_b, node_index_a));
+	}
+
+	const std::shared_ptr<const CImmutableDirectedGraph>& CAnalyses::GraphSnapshot()
+	{
+		if (!m_GraphSnapshot)
+		{
+			m_GraphSnapshot = std::make_shared<const CImmutableDirectedGraph>(m_UpdateIsPending ? m_PendingGraph : m_BusyGraph);
+		}
+		return m_GraphSnapshot;
+	}
+
+	void CAnalyses::OnDepthQueryDone()
+	{
+		// Make sure we are on correct thread
+		ASSERT(thread() == QThread::currentThread());
+
+		size_t generation, source_node_index;
+		std::vector<float> depth_values;
+		while (m_DepthQueryWorker->TryGrabResult(generation, source_node_index, depth_values))
+		{
+			if (generation != m_GraphGeneration)
+			{
+				// Graph has changed since the query was made
+				continue;
+			}
+			const auto& cached_depth_values = m_DepthQueryCache.insert(source_node_index, std::move(depth_values));
+			if (source_node_index == m_DepthQuerySourceNodeIndex)
+			{
+				emit MetricUpdated(DEPTH_FROM_NODE_METRIC, cached_depth_values);
+			}
+		}
+	}
+
+	void CAnalyses::OnFlowSimulationStepDone()
+	{
+		// Make sure we are on correct thread
+		ASSERT(thread() == QThread::currentThread());
+
+		size_t generation, step;
+		std::vector<float> node_occupancy;
+		if (!m_FlowSimulationWorker->TryGrabStep(generation, step, node_occupancy) || generation != m_GraphGeneration)
+		{
+			return;
+		}
+
+		UpdateMetric(FLOW_OCCUPANCY_METRIC, std::move(node_occupancy));
+	}
+
+	void CAnalyses::OnFlowSimulationDone()
+	{
+		// Make sure we are on correct thread
+		ASSERT(thread() == QThread::currentThread());
+
+		size_t generation;
+		std::vector<float> node_traversals;
+		CCsrGraph graph;
+		std::vector<uint32_t> edge_traversals;
+		if (!m_FlowSimulationWorker->TryGrabResult(generation, node_traversals, graph, edge_traversals) || generation != m_GraphGeneration)
+		{
+			return;
+		}
+
+		m_FlowGraph = std::move(graph);
+		m_FlowEdgeTraversals = std::move(edge_traversals);
+
+		UpdateMetric(FLOW_METRIC, std::move(node_traversals));
+	}
+
+	void CAnalyses::UpdateMetric(const QString& name, std::vector<float>&& values)
+	{
+		int metric_index = FindMetricIndex(name);
+		if (metric_index < 0)
+		{
+			metric_index = (int)m_Metrics.size();
+			m_Metrics.push_back({ name, std::move(values) });
+		}
+		else
+		{
+			m_Metrics[metric_index].Values = std::move(values);
+		}
+		emit MetricUpdated(name, m_Metrics[metric_index].Values);
+	}
+
 	void CAnalyses::OnAnalysisPassComplete(bool cancelled)
 	{
 		// Make sure we are on correct thread
@@ -131,7 +316,18 @@ namespace jass
 			{
 				metric.Values.clear();
 			}
+			m_DepthMatrix.reset();
 		}
+
+		// Invalidate graph snapshot, depth queries and flow simulation
+		m_GraphSnapshot.reset();
+		++m_GraphGeneration;
+		m_DepthQueryCache.clear();
+		m_DepthQueryCache.set_capacity(DepthQueryCacheCapacity(graph_model.NodeCount()));
+		m_FlowSimulationWorker->Cancel();
+		m_FlowGraph = CCsrGraph();
+		m_FlowEdgeTraversals.clear();
+
 		m_PendingGraph.CopyView(CGraphModelImmutableDirectedGraphAdapter(graph_model));
 		
 		m_PendingAttributes.resize(graph_model.AttributeCount());
@@ -28,18 +28,33 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <QtCore/qobject.h>
 #include <QtCore/qstring.h>
 
+#include <jass/analysis/BidirectionalBfs.h>
+#include <jass/analysis/CsrGraph.h>
+#include <jass/analysis/DepthMatrix.h>
+#include <jass/analysis/FlowSimulation.h>
 #include <jass/analysis/ImmutableDirectedGraph.h>
+#include <jass/utils/lru_cache.h>
 
 namespace jass
 {
 	class IAnalysis;
 	class CAnalysisWorker;
+	class CDepthQueryWorker;
+	class CFlowSimulationWorker;
 	class CGraphModel;
+	class CIntegrationAnalysis;
 
 	class CAnalyses: public QObject
 	{
 		Q_OBJECT
 	public:
+		// Name of the metric emitted in response to RequestDepthFromNode
+		static const QString DEPTH_FROM_NODE_METRIC;
+
+		// Names of the metrics emitted by RunFlowSimulation
+		static const QString FLOW_OCCUPANCY_METRIC;
+		static const QString FLOW_METRIC;
+
 		CAnalyses();
 		~CAnalyses();
 
@@ -57,18 +72,53 @@ namespace jass
 
 		int FindMetricIndex(const QString& name) const;
 
+		// Step depth between two nodes, or -1 if not (yet) known
+		inline int Depth(size_t from_node_index, size_t to_node_index) const;
+
+		// Max number of bytes to spend on keeping the all-pairs depth matrix (0 = disabled)
+		void SetDepthMatrixBudget(size_t byte_budget);
+
+		size_t DepthMatrixBudget() const;
+
+		// Calculates depth from 'node_index' in the background, unless cached, and emits it
+		// as DEPTH_FROM_NODE_METRIC. Only the most recently requested node will be emitted.
+		void RequestDepthFromNode(size_t node_index);
+
+		typedef CBidirectionalBfs<CImmutableDirectedGraph>::path_t path_t;
+
+		// Finds up to 'max_path_count' equal-length shortest paths between two nodes
+		bool FindShortestPaths(size_t from_node_index, size_t to_node_index, size_t max_path_count, std::vector<path_t>& out_paths);
+
+		// Simulates agents walking between origin and destination nodes in the background. Agent
+		// count per node is emitted as FLOW_OCCUPANCY_METRIC after each step, and total number of
+		// agents that passed each node as FLOW_METRIC when done. Cancelled if the graph changes.
+		void RunFlowSimulation(std::vector<size_t> origin_node_indices, std::vector<size_t> destination_node_indices, const CFlowSimulation::SSettings& settings);
+
+		// Number of agents that walked the edge between two nodes, in either direction, during the
+		// last completed flow simulation, or -1 if not known
+		int FlowEdgeTraversals(size_t node_index_a, size_t node_index_b) const;
+
 	Q_SIGNALS:
 		void MetricUpdated(const QString& name, const std::span<const float>& values);
 
 	private Q_SLOTS:
 		void OnMetricDone();
+		void OnDepthMatrixDone();
+		void OnDepthQueryDone();
+		void OnFlowSimulationStepDone();
+		void OnFlowSimulationDone();
 		void OnAnalysisPassComplete(bool cancelled);
 
 	private:
+		// Snapshot of the most recent graph, safe to share with background threads
+		const std::shared_ptr<const CImmutableDirectedGraph>& GraphSnapshot();
+
 		void CancelAnalysisPass();
 
 		void StartAnalysisPass();
 
+		void UpdateMetric(const QString& name, std::vector<float>&& values);
+
 		struct SMetric
 		{
 			QString Name;
@@ -79,11 +129,23 @@ namespace jass
 		bool m_AnalysisPassIsInProgress = false;
 		std::unique_ptr<CAnalysisWorker> m_Worker;
 		std::vector<std::shared_ptr<IAnalysis>> m_Analyses;
+		std::shared_ptr<CIntegrationAnalysis> m_IntegrationAnalysis;
 		std::vector<SMetric> m_Metrics;
+		std::shared_ptr<const CDepthMatrix> m_DepthMatrix;
 		CImmutableDirectedGraph m_PendingGraph;
 		std::vector<std::pair<QString, QVariant>> m_PendingAttributes;
 		CImmutableDirectedGraph m_BusyGraph;
 		std::vector<std::pair<QString, QVariant>> m_BusyAttributes;
+
+		std::shared_ptr<const CImmutableDirectedGraph> m_GraphSnapshot;
+		std::unique_ptr<CDepthQueryWorker> m_DepthQueryWorker;
+		size_t m_GraphGeneration = 0;
+		size_t m_DepthQuerySourceNodeIndex = (size_t)-1;
+		lru_cache<size_t, std::vector<float>> m_DepthQueryCache;
+		CBidirectionalBfs<CImmutableDirectedGraph> m_ShortestPathSearch;
+		std::unique_ptr<CFlowSimulationWorker> m_FlowSimulationWorker;
+		CCsrGraph m_FlowGraph;
+		std::vector<uint32_t> m_FlowEdgeTraversals;
 	};
 
 	inline float CAnalyses::MetricValue(size_t metric_index, size_t node_index) const
@@ -91,4 +153,14 @@ namespace jass
 		const auto& metric = m_Metrics[metric_index];
 		return (node_index < metric.Values.size()) ? metric.Values[node_index] : std::numeric_limits<float>::quiet_NaN();
 	}
+
+	inline int CAnalyses::Depth(size_t from_node_index, size_t to_node_index) const
+	{
+		if (!m_DepthMatrix)
+		{
+			return -1;
+		}
+		const auto depth = m_DepthMatrix->Depth(from_node_index, to_node_index);
+		return (CDepthMatrix::NO_DEPTH == depth) ? -1 : (int)depth;
+	}
 }
\ No newline at end of file
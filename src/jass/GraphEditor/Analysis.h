@@ -19,6 +19,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 class QString;
@@ -27,6 +28,7 @@ class QVariant;
 namespace jass
 {
 	class IAnalysisContext;
+	class CDepthMatrix;
 	class CImmutableDirectedGraph;
 
 	class IAnalysis
@@ -43,5 +45,6 @@ namespace jass
 		virtual bool TryGetGraphAttribute(const QString& name, QVariant& out_value) const = 0;
 		virtual std::vector<float> NewMetricVector() = 0;
 		virtual void OutputMetric(const QString& name, std::vector<float>&& values) = 0;
+		virtual void OutputDepthMatrix(std::shared_ptr<const CDepthMatrix> depth_matrix) = 0;
 	};
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <jass/analysis/DepthMatrix.h>
 #include <jass/Debug.h>
 #include "AnalysisWorker.hpp"
 
@@ -48,6 +49,8 @@ namespace jass
 				m_FreeMetricVectors.push_back(std::move(m_Metrics.back().Values));
 				m_Metrics.pop_back();
 			}
+			m_DepthMatrix.reset();
+			m_HasDepthMatrix = false;
 		}
 
 		m_AnalysisPassResult = std::async(std::launch::async, &CAnalysisWorker::AnalysisThread, this);
@@ -80,6 +83,21 @@ namespace jass
 		m_FreeMetricVectors.push_back(std::move(v));
 	}
 
+	bool CAnalysisWorker::TryGrabDepthMatrix(std::shared_ptr<const CDepthMatrix>& out_depth_matrix)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		if (!m_HasDepthMatrix)
+		{
+			return false;
+		}
+
+		out_depth_matrix = std::move(m_DepthMatrix);
+		m_HasDepthMatrix = false;
+
+		return true;
+	}
+
 	const CImmutableDirectedGraph& CAnalysisWorker::ImmutableDirectedGraph() const
 	{
 		return *m_Graph;
@@ -124,6 +142,17 @@ namespace jass
 		emit MetricDone();
 	}
 
+	void CAnalysisWorker::OutputDepthMatrix(std::shared_ptr<const CDepthMatrix> depth_matrix)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_DepthMatrix = std::move(depth_matrix);
+			m_HasDepthMatrix = true;
+		}
+
+		emit DepthMatrixDone();
+	}
+
 	void CAnalysisWorker::AnalysisThread()
 	{
 		for (auto& analysis : m_Analyses)
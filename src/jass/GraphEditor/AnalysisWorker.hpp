@@ -32,6 +32,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 namespace jass
 {
+	class CDepthMatrix;
 	class CImmutableDirectedGraph;
 
 	class CAnalysisWorker: public QObject, public IAnalysisContext
@@ -49,14 +50,18 @@ namespace jass
 
 		void ReturnMetricsVector(std::vector<float>&& v);
 
+		bool TryGrabDepthMatrix(std::shared_ptr<const CDepthMatrix>& out_depth_matrix);
+
 		// IAnalysisContext
 		const CImmutableDirectedGraph& ImmutableDirectedGraph() const override;
 		bool TryGetGraphAttribute(const QString& name, QVariant& out_value) const override;
 		std::vector<float> NewMetricVector() override;
 		void OutputMetric(const QString& name, std::vector<float>&& values) override;
+		void OutputDepthMatrix(std::shared_ptr<const CDepthMatrix> depth_matrix) override;
 
 	Q_SIGNALS:
 		void MetricDone();
+		void DepthMatrixDone();
 		void AnalysisPassComplete(bool cancelled);
 
 	private:
@@ -74,6 +79,8 @@ namespace jass
 		const std::vector<std::pair<QString, QVariant>>* m_GraphAttributes = nullptr;
 		std::vector<std::shared_ptr<IAnalysis>> m_Analyses;
 		std::vector<SMetric> m_Metrics;
+		std::shared_ptr<const CDepthMatrix> m_DepthMatrix;
+		bool m_HasDepthMatrix = false;
 		std::future<void> m_AnalysisPassResult;
 		std::mutex m_Mutex;
 		bool m_Cancelled = false;
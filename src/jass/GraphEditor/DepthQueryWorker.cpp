@@ -0,0 +1,109 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <jass/analysis/ImmutableDirectedGraph.h>
+#include <jass/Debug.h>
+#include "analyses/DepthAnalysis.h"
+#include "DepthQueryWorker.hpp"
+
+namespace jass
+{
+	CDepthQueryWorker::CDepthQueryWorker()
+		: m_DepthAnalysis(new CDepthAnalysis)
+	{
+	}
+
+	CDepthQueryWorker::~CDepthQueryWorker()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Request.reset();
+		}
+
+		if (m_QueryThreadResult.valid())
+		{
+			m_QueryThreadResult.wait();
+		}
+	}
+
+	void CDepthQueryWorker::Request(std::shared_ptr<const CImmutableDirectedGraph> graph, size_t generation, size_t source_node_index)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Request = SRequest{ std::move(graph), generation, source_node_index };
+			if (m_ThreadIsRunning)
+			{
+				// Running thread will pick up the request
+				return;
+			}
+			m_ThreadIsRunning = true;
+		}
+
+		m_QueryThreadResult = std::async(std::launch::async, &CDepthQueryWorker::QueryThread, this);
+	}
+
+	bool CDepthQueryWorker::TryGrabResult(size_t& out_generation, size_t& out_source_node_index, std::vector<float>& out_depth_values)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		if (m_Results.empty())
+		{
+			return false;
+		}
+
+		out_generation = m_Results.back().Generation;
+		out_source_node_index = m_Results.back().SourceNodeIndex;
+		out_depth_values = std::move(m_Results.back().DepthValues);
+		m_Results.pop_back();
+
+		return true;
+	}
+
+	void CDepthQueryWorker::QueryThread()
+	{
+		while (true)
+		{
+			SRequest request;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				if (!m_Request)
+				{
+					m_ThreadIsRunning = false;
+					return;
+				}
+				request = std::move(*m_Request);
+				m_Request.reset();
+			}
+
+			SResult result;
+			result.Generation = request.Generation;
+			result.SourceNodeIndex = request.SourceNodeIndex;
+			m_DepthAnalysis->CalculateDepth(*request.Graph, request.SourceNodeIndex, result.DepthValues);
+
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Results.push_back(std::move(result));
+			}
+
+			emit QueryDone();
+		}
+	}
+}
+
+#include <moc_DepthQueryWorker.cpp>
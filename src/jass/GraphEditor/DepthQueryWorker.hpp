@@ -0,0 +1,75 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <QtCore/qobject.h>
+
+namespace jass
+{
+	class CDepthAnalysis;
+	class CImmutableDirectedGraph;
+
+	// Calculates depth from a single node on a background thread. Only the most
+	// recent request is kept, requests that haven't started yet are dropped.
+	class CDepthQueryWorker: public QObject
+	{
+		Q_OBJECT
+	public:
+		CDepthQueryWorker();
+		~CDepthQueryWorker();
+
+		void Request(std::shared_ptr<const CImmutableDirectedGraph> graph, size_t generation, size_t source_node_index);
+
+		bool TryGrabResult(size_t& out_generation, size_t& out_source_node_index, std::vector<float>& out_depth_values);
+
+	Q_SIGNALS:
+		void QueryDone();
+
+	private:
+		void QueryThread();
+
+		struct SRequest
+		{
+			std::shared_ptr<const CImmutableDirectedGraph> Graph;
+			size_t Generation;
+			size_t SourceNodeIndex;
+		};
+
+		struct SResult
+		{
+			size_t Generation;
+			size_t SourceNodeIndex;
+			std::vector<float> DepthValues;
+		};
+
+		std::unique_ptr<CDepthAnalysis> m_DepthAnalysis;
+		std::optional<SRequest> m_Request;
+		std::vector<SResult> m_Results;
+		bool m_ThreadIsRunning = false;
+		std::mutex m_Mutex;
+		std::future<void> m_QueryThreadResult;
+	};
+}
@@ -0,0 +1,160 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <jass/analysis/ImmutableDirectedGraph.h>
+#include <jass/Debug.h>
+#include "FlowSimulationWorker.hpp"
+
+namespace jass
+{
+	CFlowSimulationWorker::CFlowSimulationWorker()
+	{
+	}
+
+	CFlowSimulationWorker::~CFlowSimulationWorker()
+	{
+		Cancel();
+
+		if (m_SimulationThreadResult.valid())
+		{
+			m_SimulationThreadResult.wait();
+		}
+	}
+
+	void CFlowSimulationWorker::Start(std::shared_ptr<const CImmutableDirectedGraph> graph, size_t generation, std::vector<size_t> origin_node_indices, std::vector<size_t> destination_node_indices, const CFlowSimulation::SSettings& settings)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Request = SRequest{ std::move(graph), generation, std::move(origin_node_indices), std::move(destination_node_indices), settings };
+			m_Cancelled = true;
+			if (m_ThreadIsRunning)
+			{
+				// Running thread will pick up the request once the current simulation has stopped
+				return;
+			}
+			m_ThreadIsRunning = true;
+		}
+
+		m_SimulationThreadResult = std::async(std::launch::async, &CFlowSimulationWorker::SimulationThread, this);
+	}
+
+	void CFlowSimulationWorker::Cancel()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Request.reset();
+		m_Cancelled = true;
+	}
+
+	bool CFlowSimulationWorker::TryGrabStep(size_t& out_generation, size_t& out_step, std::vector<float>& out_node_occupancy)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		if (!m_HasStep)
+		{
+			return false;
+		}
+
+		out_generation = m_StepGeneration;
+		out_step = m_Step;
+		std::swap(out_node_occupancy, m_NodeOccupancy);
+		m_HasStep = false;
+
+		return true;
+	}
+
+	bool CFlowSimulationWorker::TryGrabResult(size_t& out_generation, std::vector<float>& out_node_traversals, CCsrGraph& out_graph, std::vector<uint32_t>& out_edge_traversals)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		if (!m_HasResult)
+		{
+			return false;
+		}
+
+		out_generation = m_ResultGeneration;
+		out_node_traversals = std::move(m_NodeTraversals);
+		out_graph = std::move(m_ResultGraph);
+		out_edge_traversals = std::move(m_EdgeTraversals);
+		m_HasResult = false;
+
+		return true;
+	}
+
+	void CFlowSimulationWorker::SimulationThread()
+	{
+		while (true)
+		{
+			SRequest request;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				if (!m_Request)
+				{
+					m_ThreadIsRunning = false;
+					return;
+				}
+				request = std::move(*m_Request);
+				m_Request.reset();
+				m_Cancelled = false;
+			}
+
+			Simulate(request);
+		}
+	}
+
+	void CFlowSimulationWorker::Simulate(const SRequest& request)
+	{
+		m_Simulation.Run(*request.Graph, request.OriginNodeIndices, request.DestinationNodeIndices, request.Settings, m_Cancelled,
+			[&](size_t step, std::span<const uint32_t> node_occupancy)
+			{
+				bool notify;
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					notify = !m_HasStep;
+					m_HasStep = true;
+					m_StepGeneration = request.Generation;
+					m_Step = step;
+					m_NodeOccupancy.assign(node_occupancy.begin(), node_occupancy.end());
+				}
+				if (notify)
+				{
+					emit StepDone();
+				}
+			});
+
+		if (m_Cancelled)
+		{
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_HasResult = true;
+			m_ResultGeneration = request.Generation;
+			const auto node_traversals = m_Simulation.NodeTraversals();
+			m_NodeTraversals.assign(node_traversals.begin(), node_traversals.end());
+			m_ResultGraph = m_Simulation.Graph();
+			const auto edge_traversals = m_Simulation.EdgeTraversals();
+			m_EdgeTraversals.assign(edge_traversals.begin(), edge_traversals.end());
+		}
+
+		emit SimulationDone();
+	}
+}
+
+#include <moc_FlowSimulationWorker.cpp>
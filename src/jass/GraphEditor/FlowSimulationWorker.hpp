@@ -0,0 +1,93 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <QtCore/qobject.h>
+
+#include <jass/analysis/CsrGraph.h>
+#include <jass/analysis/FlowSimulation.h>
+
+namespace jass
+{
+	class CImmutableDirectedGraph;
+
+	// Runs a flow simulation on a background thread. Occupancy is published after each
+	// step, where only the most recent step is kept if the receiver falls behind. Starting
+	// or cancelling never waits for a running simulation, which stops at its next check and
+	// leaves nothing behind but results of an old generation.
+	class CFlowSimulationWorker: public QObject
+	{
+		Q_OBJECT
+	public:
+		CFlowSimulationWorker();
+		~CFlowSimulationWorker();
+
+		// Cancels any running simulation before starting the new one
+		void Start(std::shared_ptr<const CImmutableDirectedGraph> graph, size_t generation, std::vector<size_t> origin_node_indices, std::vector<size_t> destination_node_indices, const CFlowSimulation::SSettings& settings);
+
+		void Cancel();
+
+		bool TryGrabStep(size_t& out_generation, size_t& out_step, std::vector<float>& out_node_occupancy);
+
+		// Edge traversals are indexed as the columns of 'out_graph'
+		bool TryGrabResult(size_t& out_generation, std::vector<float>& out_node_traversals, CCsrGraph& out_graph, std::vector<uint32_t>& out_edge_traversals);
+
+	Q_SIGNALS:
+		void StepDone();
+		void SimulationDone();
+
+	private:
+		struct SRequest
+		{
+			std::shared_ptr<const CImmutableDirectedGraph> Graph;
+			size_t Generation;
+			std::vector<size_t> OriginNodeIndices;
+			std::vector<size_t> DestinationNodeIndices;
+			CFlowSimulation::SSettings Settings;
+		};
+
+		void SimulationThread();
+
+		void Simulate(const SRequest& request);
+
+		CFlowSimulation m_Simulation;
+		std::atomic<bool> m_Cancelled = false;
+		std::mutex m_Mutex;
+		std::optional<SRequest> m_Request;
+		bool m_ThreadIsRunning = false;
+		bool m_HasStep = false;
+		size_t m_StepGeneration = 0;
+		size_t m_Step = 0;
+		std::vector<float> m_NodeOccupancy;
+		bool m_HasResult = false;
+		size_t m_ResultGeneration = 0;
+		std::vector<float> m_NodeTraversals;
+		CCsrGraph m_ResultGraph;
+		std::vector<uint32_t> m_EdgeTraversals;
+		std::future<void> m_SimulationThreadResult;
+	};
+}
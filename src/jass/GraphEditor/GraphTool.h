@@ -49,6 +49,7 @@ namespace jass
 
 		inline CGraphWidget& GraphWidget();
 		inline const CGraphWidget& GraphWidget() const;
+		inline CJassEditor& JassEditor();
 		inline CGraphModel& DataModel();
 		inline CCategorySet& Categories();
 		inline CGraphSelectionModel& SelectionModel();
@@ -67,6 +68,7 @@ namespace jass
 
 	inline CGraphWidget& CGraphTool::GraphWidget() { return *m_GraphWidget; }
 	inline const CGraphWidget& CGraphTool::GraphWidget() const { return *m_GraphWidget; }
+	inline CJassEditor& CGraphTool::JassEditor() { return *m_Editor; }
 	inline CGraphModel& CGraphTool::DataModel() { return m_Editor->DataModel(); }
 	inline CCategorySet& CGraphTool::Categories() { return m_Editor->Categories(); }
 	inline CGraphSelectionModel& CGraphTool::SelectionModel() { return m_Editor->SelectionModel(); }
@@ -20,9 +20,11 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qbuffer.h>
+#include <QtCore/qstandardpaths.h>
 #include <QtWidgets/qaction.h>
 #include <QtWidgets/qapplication.h>
 #include <QtWidgets/qfiledialog.h>
+#include <QtWidgets/qinputdialog.h>
 #include <QtWidgets/qmainwindow.h>
 #include <QtWidgets/qtoolbar.h>
 #include <QtWidgets/qmenu.h>
@@ -54,15 +56,18 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <jass/ui/GraphWidget/JustifiedEdgeGraphLayer.hpp>
 #include <jass/ui/GraphWidget/JustifiedNodeGraphLayer.hpp>
 #include <jass/ui/GraphWidget/NodeGraphLayer.hpp>
+#include <jass/ui/GraphWidget/PathGraphLayer.hpp>
 #include <jass/ui/GraphWidget/ImageGraphLayer.hpp>
 #include <jass/ui/GraphWidget/GraphNodeAnalysisTheme.hpp>
 #include <jass/ui/GraphWidget/GraphNodeCategoryTheme.hpp>
+#include <jass/ui/GraphWidget/NodeSpriteCache.h>
 #include <jass/ui/GraphWidget/PaletteSpriteSet.h>
 #include <jass/ui/CategoryView.hpp>
 #include <jass/ui/MainWindow.hpp>
 #include <jass/ui/SplitWidget.hpp>
 #include <jass/StandardNodeAttributes.h>
 #include <jass/JassSvgExport.h>
+#include <jass/Settings.hpp>
 
 #include "tools/EdgeTool.h"
 #include "tools/NodeTool.h"
@@ -80,6 +85,8 @@ namespace jass
 {
 	static const QString SUPPORTED_IMAGE_EXTENSIONS_NO_DOT[] = { "bmp", "jpeg", "jpg", "png" };
 
+	static const size_t MAX_SHORTEST_PATH_ALTERNATIVES = 100;
+
 	//static const QRgb SPECTRAL_PALETTE[] =
 	//{
 	//	qRgb(0x00, 0x2E, 0x47), 
@@ -117,6 +124,7 @@ namespace jass
 	CCategoryView* CJassEditor::s_CategoryView = nullptr;
 	CJassEditor::SActions CJassEditor::s_Actions;
 	CJassEditor::SActionHandles CJassEditor::s_ActionHandles;
+	static std::unique_ptr<CNodeSpriteCache> s_NodeSpriteCache;
 	static std::unique_ptr<CPaletteSpriteSet> s_AnalysisSpriteSet;
 	static QMenu* s_VisualizationMenu = nullptr;
 	static QAction* s_VisualizationMenuAction = nullptr;
@@ -151,12 +159,19 @@ namespace jass
 
 		connect(&DataModel(), &CGraphModel::NodesInserted, this, &CJassEditor::OnNodesRemapped);
 		connect(&DataModel(), &CGraphModel::NodesRemoved,  this, &CJassEditor::OnNodesRemapped);
-		connect(&DataModel(), &CGraphModel::EdgesAdded,    this, &CJassEditor::UpdateAnalyses);
-		connect(&DataModel(), &CGraphModel::EdgesInserted, this, &CJassEditor::UpdateAnalyses);
-		connect(&DataModel(), &CGraphModel::EdgesRemoved,  this, &CJassEditor::UpdateAnalyses);
-		connect(&DataModel(), &CGraphModel::AttributeChanged, this, &CJassEditor::UpdateAnalyses);
+		connect(&DataModel(), &CGraphModel::Changed,       this, &CJassEditor::OnGraphChanged);
+		connect(&DataModel(), &CGraphModel::AttributeChanged, this, &CJassEditor::OnAttributeChanged);
+		connect(m_SelectionModel.get(), &CGraphSelectionModel::SelectionChanged, this, &CJassEditor::OnSelectionChanged);
 
-		m_CategorySpriteSet = std::make_shared<CCategorySpriteSet>(Categories(), *s_Settings);
+		m_CategorySpriteSet = std::make_shared<CCategorySpriteSet>(Categories(), *s_Settings, *s_NodeSpriteCache);
+
+		const auto root_node_attribute_index = DataModel().FindAttribute(GRAPH_ATTTRIBUTE_ROOT_NODE);
+		if (root_node_attribute_index != CGraphModel::NO_ATTRIBUTE)
+		{
+			OnAttributeChanged(root_node_attribute_index, DataModel().AttributeValue(root_node_attribute_index));
+		}
+
+		m_Analyses->SetDepthMatrixBudget(s_Settings->value(CSettings::DEPTH_MATRIX_BUDGET, (qulonglong)m_Analyses->DepthMatrixBudget()).toULongLong());
 
 		UpdateAnalyses();
 	}
@@ -192,6 +207,9 @@ namespace jass
 		s_ActionHandles.FlipVertical   = action_manager.NewAction(nullptr, "Flip Vertical",           ":/flip_vertical.png",   QKeySequence(Qt::Key_V), false, &s_Actions.FlipVertical);
 		s_ActionHandles.AddImage       = action_manager.NewAction(nullptr, "Load Background Image",   ":/image_add.png",       QKeySequence(), false, &s_Actions.AddImage);
 		s_ActionHandles.RemoveImage    = action_manager.NewAction(nullptr, "Remove Background Image", ":/image_remove.png",    QKeySequence(), false, &s_Actions.RemoveImage);
+		s_ActionHandles.ShortestPath     = action_manager.NewAction(nullptr, "Shortest Path",      "", QKeySequence(Qt::Key_P),             false, &s_Actions.ShortestPath);
+		s_ActionHandles.AllShortestPaths = action_manager.NewAction(nullptr, "All Shortest Paths", "", QKeySequence(Qt::SHIFT + Qt::Key_P), false, &s_Actions.AllShortestPaths);
+		s_ActionHandles.SimulateFlow     = action_manager.NewAction(nullptr, "Simulate Flow...",   "", QKeySequence(),                      false, &s_Actions.SimulateFlow);
 
 		// Toolbar
 		s_Toolbar = main_window->addToolBar("Map");
@@ -215,6 +233,10 @@ namespace jass
 		s_VisualizationActions.push_back(new QAction("Categories", main_window));
 		s_VisualizationActions.push_back(new QAction("Integration", main_window));
 		s_VisualizationActions.push_back(new QAction("Depth", main_window));
+		s_VisualizationActions.push_back(new QAction("Depth From Hovered Node", main_window));
+		s_VisualizationActions.push_back(new QAction("Movement Potential", main_window));
+		s_VisualizationActions.push_back(new QAction("Flow Occupancy", main_window));
+		s_VisualizationActions.push_back(new QAction("Flow", main_window));
 		s_VisualizationMenu = main_window->Menu("Visualize", &s_VisualizationMenuAction);
 		for (size_t i = 0; i < s_VisualizationActions.size(); ++i)
 		{
@@ -224,11 +246,16 @@ namespace jass
 			connect(action, &QAction::triggered, [mode]() { CJassEditor::SetVisualizationMode(mode); });
 			s_VisualizationMenu->addAction(action);
 		}
+		s_VisualizationMenu->addSeparator();
+		s_VisualizationMenu->addAction(s_Actions.SimulateFlow);
 		s_VisualizationMenuAction->setVisible(false);
 
 		s_CategoryView = &main_window->CategoryView();
 
-		s_AnalysisSpriteSet = std::make_unique<CPaletteSpriteSet>(SPECTRAL_PALETTE, qRgb(0xC0, 0xC0, 0xC0), settings);
+		s_NodeSpriteCache = std::make_unique<CNodeSpriteCache>();
+		s_NodeSpriteCache->SetDiskCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/sprite_cache");
+
+		s_AnalysisSpriteSet = std::make_unique<CPaletteSpriteSet>(SPECTRAL_PALETTE, qRgb(0xC0, 0xC0, 0xC0), settings, *s_NodeSpriteCache);
 	}
 
 	void CJassEditor::AddTool(qapp::CActionManager& action_manager, std::unique_ptr<CGraphTool> tool, QString title, const QIcon& icon, const QKeySequence& keys, qapp::HAction* ptrOutActionHandle)
@@ -303,6 +330,12 @@ namespace jass
 			m_GraphWidget->AppendLayer(std::move(edge_layer));
 		}
 
+		{
+			auto path_layer = std::make_unique<CPathGraphLayer>(*m_GraphWidget, DataModel(), CPathGraphLayer::EPositions::Plan);
+			m_PathGraphLayer = path_layer.get();
+			m_GraphWidget->AppendLayer(std::move(path_layer));
+		}
+
 		{
 			auto node_layer = std::make_unique<CNodeGraphLayer>(*m_GraphWidget, *this, graph_node_category_theme);
 			m_NodeGraphLayer = node_layer.get();
@@ -328,6 +361,12 @@ namespace jass
 			m_JustifiedGraphWidget->AppendLayer(std::move(layer));
 		}
 
+		{
+			auto layer = std::make_unique<CPathGraphLayer>(*m_JustifiedGraphWidget, DataModel(), CPathGraphLayer::EPositions::Justified);
+			m_JustifiedPathGraphLayer = layer.get();
+			m_JustifiedGraphWidget->AppendLayer(std::move(layer));
+		}
+
 		{
 			auto layer = std::make_unique<CJustifiedNodeGraphLayer>(*m_JustifiedGraphWidget, *this, graph_node_category_theme);
 			m_JustifiedGraphWidget->AppendLayer(std::move(layer));
@@ -338,6 +377,14 @@ namespace jass
 			m_JustifiedGraphWidget->AppendLayer(std::move(layer));
 		}
 
+		{
+			SLevelOfDetailThresholds lod_thresholds;
+			lod_thresholds.ReducedBelow = s_Settings->value(CSettings::LOD_REDUCED_BELOW, lod_thresholds.ReducedBelow).toFloat();
+			lod_thresholds.MinimalBelow = s_Settings->value(CSettings::LOD_MINIMAL_BELOW, lod_thresholds.MinimalBelow).toFloat();
+			m_GraphWidget->SetLevelOfDetailThresholds(lod_thresholds);
+			m_JustifiedGraphWidget->SetLevelOfDetailThresholds(lod_thresholds);
+		}
+
 		return std::unique_ptr<QWidget>(m_SplitWidget);
 	}
 
@@ -371,6 +418,17 @@ namespace jass
 			ctx.Enable(s_ActionHandles.GenerateJustified);
 		}
 
+		if (SelectionModel().SelectedNodeCount() == 2)
+		{
+			ctx.Enable(s_ActionHandles.ShortestPath);
+			ctx.Enable(s_ActionHandles.AllShortestPaths);
+		}
+
+		if (Categories().Size() > 0)
+		{
+			ctx.Enable(s_ActionHandles.SimulateFlow);
+		}
+
 		ctx.Enable(s_ActionHandles.AddImage);
 		if (!m_Document.ImageData().isNull())
 		{
@@ -386,20 +444,26 @@ namespace jass
 	{
 		if (action_handle == qapp::s_StandardActionHandles.Undo && m_CommandHistory->CanUndo())
 		{
+			DataModel().BeginTransaction();
 			m_CommandHistory->Undo();
+			DataModel().Commit();
 			return true;
 		}
 		else if (action_handle == qapp::s_StandardActionHandles.Redo && m_CommandHistory->CanRedo())
 		{
+			DataModel().BeginTransaction();
 			m_CommandHistory->Redo();
+			DataModel().Commit();
 			return true;
 		}
 		else if (action_handle == qapp::s_StandardActionHandles.Delete)
 		{
+			DataModel().BeginTransaction();
 			m_CommandHistory->NewCommandOptional([&](auto& ctx)
 				{
 					return CCmdDeleteGraphElements::Create(ctx, DataModel(), SelectionModel());
 				});
+			DataModel().Commit();
 			return true;
 		}
 		else if (action_handle == s_ActionHandles.ShowJustified)
@@ -422,6 +486,21 @@ namespace jass
 			SetSelectedNodeAsRoot();
 			return true;
 		}
+		else if (action_handle == s_ActionHandles.ShortestPath)
+		{
+			ShowShortestPathsBetweenSelectedNodes(1);
+			return true;
+		}
+		else if (action_handle == s_ActionHandles.AllShortestPaths)
+		{
+			ShowShortestPathsBetweenSelectedNodes(MAX_SHORTEST_PATH_ALTERNATIVES);
+			return true;
+		}
+		else if (action_handle == s_ActionHandles.SimulateFlow)
+		{
+			SimulateFlow();
+			return true;
+		}
 		else if (action_handle == s_ActionHandles.FlipHorizontal || action_handle == s_ActionHandles.FlipVertical)
 		{
 			if (SelectionModel().AnyNodesSelected())
@@ -437,9 +516,11 @@ namespace jass
 		{
 			if (SelectionModel().AnyNodesSelected())
 			{
+				DataModel().BeginTransaction();
 				m_CommandHistory->NewCommand<CCmdDuplicate>(
 					DataModel(),
 					SelectionModel().NodeMask());
+				DataModel().Commit();
 			}
 			return true;
 		}
@@ -474,10 +555,12 @@ namespace jass
 		{
 			CGraphModelSubGraphView subGraphView(DataModel(), SelectionModel().NodeMask());
 			SetGraphClipboardData(subGraphView);
+			DataModel().BeginTransaction();
 			m_CommandHistory->NewCommandOptional([&](auto& ctx)
 				{
 					return CCmdDeleteGraphElements::Create(ctx, DataModel(), SelectionModel());
 				});
+			DataModel().Commit();
 			return true;
 		}
 		else if (action_handle == qapp::s_StandardActionHandles.Copy)
@@ -493,7 +576,9 @@ namespace jass
 			{
 				return true;
 			}
+			DataModel().BeginTransaction();
 			CommandHistory().NewCommand<CCmdAddGraphElements>(DataModel(), graphData);
+			DataModel().Commit();
 			return true;
 		}
 		else if (action_handle == qapp::s_StandardActionHandles.SelectAll)
@@ -602,12 +687,50 @@ namespace jass
 				s += "</td></tr>";
 			}
 
+			if (SelectionModel().SelectedNodeCount() == 1)
+			{
+				SelectionModel().NodeMask().for_each_set_bit([&](size_t selected_node_index)
+					{
+						const auto depth = m_Analyses->Depth(selected_node_index, node_index);
+						if (selected_node_index != node_index && depth >= 0)
+						{
+							s += QString("<tr><td>Depth from selected:</td><td>%1</td></tr>").arg(depth);
+						}
+					});
+			}
+
 			s += "</table>";
 			return s;
 		}
+
+		if (dynamic_cast<CEdgeGraphLayer*>(layer))
+		{
+			const auto node_pair = DataModel().EdgeNodePair((CGraphModel::edge_index_t)element);
+			const auto traversals = m_Analyses->FlowEdgeTraversals(node_pair.first, node_pair.second);
+			if (traversals >= 0)
+			{
+				return QString("<table><tr><td>Flow:</td><td>%1</td></tr></table>").arg(traversals);
+			}
+		}
+
 		return QString();
 	}
 
+	void CJassEditor::OnHilightedElementChanged(CGraphWidget& graph_widget, size_t layer_index, CGraphLayer::element_t element)
+	{
+		if (EVisualizationMode::HoveredDepth != m_VisualizationMode || CGraphLayer::NO_ELEMENT == element)
+		{
+			return;
+		}
+
+		auto* layer = &graph_widget.Layer(layer_index);
+
+		if (dynamic_cast<CNodeGraphLayer*>(layer) || dynamic_cast<CJustifiedNodeGraphLayer*>(layer))
+		{
+			m_Analyses->RequestDepthFromNode((size_t)element);
+		}
+	}
+
 	CGraphModel& CJassEditor::DataModel()
 	{
 		return m_Document.GraphModel();
@@ -633,13 +756,8 @@ namespace jass
 		m_Document.SetImage(image_data, extension_no_dot);
 		if (m_ImageLayer)
 		{
-			QPixmap pixmap;
-			if (!pixmap.loadFromData(image_data))
-			{
-				// TODO: Log error
-				//QMessageBox
-			}
-			m_ImageLayer->SetImage(std::move(pixmap));
+			// TODO: Log error if the image can't be decoded
+			m_ImageLayer->SetImageData(image_data);
 		}
 	}
 
@@ -709,27 +827,49 @@ namespace jass
 			{
 				contextMenu.addAction(s_Actions.SetRoot);
 			}
+			else if (SelectionModel().SelectedNodeCount() == 2)
+			{
+				contextMenu.addAction(s_Actions.ShortestPath);
+				contextMenu.addAction(s_Actions.AllShortestPaths);
+			}
 		}
 
 		contextMenu.exec(m_GraphWidget->mapToGlobal(pos));
 	}
 
-	void CJassEditor::OnNodesRemapped(const CGraphModel::const_node_indices_t& node_indices, const  CGraphModel::node_remap_table_t& remap_table)
+	void CJassEditor::OnNodesRemapped()
 	{
 		const auto root_node_attribute_index = DataModel().FindAttribute(GRAPH_ATTTRIBUTE_ROOT_NODE);
 		if (root_node_attribute_index != CGraphModel::NO_ATTRIBUTE)
 		{
 			const auto root_node_index = DataModel().AttributeValue(root_node_attribute_index).toInt();
-			if (root_node_index >= 0 && root_node_attribute_index < remap_table.size())
+			if (root_node_index >= 0)
 			{
-				const auto new_root_node_index = remap_table[root_node_index];
+				const auto new_root_node_index = DataModel().NodeIndexFromId(m_RootNodeId);
 				DataModel().SetAttribute(
 					root_node_attribute_index, 
 					(CGraphModel::NO_NODE == new_root_node_index) ? (int)-1 : (int)new_root_node_index);
 			}
 		}
+	}
 
-		UpdateAnalyses();
+	void CJassEditor::OnAttributeChanged(CGraphModel::attribute_index_t index, const QVariant& value)
+	{
+		if (index != DataModel().FindAttribute(GRAPH_ATTTRIBUTE_ROOT_NODE))
+		{
+			return;
+		}
+		const auto root_node_index = value.toInt();
+		m_RootNodeId = (root_node_index >= 0 && root_node_index < (int)DataModel().NodeCount()) ?
+			DataModel().NodeId((CGraphModel::node_index_t)root_node_index) : CGraphModel::node_id_t();
+	}
+
+	void CJassEditor::OnGraphChanged(const CGraphModel::SChangeSet& changes)
+	{
+		if (changes.TopologyChanged() || changes.AttributesChanged)
+		{
+			UpdateAnalyses();
+		}
 	}
 
 	void CJassEditor::UpdateAnalyses()
@@ -814,6 +954,108 @@ namespace jass
 		CommandHistory().NewCommand<CCmdSetNodeAttributes<JPosition_NodeAttribute_t::value_t>>(jposition_attribute, diff_mask, jpositions);
 	}
 
+	void CJassEditor::OnSelectionChanged()
+	{
+		if (!m_PathGraphLayer || m_PathGraphLayer->Paths().empty())
+		{
+			return;
+		}
+
+		// Paths are only shown as long as their end nodes are the ones selected
+		const auto& path = m_PathGraphLayer->Paths().front();
+		if (SelectionModel().SelectedNodeCount() != 2 || !SelectionModel().IsNodeSelected(path.front()) || !SelectionModel().IsNodeSelected(path.back()))
+		{
+			ClearPaths();
+		}
+	}
+
+	void CJassEditor::ShowShortestPathsBetweenSelectedNodes(size_t max_path_count)
+	{
+		if (SelectionModel().SelectedNodeCount() != 2)
+		{
+			return;
+		}
+
+		size_t end_node_indices[2];
+		size_t n = 0;
+		SelectionModel().NodeMask().for_each_set_bit([&](size_t node_index)
+			{
+				end_node_indices[n++] = node_index;
+			});
+
+		std::vector<CAnalyses::path_t> paths;
+		m_Analyses->FindShortestPaths(end_node_indices[0], end_node_indices[1], max_path_count, paths);
+
+		std::vector<CPathGraphLayer::path_t> layer_paths(paths.size());
+		for (size_t path_index = 0; path_index < paths.size(); ++path_index)
+		{
+			layer_paths[path_index].assign(paths[path_index].begin(), paths[path_index].end());
+		}
+
+		auto justified_layer_paths = layer_paths;
+		m_PathGraphLayer->SetPaths(std::move(layer_paths));
+		m_JustifiedPathGraphLayer->SetPaths(std::move(justified_layer_paths));
+	}
+
+	void CJassEditor::ClearPaths()
+	{
+		m_PathGraphLayer->ClearPaths();
+		m_JustifiedPathGraphLayer->ClearPaths();
+	}
+
+	void CJassEditor::SimulateFlow()
+	{
+		QStringList category_names;
+		for (size_t category_index = 0; category_index < Categories().Size(); ++category_index)
+		{
+			category_names.push_back(Categories().Name(category_index));
+		}
+
+		bool ok = false;
+		const auto origin_category_name = QInputDialog::getItem(m_GraphWidget, "Simulate Flow", "Origin category:", category_names, 0, false, &ok);
+		if (!ok)
+		{
+			return;
+		}
+		const auto destination_category_name = QInputDialog::getItem(m_GraphWidget, "Simulate Flow", "Destination category:", category_names, std::min<int>(1, (int)category_names.size() - 1), false, &ok);
+		if (!ok)
+		{
+			return;
+		}
+
+		CFlowSimulation::SSettings settings;
+		settings.AgentCount = (size_t)QInputDialog::getInt(m_GraphWidget, "Simulate Flow", "Number of agents:", (int)settings.AgentCount, 1, 1000000, 100, &ok);
+		if (!ok)
+		{
+			return;
+		}
+		settings.DetourProbability = (float)QInputDialog::getDouble(m_GraphWidget, "Simulate Flow", "Probability of leaving shortest route at each step:", settings.DetourProbability, 0, 1, 2, &ok);
+		if (!ok)
+		{
+			return;
+		}
+
+		const auto origin_category = category_names.indexOf(origin_category_name);
+		const auto destination_category = category_names.indexOf(destination_category_name);
+		std::vector<size_t> origin_node_indices, destination_node_indices;
+		for (CGraphModel::node_index_t node_index = 0; node_index < DataModel().NodeCount(); ++node_index)
+		{
+			const auto category = (int)DataModel().NodeCategory(node_index);
+			if (category == origin_category)
+			{
+				origin_node_indices.push_back(node_index);
+			}
+			if (category == destination_category)
+			{
+				destination_node_indices.push_back(node_index);
+			}
+		}
+
+		m_Analyses->RunFlowSimulation(std::move(origin_node_indices), std::move(destination_node_indices), settings);
+
+		SetVisualizationMode(EVisualizationMode::FlowOccupancy);
+	}
+
 	void CJassEditor::SetVisualizationMode(EVisualizationMode mode)
 	{
 		auto* editor = dynamic_cast<CJassEditor*>(s_Workbench->CurrentEditor());
@@ -843,6 +1085,34 @@ namespace jass
 				editor->m_NodeGraphLayer->SetTheme(analysis_theme);
 		}
 			break;
+		case EVisualizationMode::HoveredDepth:
+			{
+				auto analysis_theme = std::make_shared<CGraphNodeAnalysisTheme>(editor->DataModel(), editor->Analyses(), editor->Categories(), *s_AnalysisSpriteSet);
+				analysis_theme->SetMetric(CAnalyses::DEPTH_FROM_NODE_METRIC, true);
+				editor->m_NodeGraphLayer->SetTheme(analysis_theme);
+		}
+			break;
+		case EVisualizationMode::MovementPotential:
+			{
+				auto analysis_theme = std::make_shared<CGraphNodeAnalysisTheme>(editor->DataModel(), editor->Analyses(), editor->Categories(), *s_AnalysisSpriteSet);
+				analysis_theme->SetMetric("Movement Potential", false);
+				editor->m_NodeGraphLayer->SetTheme(analysis_theme);
+		}
+			break;
+		case EVisualizationMode::FlowOccupancy:
+			{
+				auto analysis_theme = std::make_shared<CGraphNodeAnalysisTheme>(editor->DataModel(), editor->Analyses(), editor->Categories(), *s_AnalysisSpriteSet);
+				analysis_theme->SetMetric(CAnalyses::FLOW_OCCUPANCY_METRIC, false);
+				editor->m_NodeGraphLayer->SetTheme(analysis_theme);
+		}
+			break;
+		case EVisualizationMode::Flow:
+			{
+				auto analysis_theme = std::make_shared<CGraphNodeAnalysisTheme>(editor->DataModel(), editor->Analyses(), editor->Categories(), *s_AnalysisSpriteSet);
+				analysis_theme->SetMetric(CAnalyses::FLOW_METRIC, false);
+				editor->m_NodeGraphLayer->SetTheme(analysis_theme);
+		}
+			break;
 		}
 
 		s_VisualizationActions[(size_t)editor->m_VisualizationMode]->setChecked(false);
@@ -54,6 +54,7 @@ namespace jass
 	class CImageGraphLayer;
 	class CMainWindow;
 	class CNodeGraphLayer;
+	class CPathGraphLayer;
 	class CSelectionTool;
 	class CSettings;
 	class CSplitWidget;
@@ -86,6 +87,8 @@ namespace jass
 		//IGraphWidgetDelegate delegate
 		QString ToolTipText(CGraphWidget& graph_widget, size_t layer_index, CGraphLayer::element_t element) override;
 
+		void OnHilightedElementChanged(CGraphWidget& graph_widget, size_t layer_index, CGraphLayer::element_t element);
+
 		inline CGraphWidget& GraphWidget() { return *m_GraphWidget; }
 
 		inline CJassDocument& JassDocument() { return m_Document; }
@@ -110,13 +113,16 @@ namespace jass
 	private Q_SLOTS:
 		void OnCommandHistoryDirtyChanged(bool dirty);
 		void OnCustomContextMenuRequested(const QPoint& pos);
-		void OnNodesRemapped(const CGraphModel::const_node_indices_t& node_indices, const  CGraphModel::node_remap_table_t& remap_table);
+		void OnNodesRemapped();
+		void OnAttributeChanged(CGraphModel::attribute_index_t index, const QVariant& value);
+		void OnGraphChanged(const CGraphModel::SChangeSet& changes);
 		void UpdateAnalyses();
 		void OnRemoveCategories(const QModelIndexList& indexes);
 		void OnAddCategory(const QString& name, QRgb color, EShape shape);
 		void OnModifyCategory(int index, const QString& name, QRgb color, EShape shape);
 		void SetSelectedNodeAsRoot();
 		void GenerateJustifiedGraph();
+		void OnSelectionChanged();
 
 	private:
 		enum class EVisualizationMode
@@ -124,10 +130,18 @@ namespace jass
 			Categories,
 			Integration,
 			Depth,
+			HoveredDepth,
+			MovementPotential,
+			FlowOccupancy,
+			Flow,
 		};
 
 		static void SetVisualizationMode(EVisualizationMode mode);
 
+		void ShowShortestPathsBetweenSelectedNodes(size_t max_path_count);
+		void ClearPaths();
+		void SimulateFlow();
+
 		CJassDocument& m_Document;
 		CSplitWidget* m_SplitWidget = nullptr;
 		CGraphWidget* m_GraphWidget = nullptr;
@@ -139,6 +153,9 @@ namespace jass
 		std::shared_ptr<CCategorySpriteSet> m_CategorySpriteSet;
 		EVisualizationMode m_VisualizationMode = EVisualizationMode::Categories;
 		CNodeGraphLayer* m_NodeGraphLayer = nullptr;
+		CPathGraphLayer* m_PathGraphLayer = nullptr;
+		CPathGraphLayer* m_JustifiedPathGraphLayer = nullptr;
+		CGraphModel::node_id_t m_RootNodeId;  // Follows the root node as its index changes
 
 		// Common
 		static void OnSelectTool(int tool_index);
@@ -188,6 +205,9 @@ namespace jass
 			QAction* FlipVertical = 0;
 			QAction* AddImage = 0;
 			QAction* RemoveImage = 0;
+			QAction* ShortestPath = 0;
+			QAction* AllShortestPaths = 0;
+			QAction* SimulateFlow = 0;
 		};
 		static SActions s_Actions;
 
@@ -200,6 +220,9 @@ namespace jass
 			qapp::HAction FlipVertical = 0;
 			qapp::HAction AddImage = 0;
 			qapp::HAction RemoveImage = 0;
+			qapp::HAction ShortestPath = 0;
+			qapp::HAction AllShortestPaths = 0;
+			qapp::HAction SimulateFlow = 0;
 		};
 		static SActionHandles s_ActionHandles;
 	};
@@ -75,7 +75,7 @@ namespace jass
 		{
 			if (pt.y() >= 0)
 			{
-				pt = pt * 50;
+				pt = pt * JUSTIFIED_GRAPH_SPACING;
 			}
 		}
 	}
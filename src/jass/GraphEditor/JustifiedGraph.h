@@ -23,6 +23,8 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 namespace jass
 {
+	static const float JUSTIFIED_GRAPH_SPACING = 50;  // Model distance between neighbouring rows and columns
+
 	void GenerateJustifiedGraph(
 		const CGraphModel& graph_model, 
 		const bitvec& node_mask, 
@@ -57,15 +57,21 @@ namespace jass
 		}
 
 		auto depth_values = ctx.NewMetricVector();
-		depth_values.resize(graph.NodeCount(), std::numeric_limits<float>::quiet_NaN());
+		CalculateDepth(graph, root_node_index.toInt(), depth_values);
 
-		m_BfsTraversal->Traverse(ctx.ImmutableDirectedGraph(), root_node_index.toInt(),
+		ctx.OutputMetric(QString("Depth"), std::move(depth_values));
+	}
+
+	void CDepthAnalysis::CalculateDepth(const CImmutableDirectedGraph& graph, size_t root_node_index, std::vector<float>& out_depth_values)
+	{
+		out_depth_values.clear();
+		out_depth_values.resize(graph.NodeCount(), std::numeric_limits<float>::quiet_NaN());
+
+		m_BfsTraversal->Traverse(graph, root_node_index,
 			[&](auto node_handle, auto depth)
 			{
 				const auto node_index = graph.NodeIndex(node_handle);
-				depth_values[node_index] = depth;
+				out_depth_values[node_index] = depth;
 			});
-
-		ctx.OutputMetric(QString("Depth"), std::move(depth_values));
 	}
 }
\ No newline at end of file
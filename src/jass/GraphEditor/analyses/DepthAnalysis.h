@@ -31,6 +31,10 @@ namespace jass
 		~CDepthAnalysis();
 
 		void RunAnalysis(IAnalysisContext& ctx) override;
+
+		// Depth of each node from 'root_node_index', NaN for nodes that can't be reached
+		void CalculateDepth(const CImmutableDirectedGraph& graph, size_t root_node_index, std::vector<float>& out_depth_values);
+
 	private:
 		class CMyBfsTraversal;
 		std::unique_ptr<CMyBfsTraversal> m_BfsTraversal;
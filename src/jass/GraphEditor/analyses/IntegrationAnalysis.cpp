@@ -21,6 +21,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #include <QtCore/qstring.h>
 #include <jass/analysis/DepthCalculator.h>
+#include <jass/analysis/DepthMatrix.h>
 #include <jass/analysis/ImmutableDirectedGraph.h>
 #include <jass/analysis/Integration.h>
 #include "IntegrationAnalysis.h"
@@ -48,10 +49,37 @@ namespace jass
 		auto MD_values = ctx.NewMetricVector();
 		auto RA_values = ctx.NewMetricVector();
 		auto RRA_values = ctx.NewMetricVector();
+
+		std::shared_ptr<CDepthMatrix> depth_matrix;
+		if (graph.NodeCount())
+		{
+			depth_matrix = std::make_shared<CDepthMatrix>();
+			if (!depth_matrix->Init(graph.NodeCount(), m_DepthMatrixBudget))
+			{
+				depth_matrix.reset();
+			}
+		}
+
 		for (size_t node_index = 0; node_index < graph.NodeCount(); ++node_index)
 		{
 			size_t max_depth, total_depth, node_count;
-			m_DepthCalculator->CalculateDepth(graph, node_index, max_depth, total_depth, node_count);
+			if (depth_matrix)
+			{
+				bool within_budget = true;
+				m_DepthCalculator->CalculateDepth(graph, node_index, max_depth, total_depth, node_count, [&](auto node, auto depth)
+				{
+					within_budget = within_budget && depth_matrix->SetDepth(node_index, graph.NodeIndex(node), depth);
+				});
+				if (!within_budget)
+				{
+					// Too deep to keep the depths of every pair, carry on with integration only
+					depth_matrix.reset();
+				}
+			}
+			else
+			{
+				m_DepthCalculator->CalculateDepth(graph, node_index, max_depth, total_depth, node_count);
+			}
 			float MD, RA, RRA;
 			const auto integration_value = CalculateIntegrationScore((unsigned int)node_count, (float)total_depth, MD, RA, RRA);
 			INT_values.push_back(integration_value);
@@ -65,5 +93,6 @@ namespace jass
 		ctx.OutputMetric(QString("MD"), std::move(MD_values));
 		ctx.OutputMetric(QString("TD"), std::move(TD_values));
 		ctx.OutputMetric(QString("Integration"), std::move(INT_values));
+		ctx.OutputDepthMatrix(std::move(depth_matrix));
 	}
 }
\ No newline at end of file
@@ -19,6 +19,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include "../Analysis.h"
 
@@ -27,12 +28,20 @@ namespace jass
 	class CIntegrationAnalysis : public IAnalysis
 	{
 	public:
+		static const size_t DEFAULT_DEPTH_MATRIX_BUDGET = 64 * 1024 * 1024;
+
 		CIntegrationAnalysis();
 		~CIntegrationAnalysis();
 
+		// Max number of bytes to spend on keeping the all-pairs depth matrix (0 = disabled)
+		inline void SetDepthMatrixBudget(size_t byte_budget) { m_DepthMatrixBudget = byte_budget; }
+
+		inline size_t DepthMatrixBudget() const { return m_DepthMatrixBudget; }
+
 		void RunAnalysis(IAnalysisContext& ctx) override;
 	private:
 		class CMyDepthCalculator;
 		std::unique_ptr<CMyDepthCalculator> m_DepthCalculator;
+		std::atomic<size_t> m_DepthMatrixBudget = DEFAULT_DEPTH_MATRIX_BUDGET;
 	};
 }
\ No newline at end of file
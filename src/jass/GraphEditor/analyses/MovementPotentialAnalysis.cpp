@@ -0,0 +1,63 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <jass/analysis/ImmutableDirectedGraph.h>
+#include <jass/analysis/RandomWalk.h>
+#include <jass/Debug.h>
+#include "MovementPotentialAnalysis.h"
+
+namespace jass
+{
+	const float CMovementPotentialAnalysis::DAMPING = 0.85f;
+	const float CMovementPotentialAnalysis::TOLERANCE = 1e-4f;
+
+	void CMovementPotentialAnalysis::RunAnalysis(IAnalysisContext& ctx)
+	{
+		const auto& graph = ctx.ImmutableDirectedGraph();
+
+		if (graph.NodeCount() == 0)
+		{
+			return;
+		}
+
+		m_CsrGraph.CopyView(graph);
+
+		// The L1 change between sweeps is the mean change per node of the output metric, whose mean is 1,
+		// so TOLERANCE holds for any node count. Rounding noise in the sums does grow with node count though.
+		const float tolerance = std::max(TOLERANCE, std::sqrt((float)graph.NodeCount()) * std::numeric_limits<float>::epsilon());
+
+		auto values = ctx.NewMetricVector();
+		const auto sweep_count = CalculateRandomWalkStationaryDistribution(m_CsrGraph, DAMPING, tolerance, MAX_ITERATIONS, values);
+		if (sweep_count >= MAX_ITERATIONS)
+		{
+			LOG_WARNING("Movement potential did not converge in %d sweeps.", (int)sweep_count);
+		}
+
+		const float scale = (float)graph.NodeCount();
+		for (auto& value : values)
+		{
+			value *= scale;
+		}
+
+		ctx.OutputMetric(QString("Movement Potential"), std::move(values));
+	}
+}
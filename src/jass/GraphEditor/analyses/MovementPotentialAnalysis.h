@@ -0,0 +1,42 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <jass/analysis/CsrGraph.h>
+#include "../Analysis.h"
+
+namespace jass
+{
+	// Likelihood of passing through each node during random movement in the graph (PageRank),
+	// scaled so that the average over all nodes is 1.
+	class CMovementPotentialAnalysis : public IAnalysis
+	{
+	public:
+		static const float DAMPING;
+		static const float TOLERANCE;
+		static const size_t MAX_ITERATIONS = 100;
+
+		void RunAnalysis(IAnalysisContext& ctx) override;
+
+	private:
+		CCsrGraph m_CsrGraph;
+	};
+}
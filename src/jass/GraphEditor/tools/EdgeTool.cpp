@@ -32,6 +32,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 namespace jass
 {
 	static const QRgb LINE_COLOR = qRgb(0x0a, 0x84, 0xff);
+	static const int SNAP_DISTANCE = 12;
 
 	void CEdgeTool::Activate(const SGraphToolContext& ctx)
 	{
@@ -102,6 +103,11 @@ namespace jass
 			return;
 		}
 
+		if (CGraphLayer::NO_ELEMENT == hit_node)
+		{
+			hit_node = m_NodeLayer->NearestElement(event.pos(), SNAP_DISTANCE);
+		}
+
 		if (hit_node == m_FromNode)
 		{
 			hit_node = CGraphLayer::NO_ELEMENT;
@@ -251,6 +251,8 @@ namespace jass
 			GraphWidget().Layer(m_HilightedLayerIndex).SetHilighted(m_HilightedElement, true);
 			can_move = CanMoveLayerElements(m_HilightedLayerIndex);
 		}
+
+		JassEditor().OnHilightedElementChanged(GraphWidget(), m_HilightedLayerIndex, m_HilightedElement);
 	}
 
 	void CSelectionTool::SetState(EState state)
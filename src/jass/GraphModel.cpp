@@ -18,6 +18,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <algorithm>
+#include <numeric>
 #include <ranges>
 #include <jass/utils/range_utils.h>
 #include "Debug.h"
@@ -30,23 +31,50 @@ namespace jass
 	const CGraphModel::node_index_t CGraphModel::NO_NODE = (CGraphModel::node_index_t)-1;
 	const CGraphModel::category_index_t CGraphModel::NO_CATEGORY = (CGraphModel::category_index_t)-1;
 
+	// Keeps ids pointing at the elements moved in 'ids', by insert_by_moves or remove_by_moves
+	template <class TIndex>
+	static void UpdateMovedIds(slot_map<TIndex>& id_map, const std::vector<slot_map_handle>& ids, std::span<const std::pair<TIndex, TIndex>> moves)
+	{
+		for (const auto& move : moves)
+		{
+			*id_map.find(ids[move.second]) = move.second;
+		}
+	}
+
 	CGraphModel::CGraphModel()
 	{
-		m_FirstEdgePerNode.push_back(0);  // has one extra element!
+		RebuildSpatialIndex();
 	}
 
 	CGraphModel::node_index_t CGraphModel::AddNodes(size_t count)
 	{
 		const auto new_node_count = NodeCount() + count;
-		m_NodeNames.resize(new_node_count);
+		m_NodeNameIds.resize(new_node_count, string_pool::empty_id);
 		m_NodePositions.resize(new_node_count);
 		m_NodeCategories.resize(new_node_count, NO_CATEGORY);
 		for (auto& node_attribute : m_NodeAttributes)
 		{
 			node_attribute.second->Resize(new_node_count);
 		}
-		
-		m_FirstEdgePerNode.resize(new_node_count + 1, m_FirstEdgePerNode.back());  // has one extra element!
+		m_NeighbourLists.resize(new_node_count);
+		m_NodeIds.resize(new_node_count);
+		for (auto node_index = (node_index_t)(new_node_count - count); node_index < new_node_count; ++node_index)
+		{
+			m_NodeIds[node_index] = m_NodeIdMap.insert(node_index);
+		}
+
+		if (SpatialIndexNeedsRebuild(NodeCount()))
+		{
+			RebuildSpatialIndex();
+		}
+		else
+		{
+			m_NodeGrid.resize(new_node_count);
+			for (auto node_index = (node_index_t)(new_node_count - count); node_index < new_node_count; ++node_index)
+			{
+				m_NodeGrid.insert(node_index, NodeBox(node_index));
+			}
+		}
 
 		return (CGraphModel::node_index_t)(new_node_count - count);
 	}
@@ -79,7 +107,10 @@ namespace jass
 			return;
 		}
 		m_Attributes[index].second = value;
+		BeginTransaction();
+		m_PendingChanges.AttributesChanged = true;
 		emit AttributeChanged(index, value);
+		Commit();
 	}
 
 	CGraphModel::attribute_index_t CGraphModel::AttributeCount() const
@@ -134,7 +165,6 @@ namespace jass
 		if (0 == m_NodeModificationCounter)
 		{
 			m_NodeModificationMask.clear();
-			m_NodeModificationMask.resize(NodeCount());
 		}
 		++m_NodeModificationCounter;
 	}
@@ -145,9 +175,48 @@ namespace jass
 		--m_NodeModificationCounter;
 		if (0 == m_NodeModificationCounter)
 		{
+			BeginTransaction();
+			m_PendingChanges.NodesModified = true;
+			UpdateSpatialIndexForModifiedNodes(m_NodeModificationMask);
 			emit NodesModified(m_NodeModificationMask);
 			m_NodeModificationMask.clear();
+			Commit();
+		}
+	}
+
+	void CGraphModel::SetNodePositions(std::span<const position_t> positions)
+	{
+		ASSERT(positions.size() == m_NodePositions.size());
+		BeginModifyNodes();
+		std::copy(positions.begin(), positions.end(), m_NodePositions.begin());
+		SetAllNodesModified();
+		EndModifyNodes();
+	}
+
+	void CGraphModel::SetNodeCategories(std::span<const category_index_t> categories)
+	{
+		ASSERT(categories.size() == m_NodeCategories.size());
+		BeginModifyNodes();
+		std::copy(categories.begin(), categories.end(), m_NodeCategories.begin());
+		SetAllNodesModified();
+		EndModifyNodes();
+	}
+
+	void CGraphModel::BeginTransaction()
+	{
+		++m_TransactionCounter;
+	}
+
+	void CGraphModel::Commit()
+	{
+		ASSERT(m_TransactionCounter > 0);
+		if (0 != --m_TransactionCounter || !m_PendingChanges.Any())
+		{
+			return;
 		}
+		const auto changes = m_PendingChanges;
+		m_PendingChanges = SChangeSet();
+		emit Changed(changes);
 	}
 
 	void CGraphModel::InsertNodes(const std::span<const SNodeDesc>& new_nodes)
@@ -157,51 +226,53 @@ namespace jass
 			return;
 		}
 
+		BeginTransaction();
+
 		decltype(m_TempIndices) temp_indices = std::move(m_TempIndices);  // Hold m_TempIndices in this scope, in case it is accessed 
+		decltype(m_TempMoves) temp_moves = std::move(m_TempMoves);  // Same for m_TempMoves
 
-		temp_indices.resize(new_nodes.size() + NodeCount());
+		temp_indices.resize(new_nodes.size());
 		for (size_t i = 0; i < new_nodes.size(); ++i)
 		{
 			temp_indices[i] = new_nodes[i].Index;
 		}
-		auto new_node_indices = std::span<const node_index_t>(temp_indices.data(), new_nodes.size());
-		auto remap_table = std::span<node_index_t>(temp_indices.data() + new_nodes.size(), NodeCount());
-		build_index_expand_table(new_node_indices, remap_table);
+		const auto new_node_indices = to_const_span(temp_indices);
+
+		// Nodes at the new indices move to the end, taking their edges along
+		build_insert_moves(NodeCount(), new_node_indices, temp_moves);
+		const auto moves = to_const_span(temp_moves);
+		m_NeighbourLists.resize(m_NeighbourLists.size() + new_nodes.size());
+		for (const auto& move : moves)
+		{
+			MoveNodeEdges(move.first, move.second);
+		}
 
-		expand(m_NodeNames, new_node_indices);
-		expand(m_NodePositions, new_node_indices);
-		expand(m_NodeCategories, new_node_indices);
-		expand(m_FirstEdgePerNode, new_node_indices, (node_index_t)-1);
+		insert_by_moves(m_NodeNameIds, new_node_indices, moves, string_pool::empty_id);
+		insert_by_moves(m_NodePositions, new_node_indices, moves);
+		insert_by_moves(m_NodeCategories, new_node_indices, moves);
+		insert_by_moves(m_NodeIds, new_node_indices, moves);
 		for (auto& node_attribute : m_NodeAttributes)
 		{
-			node_attribute.second->Expand(new_node_indices);
+			node_attribute.second->Insert(new_node_indices, moves);
 		}
+		UpdateMovedIds(m_NodeIdMap, m_NodeIds, moves);
 
 		for (auto& new_node : new_nodes)
 		{
-			m_NodeNames[new_node.Index] = QString();  // TODO: Fix
 			m_NodePositions[new_node.Index] = QPoint((int)std::round(new_node.PositionF.x()), (int)std::round(new_node.PositionF.y()));
 			m_NodeCategories[new_node.Index] = new_node.Category;  // TODO: Fix
-		}
-		
-		for (auto it = new_node_indices.rbegin(); new_node_indices.rend() != it; ++it)
-		{
-			m_FirstEdgePerNode[*it] = m_FirstEdgePerNode[*it + 1];
+			m_NodeIds[new_node.Index] = m_NodeIdMap.insert(new_node.Index);
 		}
 
-		// Remap node indices in edge array
-		for (auto& edge : m_Edges)
-		{
-			edge.first = remap_table[edge.first];
-			edge.second = remap_table[edge.second];
-		}
+		UpdateSpatialIndexForNewNodes(new_node_indices, moves);
 
-		RebuildEdgeMap(m_EdgeMap, m_Edges);
-
-		remap_indices(to_span(m_NeighboursPerNode), std::span<const node_index_t>(remap_table.data(), remap_table.size()));
-		emit NodesInserted(new_node_indices, remap_table);
+		m_PendingChanges.NodesInserted = true;
+		emit NodesInserted(new_node_indices, moves);
 
 		m_TempIndices = std::move(temp_indices);  // Release our hold on m_TempIndices
+		m_TempMoves = std::move(temp_moves);
+
+		Commit();
 	}
 
 	void CGraphModel::RemoveNodes(const const_node_indices_t& node_indices)
@@ -211,8 +282,8 @@ namespace jass
 			return;
 		}
 
-		const auto old_node_count = NodeCount();
-		
+		BeginTransaction();
+
 		// Remove edges connected to the nodes
 		{
 			std::vector<edge_index_t> edges;
@@ -223,33 +294,111 @@ namespace jass
 			}
 		}
 
-		collapse(m_NodeNames, node_indices);
-		collapse(m_NodePositions, node_indices);
-		collapse(m_NodeCategories, node_indices);
-		collapse(m_FirstEdgePerNode, node_indices);
-		for (auto& node_attribute : m_NodeAttributes)
+		// No point in keeping the node grid up to date if it is about to be rebuilt
+		const auto new_node_count = NodeCount() - node_indices.size();
+		const bool rebuild_spatial_index = SpatialIndexNeedsRebuild(new_node_count);
+
+		for (const auto node_index : node_indices)
 		{
-			node_attribute.second->Collapse(node_indices);
+			ASSERT(0 == m_NeighbourLists[node_index].Count);
+			m_UnusedNeighbourSlots += m_NeighbourLists[node_index].Capacity;
+			m_NeighbourLists[node_index] = SNeighbourList();
+			VERIFY(m_NodeIdMap.erase(m_NodeIds[node_index]));
+			if (!rebuild_spatial_index)
+			{
+				m_NodeGrid.erase(node_index);
+			}
 		}
 
-		// Remap
+		decltype(m_TempMoves) temp_moves = std::move(m_TempMoves);  // Hold m_TempMoves in this scope, in case it is accessed 
+
+		// Nodes from the end move into the holes, taking their edges along
+		build_remove_moves(NodeCount(), node_indices, temp_moves);
+		const auto moves = to_const_span(temp_moves);
+		for (const auto& move : moves)
 		{
-			std::vector<node_index_t> remap_table;
-			build_index_collapse_table((node_index_t)old_node_count, node_indices, remap_table);
-			remap_indices(to_span(m_NeighboursPerNode), to_const_span(remap_table));
-			
-			// Remap node indices in edge array
-			for (auto& edge : m_Edges)
+			MoveNodeEdges(move.first, move.second);
+			if (!rebuild_spatial_index)
 			{
-				edge.first = remap_table[edge.first];
-				edge.second = remap_table[edge.second];
+				m_NodeGrid.move(move.first, move.second);
 			}
+		}
+		m_NeighbourLists.resize(new_node_count);
+
+		remove_by_moves(m_NodeNameIds, moves, new_node_count);
+		remove_by_moves(m_NodePositions, moves, new_node_count);
+		remove_by_moves(m_NodeCategories, moves, new_node_count);
+		remove_by_moves(m_NodeIds, moves, new_node_count);
+		for (auto& node_attribute : m_NodeAttributes)
+		{
+			node_attribute.second->Remove(moves, new_node_count);
+		}
+		UpdateMovedIds(m_NodeIdMap, m_NodeIds, moves);
 
-			// Rebuild edge map
-			RebuildEdgeMap(m_EdgeMap, m_Edges);
+		CompactNeighbourTablesIfNeeded();
 
-			emit NodesRemoved(node_indices, to_const_span(remap_table));
+		if (rebuild_spatial_index)
+		{
+			RebuildSpatialIndex();
 		}
+		else
+		{
+			m_NodeGrid.resize(new_node_count);
+		}
+
+		m_PendingChanges.NodesRemoved = true;
+		emit NodesRemoved(node_indices, moves);
+
+		m_TempMoves = std::move(temp_moves);  // Release our hold on m_TempMoves
+
+		Commit();
+	}
+
+	CGraphModel::node_index_t CGraphModel::AppendNodes(std::span<const position_t> positions, std::span<const category_index_t> categories)
+	{
+		ASSERT(positions.size() == categories.size());
+
+		const auto first_node_index = NodeCount();
+		if (positions.empty())
+		{
+			return first_node_index;
+		}
+
+		BeginTransaction();
+
+		m_NodePositions.insert(m_NodePositions.end(), positions.begin(), positions.end());
+		m_NodeCategories.insert(m_NodeCategories.end(), categories.begin(), categories.end());
+		const auto new_node_count = m_NodePositions.size();
+		m_NodeNameIds.resize(new_node_count, string_pool::empty_id);
+		m_NeighbourLists.resize(new_node_count);
+		for (auto& node_attribute : m_NodeAttributes)
+		{
+			node_attribute.second->Resize(new_node_count);
+		}
+
+		decltype(m_TempIndices) temp_indices = std::move(m_TempIndices);  // Hold m_TempIndices in this scope, in case it is accessed 
+
+		temp_indices.resize(positions.size());
+		std::iota(temp_indices.begin(), temp_indices.end(), first_node_index);
+		const auto new_node_indices = to_const_span(temp_indices);
+
+		m_NodeIds.resize(new_node_count);
+		for (const auto node_index : new_node_indices)
+		{
+			m_NodeIds[node_index] = m_NodeIdMap.insert(node_index);
+		}
+
+		// Existing nodes keep their indices, so there are no moves
+		UpdateSpatialIndexForNewNodes(new_node_indices, index_moves_t());
+
+		m_PendingChanges.NodesInserted = true;
+		emit NodesInserted(new_node_indices, index_moves_t());
+
+		m_TempIndices = std::move(temp_indices);  // Release our hold on m_TempIndices
+
+		Commit();
+
+		return first_node_index;
 	}
 
 	void CGraphModel::AddEdges(const std::span<const node_pair_t>& edges)
@@ -262,15 +411,32 @@ namespace jass
 		m_Edges.reserve(m_Edges.size() + edges.size());
 		m_Edges.insert(m_Edges.end(), edges.begin(), edges.end());
 
-		RebuildNeighbourTables(m_Edges);
+		for (const auto& edge : edges)
+		{
+			AddNeighbour(edge.first, edge.second);
+			AddNeighbour(edge.second, edge.first);
+		}
+		CompactNeighbourTablesIfNeeded();
 
 		// Add to edge map
+		m_EdgeMap.reserve(m_Edges.size());
+		m_EdgeIds.resize(m_Edges.size());
 		for (size_t edge_index = m_Edges.size() - edges.size(); edge_index < m_Edges.size(); ++edge_index)
 		{
-			m_EdgeMap.insert(std::make_pair(MakeEdgeMapKey(m_Edges[edge_index]), (edge_index_t)edge_index));
+			m_EdgeMap.insert(MakeEdgeMapKey(m_Edges[edge_index]), (edge_index_t)edge_index);
+			m_EdgeIds[edge_index] = m_EdgeIdMap.insert((edge_index_t)edge_index);
 		}
 
+		m_EdgeGrid.resize(m_Edges.size());
+		for (auto edge_index = (edge_index_t)(m_Edges.size() - edges.size()); edge_index < (edge_index_t)m_Edges.size(); ++edge_index)
+		{
+			m_EdgeGrid.insert(edge_index, EdgeBox(edge_index));
+		}
+
+		BeginTransaction();
+		m_PendingChanges.EdgesChanged = true;
 		emit EdgesAdded(edges.size());
+		Commit();
 	}
 
 	void CGraphModel::InsertEdges(const std::span<const SEdgeDesc>& new_edges)
@@ -280,138 +446,173 @@ namespace jass
 			return;
 		}
 
+		decltype(m_TempIndices) temp_indices = std::move(m_TempIndices);  // Hold m_TempIndices in this scope, in case it is accessed 
+		decltype(m_TempMoves) temp_moves = std::move(m_TempMoves);  // Same for m_TempMoves
+
+		temp_indices.resize(new_edges.size());
+		for (size_t i = 0; i < new_edges.size(); ++i)
 		{
-			// TEMPORARILY append edges to m_Edges to be able to rebuild neighbour tables
-			const auto old_edge_count = EdgeCount();
-			m_Edges.reserve(old_edge_count + new_edges.size());
-			for (const auto& edge_desc : new_edges)
-			{
-				m_Edges.push_back({ edge_desc.Node0, edge_desc.Node1 });
-			}
-			RebuildNeighbourTables(m_Edges);
-			m_Edges.resize(old_edge_count);
+			temp_indices[i] = new_edges[i].Index;
+		}
+		const auto new_edge_indices = to_const_span(temp_indices);
+
+		// Edges at the new indices move to the end
+		build_insert_moves(EdgeCount(), new_edge_indices, temp_moves);
+		const auto moves = to_const_span(temp_moves);
+		insert_by_moves(m_Edges, new_edge_indices, moves);
+		insert_by_moves(m_EdgeIds, new_edge_indices, moves);
+		UpdateMovedIds(m_EdgeIdMap, m_EdgeIds, moves);
+		for (const auto& move : moves)
+		{
+			*m_EdgeMap.find(MakeEdgeMapKey(m_Edges[move.second])) = move.second;
 		}
 
-		// Update m_Edges and m_EdgeMap
+		// Insert new edges into edge array and edge map
+		m_EdgeMap.reserve(m_Edges.size());
+		for (auto& new_edge : new_edges)
 		{
-			decltype(m_TempIndices) temp_indices = std::move(m_TempIndices);  // Hold m_TempIndices in this scope, in case it is accessed 
+			const auto node_pair = node_pair_t(
+				std::min(new_edge.Node0, new_edge.Node1),
+				std::max(new_edge.Node0, new_edge.Node1)
+			);
 
-			temp_indices.resize(new_edges.size() + NodeCount());
-			for (size_t i = 0; i < new_edges.size(); ++i)
-			{
-				temp_indices[i] = new_edges[i].Index;
-			}
-			auto new_edge_indices = std::span<const node_index_t>(temp_indices.data(), new_edges.size());
-			auto remap_table = std::span<node_index_t>(temp_indices.data() + new_edges.size(), EdgeCount());
-			build_index_expand_table(new_edge_indices, remap_table);
+			m_Edges[new_edge.Index] = node_pair;
+			m_EdgeIds[new_edge.Index] = m_EdgeIdMap.insert(new_edge.Index);
 
-			// Remap edge indices in edge map
-			for (auto& kvp : m_EdgeMap)
-			{
-				kvp.second = remap_table[kvp.second];
-			}
+			AddNeighbour(node_pair.first, node_pair.second);
+			AddNeighbour(node_pair.second, node_pair.first);
 
-			// insert new edges into edge array and edge map
-			expand(m_Edges, new_edge_indices);
-			for (auto& new_edge : new_edges)
-			{
-				const auto node_pair = node_pair_t(
-					std::min(new_edge.Node0, new_edge.Node1),
-					std::max(new_edge.Node0, new_edge.Node1)
-				);
-
-				m_Edges[new_edge.Index] = node_pair;
-				
-				VERIFY(m_EdgeMap.insert(std::make_pair(MakeEdgeMapKey(node_pair), new_edge.Index)).second);
-			}
+			VERIFY(m_EdgeMap.insert(MakeEdgeMapKey(node_pair), new_edge.Index));
+		}
+		CompactNeighbourTablesIfNeeded();
+
+		ASSERT(m_EdgeMap.size() == m_Edges.size());
 
-			ASSERT(m_Edges.size() == m_NeighboursPerNode.size() / 2);
-			ASSERT(m_EdgeMap.size() == m_Edges.size());
+		UpdateSpatialIndexForNewEdges(new_edge_indices, moves);
 
-			emit EdgesInserted(new_edge_indices, remap_table);
+		BeginTransaction();
+		m_PendingChanges.EdgesChanged = true;
+		emit EdgesInserted(new_edge_indices, moves);
+		Commit();
 
-			m_TempIndices = std::move(temp_indices);  // Release our hold on m_TempIndices
-		}
+		m_TempIndices = std::move(temp_indices);  // Release our hold on m_TempIndices
+		m_TempMoves = std::move(temp_moves);
 	}
 
 	void CGraphModel::RemoveEdges(const std::span<const edge_index_t>& edge_indices)
 	{
-		const auto INVALID_NODE_PAIR = node_pair_t(NO_NODE, NO_NODE);
+		if (edge_indices.empty())
+		{
+			return;
+		}
+
+		// When most edges go, as on undoing a large paste, rebuilding the edge map and edge grid
+		// from the remaining edges is cheaper than erasing the removed ones one by one
+		const auto new_edge_count = EdgeCount() - edge_indices.size();
+		const bool rebuild_edge_lookup = edge_indices.size() > new_edge_count;
 
-		// Mark deleted edges
 		for (const auto edge_index : edge_indices)
 		{
 			const auto& node_pair = m_Edges[edge_index];
 
-			// Mark for deletion in m_NeighboursPerNode
-			for (auto to_index = m_FirstEdgePerNode[node_pair.first]; to_index < m_FirstEdgePerNode[node_pair.first + 1]; ++to_index)
-			{
-				if (m_NeighboursPerNode[to_index] == node_pair.second)
-				{
-					m_NeighboursPerNode[to_index] = NO_NODE;
-					break;
-				}
-			}
-			for (auto from_index = m_FirstEdgePerNode[node_pair.second]; from_index < m_FirstEdgePerNode[node_pair.second + 1]; ++from_index)
+			RemoveNeighbour(node_pair.first, node_pair.second);
+			RemoveNeighbour(node_pair.second, node_pair.first);
+
+			VERIFY(m_EdgeIdMap.erase(m_EdgeIds[edge_index]));
+			if (!rebuild_edge_lookup)
 			{
-				if (m_NeighboursPerNode[from_index] == node_pair.first)
-				{
-					m_NeighboursPerNode[from_index] = NO_NODE;
-					break;
-				}
+				VERIFY(m_EdgeMap.erase(MakeEdgeMapKey(node_pair)));
+				m_EdgeGrid.erase(edge_index);
 			}
-
-			// Remove from edge map
-			auto it = m_EdgeMap.find(MakeEdgeMapKey(node_pair));
-			ASSERT(m_EdgeMap.end() != it);
-			m_EdgeMap.erase(it);
 		}
 
-		std::vector<node_index_t> remap_table;
-		build_index_collapse_table((edge_index_t)m_Edges.size(), edge_indices, remap_table);
+		decltype(m_TempMoves) temp_moves = std::move(m_TempMoves);  // Hold m_TempMoves in this scope, in case it is accessed 
 
-		// Collapse node neighbour array
+		// Edges from the end move into the holes
+		build_remove_moves(EdgeCount(), edge_indices, temp_moves);
+		const auto moves = to_const_span(temp_moves);
+		if (!rebuild_edge_lookup)
 		{
-			node_index_t from_index = 0;
-			node_index_t to_index = 0;
-			for (node_index_t node_index = 0; node_index < NodeCount(); ++node_index)
+			for (const auto& move : moves)
 			{
-				m_FirstEdgePerNode[node_index] = to_index;
-				for (; from_index < m_FirstEdgePerNode[node_index + 1]; ++from_index)
-				{
-					if (m_NeighboursPerNode[from_index] != NO_NODE)
-					{
-						m_NeighboursPerNode[to_index++] = m_NeighboursPerNode[from_index];
-					}
-				}
+				*m_EdgeMap.find(MakeEdgeMapKey(m_Edges[move.first])) = move.second;
+				m_EdgeGrid.move(move.first, move.second);
 			}
-			m_FirstEdgePerNode.back() = to_index;
-			m_NeighboursPerNode.resize(to_index);
 		}
-
-		// Collapse edges array
-		collapse(m_Edges, edge_indices);
-
-		// Remap indices edge map
-		for (auto& kvp : m_EdgeMap)
+		remove_by_moves(m_Edges, moves, new_edge_count);
+		remove_by_moves(m_EdgeIds, moves, new_edge_count);
+		UpdateMovedIds(m_EdgeIdMap, m_EdgeIds, moves);
+		if (rebuild_edge_lookup)
+		{
+			RebuildEdgeLookup();
+		}
+		else
 		{
-			kvp.second = remap_table[kvp.second];
+			m_EdgeGrid.resize(new_edge_count);
 		}
 
-		ASSERT(m_Edges.size() == m_NeighboursPerNode.size() / 2);
 		ASSERT(m_EdgeMap.size() == m_Edges.size());
 
-		emit EdgesRemoved(edge_indices, remap_table);
+		BeginTransaction();
+		m_PendingChanges.EdgesChanged = true;
+		emit EdgesRemoved(edge_indices, moves);
+		Commit();
+
+		m_TempMoves = std::move(temp_moves);  // Release our hold on m_TempMoves
 	}
 
-	void CGraphModel::RebuildEdgeMap(edge_map_t& edge_map, const const_node_pairs_t& node_pairs)
+	void CGraphModel::AppendEdges(std::span<const node_pair_t> edges)
 	{
-		edge_map.clear();
-		edge_map.reserve(node_pairs.size());
-		for (edge_index_t edge_index = 0; edge_index < (edge_index_t)node_pairs.size(); edge_index++)
+		if (edges.empty())
+		{
+			return;
+		}
+
+		BeginTransaction();
+
+		const auto first_edge_index = EdgeCount();
+		m_Edges.reserve(m_Edges.size() + edges.size());
+		for (const auto& edge : edges)
+		{
+			const auto node_pair = node_pair_t(std::min(edge.first, edge.second), std::max(edge.first, edge.second));
+			AddNeighbour(node_pair.first, node_pair.second);
+			AddNeighbour(node_pair.second, node_pair.first);
+			m_Edges.push_back(node_pair);
+		}
+		CompactNeighbourTablesIfNeeded();
+
+		m_EdgeMap.reserve(m_Edges.size());
+		m_EdgeIds.resize(m_Edges.size());
+		for (auto edge_index = first_edge_index; edge_index < EdgeCount(); ++edge_index)
 		{
-			VERIFY(edge_map.insert(std::make_pair(MakeEdgeMapKey(node_pairs[edge_index]), edge_index)).second);
+			VERIFY(m_EdgeMap.insert(MakeEdgeMapKey(m_Edges[edge_index]), edge_index));
+			m_EdgeIds[edge_index] = m_EdgeIdMap.insert(edge_index);
 		}
+
+		decltype(m_TempIndices) temp_indices = std::move(m_TempIndices);  // Hold m_TempIndices in this scope, in case it is accessed 
+
+		temp_indices.resize(edges.size());
+		std::iota(temp_indices.begin(), temp_indices.end(), first_edge_index);
+		const auto new_edge_indices = to_const_span(temp_indices);
+
+		// Existing edges keep their indices, so there are no moves
+		UpdateSpatialIndexForNewEdges(new_edge_indices, index_moves_t());
+
+		m_PendingChanges.EdgesChanged = true;
+		emit EdgesInserted(new_edge_indices, index_moves_t());
+
+		m_TempIndices = std::move(temp_indices);  // Release our hold on m_TempIndices
+
+		Commit();
+	}
+
+	CGraphModel::node_index_t CGraphModel::NearestNode(const position_t& position, qreal max_distance) const
+	{
+		return m_NodeGrid.nearest((float)position.x(), (float)position.y(), (float)max_distance, [&](node_index_t node_index)
+			{
+				const auto v = m_NodePositions[node_index] - position;
+				return (float)std::sqrt(QPointF::dotProduct(v, v));
+			});
 	}
 
 	void CGraphModel::OnCatagoriesRemapped(const std::span<const size_t>& remap_table)
@@ -428,42 +629,210 @@ namespace jass
 		EndModifyNodes();
 	}
 
-	void CGraphModel::RebuildNeighbourTables(const std::span<const node_pair_t>& edges)
+	void CGraphModel::AddNeighbour(node_index_t node_index, node_index_t neighbour_index)
 	{
-		m_TempIndices.resize(edges.size() * 2 * 2);
-		typedef decltype(m_TempIndices)::value_type temp_index_t;
-		typedef std::pair<temp_index_t, temp_index_t> temp_pair_t;
-		std::span<temp_pair_t> temp_pairs((temp_pair_t*)m_TempIndices.data(), edges.size() * 2);
-
+		auto& neighbour_list = m_NeighbourLists[node_index];
+		if (neighbour_list.Count == neighbour_list.Capacity)
 		{
-			size_t n = 0;
-			for (const auto& edge : edges)
+			const auto new_capacity = std::max(MIN_NEIGHBOUR_CAPACITY, (node_index_t)(neighbour_list.Capacity * 2));
+			if (neighbour_list.First + neighbour_list.Capacity == m_NeighboursPerNode.size())
 			{
-				temp_pairs[n++] = { edge.first, edge.second };
-				temp_pairs[n++] = { edge.second, edge.first };
+				// Last block in buffer, grow in place
+				m_NeighboursPerNode.resize(neighbour_list.First + new_capacity, NO_NODE);
 			}
-			ASSERT(n == edges.size() * 2);
+			else
+			{
+				const auto new_first = (node_index_t)m_NeighboursPerNode.size();
+				m_NeighboursPerNode.resize(new_first + new_capacity, NO_NODE);
+				std::copy_n(m_NeighboursPerNode.begin() + neighbour_list.First, neighbour_list.Count, m_NeighboursPerNode.begin() + new_first);
+				m_UnusedNeighbourSlots += neighbour_list.Capacity;
+				neighbour_list.First = new_first;
+			}
+			neighbour_list.Capacity = new_capacity;
 		}
 
-		std::sort(temp_pairs.begin(), temp_pairs.end());
+		auto* neighbours = m_NeighboursPerNode.data() + neighbour_list.First;
+		auto* it = std::upper_bound(neighbours, neighbours + neighbour_list.Count, neighbour_index);
+		std::copy_backward(it, neighbours + neighbour_list.Count, neighbours + neighbour_list.Count + 1);
+		*it = neighbour_index;
+		++neighbour_list.Count;
+	}
 
-		m_NeighboursPerNode.resize(temp_pairs.size());
+	void CGraphModel::RemoveNeighbour(node_index_t node_index, node_index_t neighbour_index)
+	{
+		auto& neighbour_list = m_NeighbourLists[node_index];
+		auto* neighbours = m_NeighboursPerNode.data() + neighbour_list.First;
+		auto* it = std::lower_bound(neighbours, neighbours + neighbour_list.Count, neighbour_index);
+		ASSERT(it != neighbours + neighbour_list.Count && *it == neighbour_index);
+		std::copy(it + 1, neighbours + neighbour_list.Count, it);
+		--neighbour_list.Count;
+		neighbours[neighbour_list.Count] = NO_NODE;
+	}
 
+	void CGraphModel::MoveNodeEdges(node_index_t from, node_index_t to)
+	{
+		ASSERT(0 == m_NeighbourLists[to].Count);
+		for (const auto neighbour_index : NodeNeighbours(from))
 		{
-			size_t n = 0;
-			edge_index_t edge_count = 0;
-			for (node_index_t node_index = 0; node_index < NodeCount(); ++node_index)
+			const auto old_key = MakeEdgeMapKey(node_pair_t(from, neighbour_index));
+			const auto edge_index = *m_EdgeMap.find(old_key);
+			VERIFY(m_EdgeMap.erase(old_key));
+			auto& edge = m_Edges[edge_index];
+			((edge.first == from) ? edge.first : edge.second) = to;
+			VERIFY(m_EdgeMap.insert(MakeEdgeMapKey(edge), edge_index));
+
+			// Removing first leaves room, so the neighbour list is not reallocated
+			RemoveNeighbour(neighbour_index, from);
+			AddNeighbour(neighbour_index, to);
+		}
+		m_NeighbourLists[to] = m_NeighbourLists[from];
+		m_NeighbourLists[from] = SNeighbourList();
+	}
+
+	void CGraphModel::CompactNeighbourTablesIfNeeded()
+	{
+		if (m_UnusedNeighbourSlots > m_NeighboursPerNode.size() / 2)
+		{
+			CompactNeighbourTables();
+		}
+	}
+
+	void CGraphModel::CompactNeighbourTables()
+	{
+		size_t new_size = 0;
+		for (const auto& neighbour_list : m_NeighbourLists)
+		{
+			new_size += neighbour_list.Count + neighbour_list.Count / 2;
+		}
+
+		std::vector<node_index_t> new_neighbours(new_size, NO_NODE);
+		node_index_t at = 0;
+		for (auto& neighbour_list : m_NeighbourLists)
+		{
+			std::copy_n(m_NeighboursPerNode.begin() + neighbour_list.First, neighbour_list.Count, new_neighbours.begin() + at);
+			neighbour_list.First = at;
+			neighbour_list.Capacity = neighbour_list.Count + neighbour_list.Count / 2;
+			at += neighbour_list.Capacity;
+		}
+		ASSERT(at == new_size);
+
+		m_NeighboursPerNode = std::move(new_neighbours);
+		m_UnusedNeighbourSlots = 0;
+	}
+
+	void CGraphModel::RebuildSpatialIndex()
+	{
+		const float DEFAULT_CELL_SIZE = 64;
+		const float NODES_PER_CELL = 4;
+
+		float cell_size = DEFAULT_CELL_SIZE;
+		if (NodeCount() > 1)
+		{
+			auto bounds = QRectF(m_NodePositions.front(), m_NodePositions.front());
+			for (const auto& position : m_NodePositions)
 			{
-				m_FirstEdgePerNode[node_index] = (node_index_t)n;
-				for (; n < temp_pairs.size() && temp_pairs[n].first == node_index; ++n)
-				{
-					m_NeighboursPerNode[n] = temp_pairs[n].second;
-				}
+				bounds.setLeft(std::min(bounds.left(), position.x()));
+				bounds.setTop(std::min(bounds.top(), position.y()));
+				bounds.setRight(std::max(bounds.right(), position.x()));
+				bounds.setBottom(std::max(bounds.bottom(), position.y()));
+			}
+			const auto area = bounds.width() * bounds.height();
+			const auto extent = std::max(bounds.width(), bounds.height());
+			const auto estimate = (float)((area > 0) ? std::sqrt(area * NODES_PER_CELL / NodeCount()) : extent * NODES_PER_CELL / NodeCount());
+			if (estimate > 0)
+			{
+				cell_size = estimate;
 			}
-			m_FirstEdgePerNode.back() = (node_index_t)n;  // has one extra element!
 		}
+
+		m_NodeGrid.reset(cell_size, NodeCount());
+		for (node_index_t node_index = 0; node_index < NodeCount(); ++node_index)
+		{
+			m_NodeGrid.insert(node_index, NodeBox(node_index));
+		}
+
+		m_EdgeGrid.reset(cell_size, EdgeCount());
+		for (edge_index_t edge_index = 0; edge_index < EdgeCount(); ++edge_index)
+		{
+			m_EdgeGrid.insert(edge_index, EdgeBox(edge_index));
+		}
+
+		m_SpatialIndexNodeCount = NodeCount();
+		m_TypicalNodeSpacing = cell_size / std::sqrt(NODES_PER_CELL);
 	}
 
+	void CGraphModel::RebuildEdgeLookup()
+	{
+		m_EdgeMap = edge_map_t();
+		m_EdgeMap.reserve(m_Edges.size());
+		for (edge_index_t edge_index = 0; edge_index < EdgeCount(); ++edge_index)
+		{
+			VERIFY(m_EdgeMap.insert(MakeEdgeMapKey(m_Edges[edge_index]), edge_index));
+		}
+
+		m_EdgeGrid.reset(m_EdgeGrid.cell_size(), EdgeCount());
+		for (edge_index_t edge_index = 0; edge_index < EdgeCount(); ++edge_index)
+		{
+			m_EdgeGrid.insert(edge_index, EdgeBox(edge_index));
+		}
+	}
+
+	void CGraphModel::UpdateSpatialIndexForModifiedNodes(const sparse_bitvec& node_mask)
+	{
+		// When most nodes move at once, as when positions are loaded, the cell size is likely off
+		if (node_mask.count_set_bits() * 2 > NodeCount())
+		{
+			RebuildSpatialIndex();
+			return;
+		}
+
+		node_mask.for_each_set_bit([&](size_t node_index)
+			{
+				m_NodeGrid.update((node_index_t)node_index, NodeBox((node_index_t)node_index));
+				ForEachEdgeFromNode((node_index_t)node_index, [&](edge_index_t edge_index, node_index_t neighbour_index)
+					{
+						m_EdgeGrid.update(edge_index, EdgeBox(edge_index));
+					});
+			});
+	}
+
+	void CGraphModel::UpdateSpatialIndexForNewNodes(const const_node_indices_t& node_indices, const index_moves_t& moves)
+	{
+		if (SpatialIndexNeedsRebuild(NodeCount()))
+		{
+			RebuildSpatialIndex();
+			return;
+		}
+
+		m_NodeGrid.resize(NodeCount());
+		for (const auto& move : moves)
+		{
+			m_NodeGrid.move(move.first, move.second);
+		}
+		for (const auto node_index : node_indices)
+		{
+			m_NodeGrid.insert(node_index, NodeBox(node_index));
+		}
+	}
+
+	void CGraphModel::UpdateSpatialIndexForNewEdges(const const_edge_indices_t& edge_indices, const index_moves_t& moves)
+	{
+		m_EdgeGrid.resize(EdgeCount());
+		for (const auto& move : moves)
+		{
+			m_EdgeGrid.move(move.first, move.second);
+		}
+		for (const auto edge_index : edge_indices)
+		{
+			m_EdgeGrid.insert(edge_index, EdgeBox(edge_index));
+		}
+	}
+
+	bool CGraphModel::SpatialIndexNeedsRebuild(size_t node_count) const
+	{
+		const size_t SLACK = 64;
+		return node_count > 2 * m_SpatialIndexNodeCount + SLACK || 2 * node_count + SLACK < m_SpatialIndexNodeCount;
+	}
 
 	// CGraphSelectionModel
 
@@ -502,47 +871,54 @@ namespace jass
 		m_EdgeMask.resize(m_DataModel.EdgeCount());
 	}
 
-	void CGraphSelectionModel::OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CGraphSelectionModel::OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves)
 	{
 		BeginModify();
-		RemapMask(m_NodeMask, remap_table, m_DataModel.NodeCount());
+		InsertIntoMask(m_NodeMask, node_indices, moves, m_DataModel.NodeCount());
 		EndModify();
 	}
 
-	void CGraphSelectionModel::OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CGraphSelectionModel::OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves)
 	{
 		BeginModify();
-		RemapMask(m_NodeMask, remap_table, m_DataModel.NodeCount());
+		RemoveFromMask(m_NodeMask, moves, m_DataModel.NodeCount());
 		EndModify();
 	}
 
-	void CGraphSelectionModel::OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CGraphSelectionModel::OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::index_moves_t& moves)
 	{
 		BeginModify();
-		RemapMask(m_EdgeMask, remap_table, m_DataModel.EdgeCount());
+		InsertIntoMask(m_EdgeMask, edge_indices, moves, m_DataModel.EdgeCount());
 		EndModify();
 	}
 
-	void CGraphSelectionModel::OnEdgesRemoved(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CGraphSelectionModel::OnEdgesRemoved(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::index_moves_t& moves)
 	{
 		BeginModify();
-		RemapMask(m_EdgeMask, remap_table, m_DataModel.EdgeCount());
+		RemoveFromMask(m_EdgeMask, moves, m_DataModel.EdgeCount());
 		EndModify();
 	}
 
-	void CGraphSelectionModel::RemapMask(bitvec& mask, const CGraphModel::node_remap_table_t& remap_table, size_t new_size)
+	void CGraphSelectionModel::InsertIntoMask(bitvec& mask, const std::span<const CGraphModel::index_t>& indices, const CGraphModel::index_moves_t& moves, size_t new_size)
 	{
-		m_TempMask = mask;
 		mask.resize(new_size);
-		mask.clearAll();
-		m_TempMask.for_each_set_bit([&](size_t old_index)
-			{
-				const auto new_index = remap_table[old_index];
-				if (new_index < mask.size())
-				{
-					mask.set(new_index);
-				}
-			});
+		for (const auto& move : moves)
+		{
+			mask.set(move.second, mask.get(move.first));
+		}
+		for (const auto index : indices)
+		{
+			mask.clear(index);
+		}
+	}
+
+	void CGraphSelectionModel::RemoveFromMask(bitvec& mask, const CGraphModel::index_moves_t& moves, size_t new_size)
+	{
+		for (const auto& move : moves)
+		{
+			mask.set(move.second, mask.get(move.first));
+		}
+		mask.resize(new_size);
 	}
 
 }
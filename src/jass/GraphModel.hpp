@@ -23,16 +23,21 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <cstdint>
 #include <span>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <QtCore/qobject.h>
 #include <QtGui/qrgb.h>
 #include <QtCore/qpoint.h>
+#include <QtCore/qrect.h>
 #include <QtCore/qstring.h>
 
 #include <jass/graphdata/GraphView.h>
 #include <jass/utils/bitvec.h>
+#include <jass/utils/flat_hash_map.h>
+#include <jass/utils/slot_map.h>
+#include <jass/utils/sparse_bitvec.h>
+#include <jass/utils/spatial_grid.h>
+#include <jass/utils/string_pool.h>
 #include <jass/Debug.h>
 #include <jass/Shape.h>
 
@@ -71,9 +76,13 @@ namespace jass
 		typedef std::pair<node_index_t, node_index_t> node_pair_t;
 		typedef std::span<const node_index_t> const_node_indices_t;
 		typedef std::span<const edge_index_t> const_edge_indices_t;
-		typedef std::span<const node_index_t> node_remap_table_t;
+		typedef std::pair<index_t, index_t> index_move_t;  // (from, to)
+		typedef std::span<const index_move_t> index_moves_t;
 		typedef std::span<const node_pair_t> const_node_pairs_t;
 		typedef void* node_attribute_t;
+		typedef string_pool::id_t string_id_t;
+		typedef slot_map_handle node_id_t;
+		typedef slot_map_handle edge_id_t;
 
 		static const node_index_t NO_NODE;
 		static const attribute_index_t NO_ATTRIBUTE;
@@ -86,11 +95,24 @@ namespace jass
 			EShape Shape;
 		};
 
+		// What changed during a transaction, see BeginTransaction
+		struct SChangeSet
+		{
+			bool NodesInserted = false;
+			bool NodesRemoved = false;
+			bool NodesModified = false;
+			bool EdgesChanged = false;
+			bool AttributesChanged = false;
+
+			inline bool TopologyChanged() const { return NodesInserted || NodesRemoved || EdgesChanged; }
+			inline bool Any() const { return TopologyChanged() || NodesModified || AttributesChanged; }
+		};
+
 		CGraphModel();
 
 		inline node_index_t NodeCount() const { return (node_index_t)m_NodePositions.size(); }
 
-		inline node_index_t EdgeCount() const { return (node_index_t)m_NeighboursPerNode.size() >> 1; }
+		inline node_index_t EdgeCount() const { return (node_index_t)m_Edges.size(); }
 
 		node_index_t AddNodes(size_t count);
 
@@ -116,80 +138,200 @@ namespace jass
 		
 		void EndModifyNodes();
 
+		// Defers the Changed signal to the matching Commit, which emits it once, with flags for the
+		// kinds of change made rather than the changes themselves. Every change is still applied
+		// and signaled individually as it is made, since later changes refer to indices produced
+		// by earlier ones, so per-change work is not saved unless a listener only marks itself
+		// dirty on those signals and catches up on Changed. Transactions nest, and every
+		// modification runs in an implicit transaction of its own.
+		void BeginTransaction();
+
+		void Commit();
+
 		inline const position_t& NodePosition(node_index_t node_index) const;
 
 		inline void SetNodePosition(node_index_t node_index, const position_t& position);
 
 		inline category_index_t NodeCategory(node_index_t node_index) const;
 
+		inline std::span<const position_t> NodePositions() const { return m_NodePositions; }
+
+		inline std::span<const category_index_t> NodeCategories() const { return m_NodeCategories; }
+
+		// Set values of all nodes at once
+		void SetNodePositions(std::span<const position_t> positions);
+
+		void SetNodeCategories(std::span<const category_index_t> categories);
+
 		inline void SetNodeCategory(node_index_t node_index, category_index_t category_index);
 
-		inline const QString& NodeName(node_index_t node_index) const;
+		inline QString NodeName(node_index_t node_index) const;
 
 		inline void SetNodeName(node_index_t node_index, const QString& name);
+
+		// Node names are interned, so equal names share an id
+		inline string_id_t NodeNameId(node_index_t node_index) const { return m_NodeNameIds[node_index]; }
 		
 		inline std::span<const node_index_t> NodeNeighbours(node_index_t node_index) const;
 
 		template <class TLambda> void ForEachEdgeFromNode(node_index_t node_index, TLambda&&) const;
 
+		// Nodes already at the (sorted) indices of 'nodes' are moved to the end, rather than every
+		// following node shifting up, so only the inserted and moved nodes change index. The moves
+		// are emitted with NodesInserted.
 		void InsertNodes(const std::span<const SNodeDesc>& nodes);  // TODO: Simply span of indices here instead
 
+		// The reverse of InsertNodes: nodes from the end are moved into the holes, so removing nodes
+		// and inserting them again at the same indices restores the order. Indices must be sorted.
 		void RemoveNodes(const const_node_indices_t& node_indices);
 
+		// Bulk version of InsertNodes for nodes added after all existing nodes, which keeps existing
+		// indices unchanged. Returns index of first new node.
+		node_index_t AppendNodes(std::span<const position_t> positions, std::span<const category_index_t> categories);
+
 		void AddEdges(const std::span<const node_pair_t>& edges);
 
+		// Edges are moved like nodes in InsertNodes and RemoveNodes
 		void InsertEdges(const std::span<const SEdgeDesc>& edges);
 
 		void RemoveEdges(const std::span<const edge_index_t>& edge_indices);
 
+		// Bulk version of InsertEdges for edges added after all existing edges
+		void AppendEdges(std::span<const node_pair_t> edges);
+
 		inline bool TryGetEdgeFromNodePair(const node_pair_t& node_pair, edge_index_t& our_edge_index) const;
 
 		inline edge_index_t EdgeFromNodePair(const node_pair_t& node_pair) const;
 
 		inline node_pair_t EdgeNodePair(edge_index_t edge_index) const;
 
+		// Ids follow nodes and edges while their indices change. The id of a removed node or edge
+		// never resolves again, even once its index is reused.
+		inline node_id_t NodeId(node_index_t node_index) const { return m_NodeIds[node_index]; }
+
+		// Returns NO_NODE if the node has been removed
+		inline node_index_t NodeIndexFromId(node_id_t node_id) const;
+
+		inline edge_id_t EdgeId(edge_index_t edge_index) const { return m_EdgeIds[edge_index]; }
+
+		// Returns NO_NODE if the edge has been removed
+		inline edge_index_t EdgeIndexFromId(edge_id_t edge_id) const;
+
+		// Calls fn(node_index) for every node positioned within 'rect'
+		template <class TFunc> void ForEachNodeInRect(const QRectF& rect, TFunc&& fn) const;
+
+		// Calls fn(edge_index) for every edge with a bounding box intersecting 'rect'
+		template <class TFunc> void ForEachEdgeInRect(const QRectF& rect, TFunc&& fn) const;
+
+		// Returns NO_NODE if there is no node within 'max_distance'
+		node_index_t NearestNode(const position_t& position, qreal max_distance) const;
+
+		// Estimated distance between neighbouring nodes, from the node density. Updated along with
+		// the spatial index.
+		inline qreal TypicalNodeSpacing() const { return m_TypicalNodeSpacing; }
+
 		template <class T>
 		inline CNodeAttribute<T>* TryGetNodeAttribute(const QString& name);
 
 		inline void SetNodeModified(node_index_t node_index) { VerifyModifyingNodes(); m_NodeModificationMask.set(node_index); }
 
+		inline void SetAllNodesModified() { VerifyModifyingNodes(); m_NodeModificationMask.set_range(0, NodeCount()); }
+
 		inline void VerifyModifyingNodes() const { ASSERT(m_NodeModificationCounter > 0); }
 
 	Q_SIGNALS:
 		void AttributeChanged(attribute_index_t index, const QVariant& value);
-		void NodesInserted(const const_node_indices_t& node_indices, const node_remap_table_t& remap_table);
-		void NodesRemoved(const const_node_indices_t& node_indices, const node_remap_table_t& remap_table);
+		// 'moves' lists the (from, to) index of every existing node or edge that moved, which is
+		// none when appending. Every other existing index is unchanged.
+		void NodesInserted(const const_node_indices_t& node_indices, const index_moves_t& moves);
+		void NodesRemoved(const const_node_indices_t& node_indices, const index_moves_t& moves);
 		void EdgesAdded(size_t count);
-		void EdgesInserted(const const_edge_indices_t& edge_indices, const node_remap_table_t& remap_table);
-		void EdgesRemoved(const const_edge_indices_t& edge_indices, const node_remap_table_t& remap_table);
-		void NodesModified(const bitvec& node_mask);
+		void EdgesInserted(const const_edge_indices_t& edge_indices, const index_moves_t& moves);
+		void EdgesRemoved(const const_edge_indices_t& edge_indices, const index_moves_t& moves);
+		void NodesModified(const sparse_bitvec& node_mask);
+		void Changed(const SChangeSet& changes);
 
 	public Q_SLOTS:
 		void OnCatagoriesRemapped(const std::span<const size_t>& remap_table);
 
 	private:
-		typedef size_t edge_key_t;
-		typedef std::unordered_map<edge_key_t, edge_index_t> edge_map_t;
+		typedef uint64_t edge_key_t;
+		typedef flat_hash_map<edge_index_t> edge_map_t;
 
-		void RebuildNeighbourTables(const std::span<const node_pair_t>& edges);
+		// Neighbours of a node are kept sorted in a block of m_NeighboursPerNode, with room to grow.
+		// A full block is moved to the end of the buffer with doubled capacity, leaving a hole that
+		// is reclaimed by CompactNeighbourTables.
+		struct SNeighbourList
+		{
+			node_index_t First = 0;
+			node_index_t Count = 0;
+			node_index_t Capacity = 0;
+		};
 
-		static void RebuildEdgeMap(edge_map_t& edge_map, const const_node_pairs_t& node_pairs);
+		static constexpr node_index_t MIN_NEIGHBOUR_CAPACITY = 4;
+
+		void AddNeighbour(node_index_t node_index, node_index_t neighbour_index);
+
+		void RemoveNeighbour(node_index_t node_index, node_index_t neighbour_index);
+
+		void CompactNeighbourTablesIfNeeded();
+
+		void CompactNeighbourTables();
+
+		// Moves the edges and neighbour list of node 'from' to node 'to', which must have no edges
+		void MoveNodeEdges(node_index_t from, node_index_t to);
 
 		inline static edge_key_t MakeEdgeMapKey(const node_pair_t& node_pair);
 
+		// Node positions and edge bounding boxes are kept in uniform grids. The cell size is picked
+		// from the node density by RebuildSpatialIndex, which runs again when the node count has
+		// changed too much since, or when most nodes move at once.
+		void RebuildSpatialIndex();
+
+		void UpdateSpatialIndexForModifiedNodes(const sparse_bitvec& node_mask);
+
+		void UpdateSpatialIndexForNewNodes(const const_node_indices_t& node_indices, const index_moves_t& moves);
+
+		void UpdateSpatialIndexForNewEdges(const const_edge_indices_t& edge_indices, const index_moves_t& moves);
+
+		// Whether the cell size is likely off once there are 'node_count' nodes
+		bool SpatialIndexNeedsRebuild(size_t node_count) const;
+
+		// Rebuilds the edge map and edge grid from the remaining edges
+		void RebuildEdgeLookup();
+
+		inline spatial_grid::box NodeBox(node_index_t node_index) const;
+
+		inline spatial_grid::box EdgeBox(edge_index_t edge_index) const;
+
+		inline static spatial_grid::box BoxFromRect(const QRectF& rect);
+
 		std::vector<std::pair<QString, QVariant>> m_Attributes;
 		std::vector<std::pair<QString, std::unique_ptr<CNodeAttributeBase>>> m_NodeAttributes;
 
-		std::vector<QString> m_NodeNames;
+		string_pool m_Strings;
+		std::vector<string_id_t> m_NodeNameIds;
 		std::vector<position_t> m_NodePositions;
 		std::vector<category_index_t> m_NodeCategories;
-		std::vector<node_index_t> m_FirstEdgePerNode;  // has one extra element!
+		std::vector<SNeighbourList> m_NeighbourLists;
 		std::vector<node_index_t> m_NeighboursPerNode;
+		size_t m_UnusedNeighbourSlots = 0;  // Slots in m_NeighboursPerNode not owned by any node
 		std::vector<node_pair_t> m_Edges;
-		std::unordered_map<edge_key_t, edge_index_t> m_EdgeMap;
+		edge_map_t m_EdgeMap;
+		std::vector<node_id_t> m_NodeIds;
+		std::vector<edge_id_t> m_EdgeIds;
+		slot_map<node_index_t> m_NodeIdMap;
+		slot_map<edge_index_t> m_EdgeIdMap;
+		spatial_grid m_NodeGrid;
+		spatial_grid m_EdgeGrid;
+		node_index_t m_SpatialIndexNodeCount = 0;  // Node count at last RebuildSpatialIndex
+		qreal m_TypicalNodeSpacing = 0;
 		std::vector<index_t> m_TempIndices;
+		std::vector<index_move_t> m_TempMoves;
 		int m_NodeModificationCounter = 0;
-		bitvec m_NodeModificationMask;
+		int m_TransactionCounter = 0;
+		SChangeSet m_PendingChanges;
+		sparse_bitvec m_NodeModificationMask;
 	};
 
 	inline const CGraphModel::position_t& CGraphModel::NodePosition(node_index_t node_index) const 
@@ -216,22 +358,22 @@ namespace jass
 		}
 	}
 
-	inline const QString& CGraphModel::NodeName(node_index_t node_index) const 
+	inline QString CGraphModel::NodeName(node_index_t node_index) const 
 	{
-		return m_NodeNames[node_index]; 
+		const auto name = m_Strings.view(m_NodeNameIds[node_index]);
+		return QString::fromUtf16(name.data(), (int)name.size());
 	}
 
 	inline void CGraphModel::SetNodeName(node_index_t node_index, const QString& name) 
 	{ 
-		m_NodeNames[node_index] = name; 
+		m_NodeNameIds[node_index] = m_Strings.intern(std::u16string_view((const char16_t*)name.utf16(), name.size()));
 		SetNodeModified(node_index); 
 	}
 
 	inline std::span<const CGraphModel::node_index_t> CGraphModel::NodeNeighbours(node_index_t node_index) const
 	{
-		return std::span<const node_index_t>(
-			m_NeighboursPerNode.data() + m_FirstEdgePerNode[node_index],
-			m_NeighboursPerNode.data() + m_FirstEdgePerNode[node_index + 1]);
+		const auto& neighbour_list = m_NeighbourLists[node_index];
+		return std::span<const node_index_t>(m_NeighboursPerNode.data() + neighbour_list.First, neighbour_list.Count);
 	}
 
 	template <class TLambda> void CGraphModel::ForEachEdgeFromNode(node_index_t node_index, TLambda&& fn) const
@@ -245,12 +387,12 @@ namespace jass
 
 	inline bool CGraphModel::TryGetEdgeFromNodePair(const node_pair_t& node_pair, edge_index_t& out_edge_index) const
 	{
-		auto it = m_EdgeMap.find(MakeEdgeMapKey(node_pair));
-		if (m_EdgeMap.end() == it)
+		const auto* edge_index = m_EdgeMap.find(MakeEdgeMapKey(node_pair));
+		if (!edge_index)
 		{
 			return false;
 		}
-		out_edge_index = it->second;
+		out_edge_index = *edge_index;
 		return true;
 	}
 
@@ -266,9 +408,66 @@ namespace jass
 		return m_Edges[edge_index];
 	}
 
+	inline CGraphModel::node_index_t CGraphModel::NodeIndexFromId(node_id_t node_id) const
+	{
+		const auto* node_index = m_NodeIdMap.find(node_id);
+		return node_index ? *node_index : NO_NODE;
+	}
+
+	inline CGraphModel::edge_index_t CGraphModel::EdgeIndexFromId(edge_id_t edge_id) const
+	{
+		const auto* edge_index = m_EdgeIdMap.find(edge_id);
+		return edge_index ? *edge_index : NO_NODE;
+	}
+
+	template <class TFunc> void CGraphModel::ForEachNodeInRect(const QRectF& rect, TFunc&& fn) const
+	{
+		m_NodeGrid.query(BoxFromRect(rect), [&](node_index_t node_index)
+			{
+				if (rect.contains(m_NodePositions[node_index]))
+				{
+					fn(node_index);
+				}
+			});
+	}
+
+	template <class TFunc> void CGraphModel::ForEachEdgeInRect(const QRectF& rect, TFunc&& fn) const
+	{
+		const auto box = BoxFromRect(rect);
+		m_EdgeGrid.query(box, [&](edge_index_t edge_index)
+			{
+				const auto edge_box = EdgeBox(edge_index);
+				if (edge_box.x0 <= box.x1 && edge_box.x1 >= box.x0 && edge_box.y0 <= box.y1 && edge_box.y1 >= box.y0)
+				{
+					fn(edge_index);
+				}
+			});
+	}
+
+	inline spatial_grid::box CGraphModel::NodeBox(node_index_t node_index) const
+	{
+		const auto& p = m_NodePositions[node_index];
+		return { (float)p.x(), (float)p.y(), (float)p.x(), (float)p.y() };
+	}
+
+	inline spatial_grid::box CGraphModel::EdgeBox(edge_index_t edge_index) const
+	{
+		const auto& p0 = m_NodePositions[m_Edges[edge_index].first];
+		const auto& p1 = m_NodePositions[m_Edges[edge_index].second];
+		return {
+			(float)std::min(p0.x(), p1.x()), (float)std::min(p0.y(), p1.y()),
+			(float)std::max(p0.x(), p1.x()), (float)std::max(p0.y(), p1.y()) };
+	}
+
+	inline spatial_grid::box CGraphModel::BoxFromRect(const QRectF& rect)
+	{
+		const auto r = rect.normalized();
+		return { (float)r.left(), (float)r.top(), (float)r.right(), (float)r.bottom() };
+	}
+
 	inline CGraphModel::edge_key_t CGraphModel::MakeEdgeMapKey(const node_pair_t& node_pair)
 	{
-		return ((size_t)std::min(node_pair.first, node_pair.second) << 32) | std::max(node_pair.first, node_pair.second);
+		return ((edge_key_t)std::min(node_pair.first, node_pair.second) << 32) | std::max(node_pair.first, node_pair.second);
 	}
 
 
@@ -332,19 +531,19 @@ namespace jass
 		void SelectionChanged();
 
 	private Q_SLOTS:
-		void OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table);
-		void OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table);
-		void OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::node_remap_table_t& remap_table);
-		void OnEdgesRemoved(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::node_remap_table_t& remap_table);
+		void OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves);
+		void OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves);
+		void OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::index_moves_t& moves);
+		void OnEdgesRemoved(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::index_moves_t& moves);
 
 	private:
-		void RemapMask(bitvec& mask, const CGraphModel::node_remap_table_t& remap_table, size_t new_size);
+		static void InsertIntoMask(bitvec& mask, const std::span<const CGraphModel::index_t>& indices, const CGraphModel::index_moves_t& moves, size_t new_size);
+		static void RemoveFromMask(bitvec& mask, const CGraphModel::index_moves_t& moves, size_t new_size);
 		inline void VerifyModifying() const { ASSERT(m_ModificationCounter > 0); }
 
 		CGraphModel& m_DataModel;
 		bitvec m_NodeMask;
 		bitvec m_EdgeMask;
-		bitvec m_TempMask;
 		int m_ModificationCounter = 0;
 	};
 
@@ -34,6 +34,23 @@ namespace jass
 	void CreateSymbol(QIODevice& out, const std::string_view& row_prefix, const char* name, EShape shape, QRgb color, float radius, float scale, float line_width, float line_width2);
 	void CreateShape(QIODevice& out, const std::string_view& row_prefix, const QPointF& pos, EShape shape, QRgb color, float radius, float scale, float line_width, float line_width2);
 
+	static QRectF BoundingBox(std::span<const QPointF> points)
+	{
+		if (points.empty())
+		{
+			return QRectF(0, 0, 0, 0);
+		}
+		QRectF bb(points.front(), points.front());
+		for (const auto& pos : points)
+		{
+			bb.setLeft(std::min(pos.x(), bb.left()));
+			bb.setTop(std::min(pos.y(), bb.top()));
+			bb.setRight(std::max(pos.x(), bb.right()));
+			bb.setBottom(std::max(pos.y(), bb.bottom()));
+		}
+		return bb;
+	}
+
 	void ExportJassToSVG(QIODevice& out, const CJassDocument& doc, const CGraphNodeTheme* graphNodeTheme)
 	{
 		const float SYMBOL_SCALE = 8;
@@ -49,37 +66,17 @@ namespace jass
 		auto* justified_position_node_attribute = TryGetJPositionNodeAttribute(data_model);
 
 		// Normal Bounding box
-		QRectF bbNormal(0, 0, 0, 0);
-		if (data_model.NodeCount())
+		QRectF bbNormal = BoundingBox(data_model.NodePositions());
+		if (!bbNormal.isEmpty())
 		{
-			bbNormal = QRectF(data_model.NodePosition(0), data_model.NodePosition(0));
-			for (CGraphModel::node_index_t node_index = 0; node_index < data_model.NodeCount(); ++node_index)
-			{
-				const auto pos = data_model.NodePosition(node_index);
-				bbNormal.setLeft(std::min(pos.x(), bbNormal.left()));
-				bbNormal.setTop(std::min(pos.y(), bbNormal.top()));
-				bbNormal.setRight(std::max(pos.x(), bbNormal.right()));
-				bbNormal.setBottom(std::max(pos.y(), bbNormal.bottom()));
-			}
-			if (!bbNormal.isEmpty())
-			{
-				bbNormal.adjust(-SYMBOL_RADIUS, -SYMBOL_RADIUS, SYMBOL_RADIUS, SYMBOL_RADIUS);
-			}
+			bbNormal.adjust(-SYMBOL_RADIUS, -SYMBOL_RADIUS, SYMBOL_RADIUS, SYMBOL_RADIUS);
 		}
 
 		// Justified Bounding box
 		QRectF bbJustified(0, 0, 0, 0);
-		if (data_model.NodeCount() && justified_position_node_attribute)
+		if (justified_position_node_attribute)
 		{
-			bbJustified = QRectF(justified_position_node_attribute->Value(0), justified_position_node_attribute->Value(0));
-			for (CGraphModel::node_index_t node_index = 0; node_index < data_model.NodeCount(); ++node_index)
-			{
-				const auto pos = justified_position_node_attribute->Value(node_index);
-				bbJustified.setLeft(std::min(pos.x(), bbJustified.left()));
-				bbJustified.setTop(std::min(pos.y(), bbJustified.top()));
-				bbJustified.setRight(std::max(pos.x(), bbJustified.right()));
-				bbJustified.setBottom(std::max(pos.y(), bbJustified.bottom()));
-			}
+			bbJustified = BoundingBox(justified_position_node_attribute->Values());
 			if (!bbJustified.isEmpty())
 			{
 				bbJustified.adjust(-SYMBOL_RADIUS, -SYMBOL_RADIUS, SYMBOL_RADIUS, SYMBOL_RADIUS);
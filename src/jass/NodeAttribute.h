@@ -19,6 +19,10 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
 #include <QtCore/qvariant.h>
 
 namespace jass
@@ -29,6 +33,7 @@ namespace jass
 	{
 	public:
 		typedef uint32_t node_index_t;
+		typedef std::pair<node_index_t, node_index_t> node_move_t;
 
 		CNodeAttributeBase(CGraphModel& graph_model, QVariant::Type type);
 		virtual ~CNodeAttributeBase();
@@ -41,7 +46,8 @@ namespace jass
 
 		virtual void Init(const void* data, size_t data_size_bytes) = 0;
 
-		virtual void Copy(void* buffer, size_t buffer_size_bytes) const = 0;
+		// Values of all nodes, in node order
+		virtual std::span<const std::byte> Data() const = 0;
 
 		template <class T>
 		inline const T& Value(size_t node_index) const;
@@ -52,9 +58,10 @@ namespace jass
 	protected:
 		virtual void Resize(size_t count) = 0;
 
-		virtual void Expand(const std::span<const node_index_t>& hole_indices) = 0;
+		// Applies node moves, as emitted with CGraphModel::NodesInserted and NodesRemoved
+		virtual void Insert(const std::span<const node_index_t>& node_indices, const std::span<const node_move_t>& moves) = 0;
 
-		virtual void Collapse(const std::span<const node_index_t>& hole_indices) = 0;
+		virtual void Remove(const std::span<const node_move_t>& moves, size_t new_count) = 0;
 
 		friend CGraphModel;
 
@@ -73,14 +80,19 @@ namespace jass
 		inline const T& Value(size_t node_index) const;
 		inline void     SetValue(size_t node_index, const T& value);
 
+		inline std::span<const T> Values() const { return m_Values; }
+
+		// Sets values of all nodes
+		void SetValues(std::span<const T> values);
+
 		void Init(const void* data, size_t data_size_bytes) override;
 
-		void Copy(void* buffer, size_t buffer_size_bytes) const override;
+		std::span<const std::byte> Data() const override;
 
 	protected:
 		void Resize(size_t count) override;
-		void Expand(const std::span<const node_index_t>& hole_indices) override;
-		void Collapse(const std::span<const node_index_t>& remove_indices) override;
+		void Insert(const std::span<const node_index_t>& node_indices, const std::span<const node_move_t>& moves) override;
+		void Remove(const std::span<const node_move_t>& moves, size_t new_count) override;
 
 	private:
 		std::vector<T> m_Values;
@@ -79,6 +79,16 @@ namespace jass
 		m_GraphModel.SetNodeModified((CGraphModel::node_index_t)node_index);
 	}
 
+	template <class T>
+	void CNodeAttribute<T>::SetValues(std::span<const T> values)
+	{
+		ASSERT(values.size() == m_Values.size());
+		BeginModify();
+		std::copy(values.begin(), values.end(), m_Values.begin());
+		m_GraphModel.SetAllNodesModified();
+		EndModify();
+	}
+
 	template <class T>
 	void CNodeAttribute<T>::Init(const void* data, size_t data_size_bytes)
 	{
@@ -87,10 +97,9 @@ namespace jass
 	}
 
 	template <class T>
-	void CNodeAttribute<T>::Copy(void* buffer, size_t buffer_size_bytes) const
+	std::span<const std::byte> CNodeAttribute<T>::Data() const
 	{
-		ASSERT(m_Values.size() * sizeof(T) == buffer_size_bytes);
-		std::copy(m_Values.begin(), m_Values.end(), (T*)buffer);
+		return std::as_bytes(std::span<const T>(m_Values));
 	}
 
 	template <class T>
@@ -100,14 +109,14 @@ namespace jass
 	}
 
 	template <class T>
-	void CNodeAttribute<T>::Expand(const std::span<const node_index_t>& hole_indices)
+	void CNodeAttribute<T>::Insert(const std::span<const node_index_t>& node_indices, const std::span<const node_move_t>& moves)
 	{
-		jass::expand(m_Values, hole_indices, m_DefaultValue);
+		jass::insert_by_moves(m_Values, node_indices, moves, m_DefaultValue);
 	}
 
 	template <class T>
-	void CNodeAttribute<T>::Collapse(const std::span<const node_index_t>& remove_indices)
+	void CNodeAttribute<T>::Remove(const std::span<const node_move_t>& moves, size_t new_count)
 	{
-		jass::collapse(m_Values, remove_indices);
+		jass::remove_by_moves(m_Values, moves, new_count);
 	}
 }
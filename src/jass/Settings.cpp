@@ -22,6 +22,9 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 namespace jass
 {
 	const QString CSettings::UI_SCALE = "ui/scale";
+	const QString CSettings::LOD_REDUCED_BELOW = "view/lod_reduced_below";
+	const QString CSettings::LOD_MINIMAL_BELOW = "view/lod_minimal_below";
+	const QString CSettings::DEPTH_MATRIX_BUDGET = "analysis/depth_matrix_budget";
 
 	CSettings::CSettings(QSettings& qsettings)
 		: m_QSettings(qsettings)
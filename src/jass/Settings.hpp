@@ -28,6 +28,9 @@ namespace jass
 		Q_OBJECT
 	public:
 		static const QString UI_SCALE;
+		static const QString LOD_REDUCED_BELOW;
+		static const QString LOD_MINIMAL_BELOW;
+		static const QString DEPTH_MATRIX_BUDGET;
 
 		CSettings(QSettings& qsettings);
 
@@ -0,0 +1,274 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace jass
+{
+	// Shortest path search that grows one BFS from each end, always expanding the smaller
+	// frontier one layer at a time, until they meet. Edges are assumed to be bidirectional.
+	template <class TGraph>
+	class CBidirectionalBfs
+	{
+	public:
+		typedef TGraph::node_index_t node_index_t;
+		typedef std::vector<size_t> path_t;
+
+		// Finds up to 'max_path_count' distinct paths of shortest length between two nodes.
+		// Returns false if there is no path.
+		bool FindShortestPaths(const TGraph& graph, size_t from_node_index, size_t to_node_index, size_t max_path_count, std::vector<path_t>& out_paths);
+
+	private:
+		static constexpr uint32_t NO_DEPTH = (uint32_t)-1;
+
+		struct SFrame
+		{
+			size_t NodeIndex;
+			size_t CandidatesBegin;
+			size_t NextCandidate;
+			size_t CandidatesEnd;
+		};
+
+		void Reset(size_t node_count);
+		void Touch(size_t node_index);
+		void ExpandLayer(const TGraph& graph, std::vector<size_t>& frontier, std::vector<uint32_t>& depths, const std::vector<uint32_t>& other_depths, uint32_t& in_out_path_length);
+		void MarkForwardNodesReachingTarget(const TGraph& graph, uint32_t path_length);
+		inline bool IsOnShortestPath(size_t node_index, uint32_t position, uint32_t path_length) const;
+		void PushFrame(const TGraph& graph, size_t node_index, uint32_t path_length);
+		void CollectPaths(const TGraph& graph, size_t from_node_index, uint32_t path_length, size_t max_path_count, std::vector<path_t>& out_paths);
+
+		std::vector<uint32_t> m_ForwardDepths;
+		std::vector<uint32_t> m_BackwardDepths;
+		std::vector<uint8_t> m_ReachesTarget;
+		std::vector<size_t> m_TouchedNodes;
+		std::vector<size_t> m_ForwardFrontier;
+		std::vector<size_t> m_BackwardFrontier;
+		std::vector<size_t> m_NextFrontier;
+		std::vector<size_t> m_Candidates;
+		std::vector<SFrame> m_Stack;
+	};
+
+	template <class TGraph>
+	bool CBidirectionalBfs<TGraph>::FindShortestPaths(const TGraph& graph, size_t from_node_index, size_t to_node_index, size_t max_path_count, std::vector<path_t>& out_paths)
+	{
+		out_paths.clear();
+
+		if (from_node_index >= graph.NodeCount() || to_node_index >= graph.NodeCount() || 0 == max_path_count)
+		{
+			return false;
+		}
+
+		if (from_node_index == to_node_index)
+		{
+			out_paths.push_back({ from_node_index });
+			return true;
+		}
+
+		Reset(graph.NodeCount());
+
+		m_ForwardDepths[from_node_index] = 0;
+		m_BackwardDepths[to_node_index] = 0;
+		Touch(from_node_index);
+		Touch(to_node_index);
+		m_ForwardFrontier.push_back(from_node_index);
+		m_BackwardFrontier.push_back(to_node_index);
+
+		uint32_t path_length = NO_DEPTH;
+		while (NO_DEPTH == path_length && !m_ForwardFrontier.empty() && !m_BackwardFrontier.empty())
+		{
+			if (m_ForwardFrontier.size() <= m_BackwardFrontier.size())
+			{
+				ExpandLayer(graph, m_ForwardFrontier, m_ForwardDepths, m_BackwardDepths, path_length);
+			}
+			else
+			{
+				ExpandLayer(graph, m_BackwardFrontier, m_BackwardDepths, m_ForwardDepths, path_length);
+			}
+		}
+
+		if (NO_DEPTH == path_length)
+		{
+			return false;
+		}
+
+		MarkForwardNodesReachingTarget(graph, path_length);
+		CollectPaths(graph, from_node_index, path_length, max_path_count, out_paths);
+
+		return !out_paths.empty();
+	}
+
+	template <class TGraph>
+	void CBidirectionalBfs<TGraph>::Reset(size_t node_count)
+	{
+		if (m_ForwardDepths.size() != node_count)
+		{
+			m_ForwardDepths.assign(node_count, NO_DEPTH);
+			m_BackwardDepths.assign(node_count, NO_DEPTH);
+			m_ReachesTarget.assign(node_count, 0);
+		}
+		else
+		{
+			// Only reset what the previous search touched
+			for (const auto node_index : m_TouchedNodes)
+			{
+				m_ForwardDepths[node_index] = NO_DEPTH;
+				m_BackwardDepths[node_index] = NO_DEPTH;
+				m_ReachesTarget[node_index] = 0;
+			}
+		}
+		m_TouchedNodes.clear();
+		m_ForwardFrontier.clear();
+		m_BackwardFrontier.clear();
+	}
+
+	template <class TGraph>
+	void CBidirectionalBfs<TGraph>::Touch(size_t node_index)
+	{
+		if (NO_DEPTH == m_ForwardDepths[node_index] || NO_DEPTH == m_BackwardDepths[node_index])
+		{
+			m_TouchedNodes.push_back(node_index);
+		}
+	}
+
+	template <class TGraph>
+	void CBidirectionalBfs<TGraph>::ExpandLayer(const TGraph& graph, std::vector<size_t>& frontier, std::vector<uint32_t>& depths, const std::vector<uint32_t>& other_depths, uint32_t& in_out_path_length)
+	{
+		m_NextFrontier.clear();
+		for (const auto node_index : frontier)
+		{
+			const auto next_depth = depths[node_index] + 1;
+			for (const auto edge : graph.NodeEdges(graph.NodeFromIndex((node_index_t)node_index)))
+			{
+				const size_t target_node_index = graph.EdgeTargetNodeIndex(edge);
+				if (NO_DEPTH != other_depths[target_node_index])
+				{
+					in_out_path_length = std::min(in_out_path_length, next_depth + other_depths[target_node_index]);
+				}
+				if (NO_DEPTH == depths[target_node_index])
+				{
+					Touch(target_node_index);
+					depths[target_node_index] = next_depth;
+					m_NextFrontier.push_back(target_node_index);
+				}
+			}
+		}
+		std::swap(frontier, m_NextFrontier);
+	}
+
+	template <class TGraph>
+	void CBidirectionalBfs<TGraph>::MarkForwardNodesReachingTarget(const TGraph& graph, uint32_t path_length)
+	{
+		// Nodes only reached by the forward search may still be dead ends. Find the ones that lead
+		// on to the target along a shortest path, starting with the deepest ones.
+		m_Candidates.clear();
+		for (const auto node_index : m_TouchedNodes)
+		{
+			if (NO_DEPTH != m_ForwardDepths[node_index] && NO_DEPTH == m_BackwardDepths[node_index] && m_ForwardDepths[node_index] < path_length)
+			{
+				m_Candidates.push_back(node_index);
+			}
+		}
+		std::sort(m_Candidates.begin(), m_Candidates.end(), [&](size_t a, size_t b) { return m_ForwardDepths[a] > m_ForwardDepths[b]; });
+		for (const auto node_index : m_Candidates)
+		{
+			const auto next_position = m_ForwardDepths[node_index] + 1;
+			for (const auto edge : graph.NodeEdges(graph.NodeFromIndex((node_index_t)node_index)))
+			{
+				if (IsOnShortestPath(graph.EdgeTargetNodeIndex(edge), next_position, path_length))
+				{
+					m_ReachesTarget[node_index] = 1;
+					break;
+				}
+			}
+		}
+		m_Candidates.clear();
+	}
+
+	template <class TGraph>
+	inline bool CBidirectionalBfs<TGraph>::IsOnShortestPath(size_t node_index, uint32_t position, uint32_t path_length) const
+	{
+		if (NO_DEPTH != m_BackwardDepths[node_index])
+		{
+			return m_BackwardDepths[node_index] == path_length - position;
+		}
+		return m_ForwardDepths[node_index] == position && m_ReachesTarget[node_index];
+	}
+
+	template <class TGraph>
+	void CBidirectionalBfs<TGraph>::PushFrame(const TGraph& graph, size_t node_index, uint32_t path_length)
+	{
+		SFrame frame;
+		frame.NodeIndex = node_index;
+		frame.CandidatesBegin = frame.NextCandidate = m_Candidates.size();
+		const auto next_position = (uint32_t)m_Stack.size() + 1;
+		if (next_position <= path_length)
+		{
+			for (const auto edge : graph.NodeEdges(graph.NodeFromIndex((node_index_t)node_index)))
+			{
+				const size_t target_node_index = graph.EdgeTargetNodeIndex(edge);
+				if (IsOnShortestPath(target_node_index, next_position, path_length))
+				{
+					m_Candidates.push_back(target_node_index);
+				}
+			}
+		}
+		frame.CandidatesEnd = m_Candidates.size();
+		m_Stack.push_back(frame);
+	}
+
+	template <class TGraph>
+	void CBidirectionalBfs<TGraph>::CollectPaths(const TGraph& graph, size_t from_node_index, uint32_t path_length, size_t max_path_count, std::vector<path_t>& out_paths)
+	{
+		// Depth-first enumeration of all shortest paths. Every candidate is known to lead to
+		// the target, so there is no backtracking out of dead ends.
+		m_Candidates.clear();
+		m_Stack.clear();
+		PushFrame(graph, from_node_index, path_length);
+		while (!m_Stack.empty())
+		{
+			auto& frame = m_Stack.back();
+
+			if (m_Stack.size() - 1 == path_length)
+			{
+				path_t path(m_Stack.size());
+				for (size_t i = 0; i < m_Stack.size(); ++i)
+				{
+					path[i] = m_Stack[i].NodeIndex;
+				}
+				out_paths.push_back(std::move(path));
+				if (out_paths.size() >= max_path_count)
+				{
+					break;
+				}
+			}
+			else if (frame.NextCandidate < frame.CandidatesEnd)
+			{
+				PushFrame(graph, m_Candidates[frame.NextCandidate++], path_length);
+				continue;
+			}
+
+			m_Candidates.resize(frame.CandidatesBegin);
+			m_Stack.pop_back();
+		}
+	}
+}
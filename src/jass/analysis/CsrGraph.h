@@ -0,0 +1,74 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jass
+{
+	// Compressed sparse row view of a graph's adjacency matrix. Row i holds the target node
+	// indices of all edges from node i, stored contiguously for linear sweeps.
+	class CCsrGraph
+	{
+	public:
+		typedef uint32_t index_t;
+
+		inline size_t NodeCount() const { return m_RowOffsets.empty() ? 0 : m_RowOffsets.size() - 1; }
+
+		inline size_t EdgeCount() const { return m_Columns.size(); }
+
+		inline std::span<const index_t> RowOffsets() const { return m_RowOffsets; }
+
+		inline std::span<const index_t> Columns() const { return m_Columns; }
+
+		inline std::span<const index_t> Row(size_t node_index) const;
+
+		template <class TGraph>
+		void CopyView(const TGraph& graph);
+
+	private:
+		std::vector<index_t> m_RowOffsets;
+		std::vector<index_t> m_Columns;
+	};
+
+	inline std::span<const CCsrGraph::index_t> CCsrGraph::Row(size_t node_index) const
+	{
+		return std::span<const index_t>(m_Columns.data() + m_RowOffsets[node_index], m_RowOffsets[node_index + 1] - m_RowOffsets[node_index]);
+	}
+
+	template <class TGraph>
+	void CCsrGraph::CopyView(const TGraph& graph)
+	{
+		const auto node_count = graph.NodeCount();
+		m_RowOffsets.resize(node_count + 1);
+		m_Columns.clear();
+		for (size_t node_index = 0; node_index < node_count; ++node_index)
+		{
+			m_RowOffsets[node_index] = (index_t)m_Columns.size();
+			for (const auto edge : graph.NodeEdges(graph.NodeFromIndex((typename TGraph::node_index_t)node_index)))
+			{
+				m_Columns.push_back((index_t)graph.EdgeTargetNodeIndex(edge));
+			}
+		}
+		m_RowOffsets[node_count] = (index_t)m_Columns.size();
+	}
+}
@@ -31,10 +31,18 @@ namespace jass
 	public:
 		// Source node is included in 'out_node_count'
 		void CalculateDepth(const TGraph& graph, size_t node_index, size_t& out_max_depth, size_t& out_total_depth, size_t& out_node_count)
+		{
+			CalculateDepth(graph, node_index, out_max_depth, out_total_depth, out_node_count, [](auto node, auto depth) {});
+		}
+
+		// Same as above, but also calls 'fn(node, depth)' for each reached node
+		template <class TFunc>
+		void CalculateDepth(const TGraph& graph, size_t node_index, size_t& out_max_depth, size_t& out_total_depth, size_t& out_node_count, TFunc fn)
 		{
 			size_t max_depth = 0, depth_sum = 0, node_count = 0;
 			m_BfsTraversal.Traverse(graph, node_index, [&](auto node, auto depth)
 			{
+				fn(node, depth);
 				max_depth = depth;
 				depth_sum += depth;
 				++node_count;
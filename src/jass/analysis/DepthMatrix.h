@@ -0,0 +1,111 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace jass
+{
+	// All-pairs depth matrix. Depths are packed as one byte per pair. Depths that don't fit in a
+	// byte go in a second matrix of two bytes per pair, which is only allocated once needed.
+	class CDepthMatrix
+	{
+	public:
+		static constexpr uint16_t NO_DEPTH = (uint16_t)-1;
+
+		// Returns false if the packed depths of 'node_count' nodes don't fit in 'byte_budget'
+		inline bool Init(size_t node_count, size_t byte_budget);
+
+		inline size_t NodeCount() const { return m_NodeCount; }
+
+		inline size_t ByteSize() const { return m_Depths.size() * sizeof(uint8_t) + m_OverflowDepths.size() * sizeof(uint16_t); }
+
+		// Returns false if the depth needs the overflow matrix, and it doesn't fit in the budget
+		inline bool SetDepth(size_t from_node_index, size_t to_node_index, size_t depth);
+
+		inline uint16_t Depth(size_t from_node_index, size_t to_node_index) const;
+
+	private:
+		static constexpr uint8_t PACKED_NO_DEPTH = 0xFF;
+		static constexpr uint8_t PACKED_OVERFLOW = 0xFE;
+
+		size_t m_NodeCount = 0;
+		size_t m_ByteBudget = 0;
+		std::vector<uint8_t> m_Depths;
+		std::vector<uint16_t> m_OverflowDepths;
+	};
+
+	inline bool CDepthMatrix::Init(size_t node_count, size_t byte_budget)
+	{
+		m_NodeCount = 0;
+		m_ByteBudget = byte_budget;
+		m_Depths.clear();
+		m_OverflowDepths.clear();
+		if (node_count * node_count * sizeof(uint8_t) > byte_budget)
+		{
+			return false;
+		}
+		m_NodeCount = node_count;
+		m_Depths.assign(node_count * node_count, PACKED_NO_DEPTH);
+		return true;
+	}
+
+	inline bool CDepthMatrix::SetDepth(size_t from_node_index, size_t to_node_index, size_t depth)
+	{
+		const auto index = from_node_index * m_NodeCount + to_node_index;
+		if (depth < PACKED_OVERFLOW)
+		{
+			m_Depths[index] = (uint8_t)depth;
+			return true;
+		}
+		if (m_OverflowDepths.empty())
+		{
+			if (m_Depths.size() * (sizeof(uint8_t) + sizeof(uint16_t)) > m_ByteBudget)
+			{
+				return false;
+			}
+			m_OverflowDepths.resize(m_Depths.size());
+		}
+		m_Depths[index] = PACKED_OVERFLOW;
+		m_OverflowDepths[index] = (uint16_t)std::min(depth, (size_t)NO_DEPTH - 1);
+		return true;
+	}
+
+	inline uint16_t CDepthMatrix::Depth(size_t from_node_index, size_t to_node_index) const
+	{
+		if (from_node_index >= m_NodeCount || to_node_index >= m_NodeCount)
+		{
+			return NO_DEPTH;
+		}
+		const auto index = from_node_index * m_NodeCount + to_node_index;
+		const auto packed_depth = m_Depths[index];
+		if (packed_depth < PACKED_OVERFLOW)
+		{
+			return packed_depth;
+		}
+		if (PACKED_NO_DEPTH == packed_depth)
+		{
+			return NO_DEPTH;
+		}
+		return m_OverflowDepths[index];
+	}
+}
@@ -0,0 +1,321 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <future>
+#include <thread>
+#include <jass/Debug.h>
+#include "ImmutableDirectedGraph.h"
+#include "FlowSimulation.h"
+
+namespace jass
+{
+	static inline uint32_t NextRandom(uint32_t& state)
+	{
+		// xorshift32
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	static inline size_t RandomIndex(uint32_t& state, size_t count)
+	{
+		return (size_t)(((uint64_t)NextRandom(state) * count) >> 32);
+	}
+
+	size_t CFlowSimulation::Run(const CImmutableDirectedGraph& graph, std::span<const size_t> origin_node_indices, std::span<const size_t> destination_node_indices, const SSettings& settings, const std::atomic<bool>& cancelled, const step_callback_t& on_step)
+	{
+		m_Graph.CopyView(graph);
+
+		const auto node_count = m_Graph.NodeCount();
+		const auto edge_count = m_Graph.EdgeCount();
+
+		m_NodeOccupancy.assign(node_count, 0);
+		m_EdgeTraversals.assign(edge_count, 0);
+		m_NodeTraversals.assign(node_count, 0);
+		m_ArrivedAgentCount = 0;
+
+		if (origin_node_indices.empty() || destination_node_indices.empty() || 0 == settings.AgentCount)
+		{
+			return 0;
+		}
+
+		if (!SelectDestinations(destination_node_indices, settings))
+		{
+			return 0;
+		}
+
+		const size_t thread_count = std::max<size_t>(1, std::min<size_t>(settings.ThreadCount ? settings.ThreadCount : std::thread::hardware_concurrency(), settings.AgentCount));
+
+		CalculateDistances(thread_count, cancelled);
+		if (cancelled)
+		{
+			return 0;
+		}
+
+		m_ThreadStates.resize(thread_count);
+		bool any_agent_left = false;
+		for (size_t thread_index = 0; thread_index < thread_count; ++thread_index)
+		{
+			auto& thread_state = m_ThreadStates[thread_index];
+			thread_state.NodeOccupancy.assign(node_count, 0);
+			thread_state.EdgeTraversals.assign(edge_count, 0);
+			thread_state.ArrivedAgentCount = 0;
+			// xorshift state must be non-zero
+			thread_state.RandomState = (settings.Seed + (uint32_t)thread_index) * 2654435761u | 1;
+			const auto agent_begin = settings.AgentCount * thread_index / thread_count;
+			const auto agent_end = settings.AgentCount * (thread_index + 1) / thread_count;
+			SpawnAgents(thread_state, agent_end - agent_begin, origin_node_indices);
+			any_agent_left |= !thread_state.Agents.empty();
+		}
+
+		// Each thread keeps stepping its own agents. After every step, each thread merges the occupancy
+		// counters of its share of the nodes. The last thread to finish merging decides whether to go on,
+		// while the others wait.
+		size_t step = 0;
+		bool stop = !any_agent_left || 0 == settings.MaxStepCount;
+		auto on_merge_done = [&]() noexcept
+		{
+			++step;
+
+			if (on_step)
+			{
+				on_step(step, m_NodeOccupancy);
+			}
+
+			bool agents_left = false;
+			for (const auto& thread_state : m_ThreadStates)
+			{
+				agents_left |= !thread_state.Agents.empty();
+			}
+
+			stop = !agents_left || step >= settings.MaxStepCount || cancelled;
+		};
+		std::barrier step_barrier((std::ptrdiff_t)thread_count);
+		std::barrier merge_barrier((std::ptrdiff_t)thread_count, on_merge_done);
+
+		auto simulate = [&](size_t thread_index)
+		{
+			auto& thread_state = m_ThreadStates[thread_index];
+			const auto node_begin = node_count * thread_index / thread_count;
+			const auto node_end = node_count * (thread_index + 1) / thread_count;
+			while (!stop)
+			{
+				Step(thread_state, settings.DetourProbability);
+				step_barrier.arrive_and_wait();
+
+				for (size_t node_index = node_begin; node_index < node_end; ++node_index)
+				{
+					uint32_t occupancy = 0;
+					for (const auto& other_thread_state : m_ThreadStates)
+					{
+						occupancy += other_thread_state.NodeOccupancy[node_index];
+					}
+					m_NodeOccupancy[node_index] = occupancy;
+				}
+				merge_barrier.arrive_and_wait();
+			}
+		};
+
+		std::vector<std::future<void>> results;
+		for (size_t thread_index = 1; thread_index < thread_count; ++thread_index)
+		{
+			results.push_back(std::async(std::launch::async, simulate, thread_index));
+		}
+		simulate(0);
+		for (auto& result : results)
+		{
+			result.wait();
+		}
+
+		for (const auto& thread_state : m_ThreadStates)
+		{
+			for (size_t edge_index = 0; edge_index < edge_count; ++edge_index)
+			{
+				m_EdgeTraversals[edge_index] += thread_state.EdgeTraversals[edge_index];
+			}
+			m_ArrivedAgentCount += thread_state.ArrivedAgentCount;
+		}
+
+		// Every traversal enters a node. Agents also pass through their origin node.
+		const auto columns = m_Graph.Columns();
+		for (size_t edge_index = 0; edge_index < edge_count; ++edge_index)
+		{
+			m_NodeTraversals[columns[edge_index]] += m_EdgeTraversals[edge_index];
+		}
+		for (const auto& thread_state : m_ThreadStates)
+		{
+			for (const auto origin_node_index : thread_state.SpawnedNodeIndices)
+			{
+				++m_NodeTraversals[origin_node_index];
+			}
+		}
+
+		return step;
+	}
+
+	bool CFlowSimulation::SelectDestinations(std::span<const size_t> destination_node_indices, const SSettings& settings)
+	{
+		const auto field_byte_size = std::max<size_t>(1, m_Graph.NodeCount()) * sizeof(distance_t);
+		const auto max_destination_count = settings.DistanceFieldBudget / field_byte_size;
+		if (0 == max_destination_count)
+		{
+			LOG_WARNING("Flow simulation needs %d KB for a single distance field, which exceeds the budget.", (int)(field_byte_size >> 10));
+			return false;
+		}
+
+		m_DestinationNodeIndices.assign(destination_node_indices.begin(), destination_node_indices.end());
+		if (m_DestinationNodeIndices.size() <= max_destination_count)
+		{
+			return true;
+		}
+
+		LOG_WARNING("Distance fields for %d destinations exceed the flow simulation budget, %d random destinations will be used.", (int)m_DestinationNodeIndices.size(), (int)max_destination_count);
+
+		// Partial Fisher-Yates shuffle
+		uint32_t random_state = settings.Seed * 2654435761u | 1;
+		for (size_t i = 0; i < max_destination_count; ++i)
+		{
+			std::swap(m_DestinationNodeIndices[i], m_DestinationNodeIndices[i + RandomIndex(random_state, m_DestinationNodeIndices.size() - i)]);
+		}
+		m_DestinationNodeIndices.resize(max_destination_count);
+
+		return true;
+	}
+
+	void CFlowSimulation::CalculateDistances(size_t thread_count, const std::atomic<bool>& cancelled)
+	{
+		const auto node_count = m_Graph.NodeCount();
+		const auto destination_count = m_DestinationNodeIndices.size();
+
+		m_DistanceFields.resize(destination_count * node_count);
+
+		// Edges in the plan graph go both ways, so distance from a destination equals distance to it.
+		std::atomic<size_t> next_destination_index = 0;
+		auto calculate_distances = [&]()
+		{
+			std::vector<uint32_t> queue;
+			queue.reserve(node_count);
+			for (auto destination_index = next_destination_index++; destination_index < destination_count && !cancelled; destination_index = next_destination_index++)
+			{
+				auto* distances = m_DistanceFields.data() + destination_index * node_count;
+				std::fill(distances, distances + node_count, NO_DISTANCE);
+				queue.clear();
+				queue.push_back(m_DestinationNodeIndices[destination_index]);
+				distances[queue[0]] = 0;
+				for (size_t queue_index = 0; queue_index < queue.size(); ++queue_index)
+				{
+					const auto node_index = queue[queue_index];
+					const auto next_distance = (distance_t)(distances[node_index] + 1);
+					for (const auto target_node_index : m_Graph.Row(node_index))
+					{
+						if (NO_DISTANCE == distances[target_node_index])
+						{
+							distances[target_node_index] = next_distance;
+							queue.push_back(target_node_index);
+						}
+					}
+				}
+			}
+		};
+
+		std::vector<std::future<void>> results;
+		for (size_t thread_index = 1; thread_index < std::min(thread_count, destination_count); ++thread_index)
+		{
+			results.push_back(std::async(std::launch::async, calculate_distances));
+		}
+		calculate_distances();
+		for (auto& result : results)
+		{
+			result.wait();
+		}
+	}
+
+	void CFlowSimulation::SpawnAgents(SThreadState& thread_state, size_t agent_count, std::span<const size_t> origin_node_indices)
+	{
+		thread_state.Agents.clear();
+		thread_state.SpawnedNodeIndices.clear();
+		for (size_t agent_index = 0; agent_index < agent_count; ++agent_index)
+		{
+			const auto origin_node_index = (uint32_t)origin_node_indices[RandomIndex(thread_state.RandomState, origin_node_indices.size())];
+			const auto destination_index = (uint32_t)RandomIndex(thread_state.RandomState, m_DestinationNodeIndices.size());
+			const auto distance = DistanceField(destination_index)[origin_node_index];
+			if (0 == distance || NO_DISTANCE == distance)
+			{
+				// Already there, or no way to get there
+				continue;
+			}
+			thread_state.Agents.push_back({ origin_node_index, destination_index });
+			thread_state.SpawnedNodeIndices.push_back(origin_node_index);
+		}
+	}
+
+	void CFlowSimulation::Step(SThreadState& thread_state, float detour_probability) const
+	{
+		const auto row_offsets = m_Graph.RowOffsets();
+		const auto columns = m_Graph.Columns();
+		const auto detour_threshold = (uint32_t)(std::clamp(detour_probability, 0.0f, 1.0f) * (float)0xFFFFFFFFu);
+
+		std::fill(thread_state.NodeOccupancy.begin(), thread_state.NodeOccupancy.end(), 0);
+
+		auto& agents = thread_state.Agents;
+		for (size_t agent_index = 0; agent_index < agents.size(); )
+		{
+			auto& agent = agents[agent_index];
+			const auto distances = DistanceField(agent.DestinationIndex);
+			const auto distance = distances[agent.NodeIndex];
+			const auto detour = detour_threshold && NextRandom(thread_state.RandomState) < detour_threshold;
+
+			// Pick uniformly among candidate edges, without knowing their number in advance
+			size_t chosen_edge_index = (size_t)-1;
+			uint32_t candidate_count = 0;
+			for (auto edge_index = row_offsets[agent.NodeIndex]; edge_index < row_offsets[agent.NodeIndex + 1]; ++edge_index)
+			{
+				const auto target_distance = distances[columns[edge_index]];
+				if (detour ? (NO_DISTANCE == target_distance) : (target_distance + 1 != distance))
+				{
+					continue;
+				}
+				++candidate_count;
+				if (0 == RandomIndex(thread_state.RandomState, candidate_count))
+				{
+					chosen_edge_index = edge_index;
+				}
+			}
+			ASSERT(candidate_count > 0);
+
+			++thread_state.EdgeTraversals[chosen_edge_index];
+			agent.NodeIndex = columns[chosen_edge_index];
+			++thread_state.NodeOccupancy[agent.NodeIndex];
+
+			if (0 == distances[agent.NodeIndex])
+			{
+				++thread_state.ArrivedAgentCount;
+				agent = agents.back();
+				agents.pop_back();
+				continue;
+			}
+
+			++agent_index;
+		}
+	}
+}
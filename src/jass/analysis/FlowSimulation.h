@@ -0,0 +1,115 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include "CsrGraph.h"
+
+namespace jass
+{
+	class CImmutableDirectedGraph;
+
+	// Agents walking from random origin nodes to random destination nodes, one edge per step.
+	// Agents are partitioned over worker threads, each with its own counters, which are
+	// merged after each step (node occupancy) and at the end of the simulation (edge traversals).
+	// Routes follow a distance field per destination. If those don't fit in the memory budget,
+	// agents only head for a random sample of the destinations.
+	class CFlowSimulation
+	{
+	public:
+		struct SSettings
+		{
+			size_t AgentCount = 1000;
+			size_t ThreadCount = 0;  // 0 = one per hardware thread
+			size_t MaxStepCount = 1000;
+			float DetourProbability = 0;  // Probability of taking a random edge instead of following a shortest path
+			uint32_t Seed = 0;
+			size_t DistanceFieldBudget = 256 * 1024 * 1024;  // Max bytes for distance fields, which take 4 bytes per node and destination
+		};
+
+		// Called after each step with the number of agents at each node
+		typedef std::function<void(size_t step, std::span<const uint32_t> node_occupancy)> step_callback_t;
+
+		// Returns number of steps simulated. Stops as soon as possible once 'cancelled' is set.
+		size_t Run(const CImmutableDirectedGraph& graph, std::span<const size_t> origin_node_indices, std::span<const size_t> destination_node_indices, const SSettings& settings, const std::atomic<bool>& cancelled, const step_callback_t& on_step);
+
+		// Graph the simulation was last run on. Edge indices refer to positions in its column array.
+		inline const CCsrGraph& Graph() const { return m_Graph; }
+
+		// Number of agents that traversed each edge
+		inline std::span<const uint32_t> EdgeTraversals() const { return m_EdgeTraversals; }
+
+		// Number of agents that passed through each node, including origins and destinations
+		inline std::span<const uint32_t> NodeTraversals() const { return m_NodeTraversals; }
+
+		// Number of agents that reached their destination
+		inline size_t ArrivedAgentCount() const { return m_ArrivedAgentCount; }
+
+	private:
+		typedef uint32_t distance_t;
+		static constexpr distance_t NO_DISTANCE = 0xFFFFFFFF;
+
+		struct SAgent
+		{
+			uint32_t NodeIndex;
+			uint32_t DestinationIndex;
+		};
+
+		struct SThreadState
+		{
+			std::vector<SAgent> Agents;
+			std::vector<uint32_t> SpawnedNodeIndices;
+			std::vector<uint32_t> NodeOccupancy;
+			std::vector<uint32_t> EdgeTraversals;
+			size_t ArrivedAgentCount = 0;
+			uint32_t RandomState = 0;
+		};
+
+		// Returns false if not even a single distance field fits in the budget
+		bool SelectDestinations(std::span<const size_t> destination_node_indices, const SSettings& settings);
+
+		void CalculateDistances(size_t thread_count, const std::atomic<bool>& cancelled);
+
+		void SpawnAgents(SThreadState& thread_state, size_t agent_count, std::span<const size_t> origin_node_indices);
+
+		void Step(SThreadState& thread_state, float detour_probability) const;
+
+		inline std::span<const distance_t> DistanceField(size_t destination_index) const;
+
+		CCsrGraph m_Graph;
+		std::vector<uint32_t> m_DestinationNodeIndices;
+		std::vector<distance_t> m_DistanceFields;
+		std::vector<SThreadState> m_ThreadStates;
+		std::vector<uint32_t> m_NodeOccupancy;
+		std::vector<uint32_t> m_EdgeTraversals;
+		std::vector<uint32_t> m_NodeTraversals;
+		size_t m_ArrivedAgentCount = 0;
+	};
+
+	inline std::span<const CFlowSimulation::distance_t> CFlowSimulation::DistanceField(size_t destination_index) const
+	{
+		const auto node_count = m_Graph.NodeCount();
+		return std::span<const distance_t>(m_DistanceFields.data() + destination_index * node_count, node_count);
+	}
+}
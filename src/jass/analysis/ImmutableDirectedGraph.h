@@ -20,6 +20,8 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <span>
 #include <vector>
 
@@ -76,6 +78,14 @@ namespace jass
 		typedef const void* node_handle_t;
 		typedef const void* edge_handle_t;
 
+		CImmutableDirectedGraph() {}
+		inline CImmutableDirectedGraph(const CImmutableDirectedGraph& rhs);
+		inline CImmutableDirectedGraph(CImmutableDirectedGraph&& rhs) noexcept;
+		inline ~CImmutableDirectedGraph();
+
+		inline CImmutableDirectedGraph& operator=(const CImmutableDirectedGraph& rhs);
+		inline CImmutableDirectedGraph& operator=(CImmutableDirectedGraph&& rhs) noexcept;
+
 		inline size_t NodeCount() const;
 
 		inline node_handle_t NodeFromIndex(node_index_t index) const;
@@ -127,6 +137,50 @@ namespace jass
 		std::vector<node_address_t> m_NodeAddresses;
 	};
 
+	inline CImmutableDirectedGraph::CImmutableDirectedGraph(const CImmutableDirectedGraph& rhs)
+	{
+		*this = rhs;
+	}
+
+	inline CImmutableDirectedGraph::CImmutableDirectedGraph(CImmutableDirectedGraph&& rhs) noexcept
+	{
+		*this = std::move(rhs);
+	}
+
+	inline CImmutableDirectedGraph::~CImmutableDirectedGraph()
+	{
+		free(m_NodeBuffer);
+	}
+
+	inline CImmutableDirectedGraph& CImmutableDirectedGraph::operator=(const CImmutableDirectedGraph& rhs)
+	{
+		if (this == &rhs)
+		{
+			return *this;
+		}
+		Clear();
+		const auto byte_size = (size_t)((const char*)rhs.m_NodeBufferEnd - (const char*)rhs.m_NodeBuffer);
+		ReserveSpace(byte_size);
+		if (byte_size)
+		{
+			memcpy(m_NodeBuffer, rhs.m_NodeBuffer, byte_size);
+		}
+		m_NodeBufferEnd = (const char*)m_NodeBuffer + byte_size;
+		m_NodeCount = rhs.m_NodeCount;
+		m_NodeAddresses = rhs.m_NodeAddresses;
+		return *this;
+	}
+
+	inline CImmutableDirectedGraph& CImmutableDirectedGraph::operator=(CImmutableDirectedGraph&& rhs) noexcept
+	{
+		std::swap(m_NodeCount, rhs.m_NodeCount);
+		std::swap(m_NodeBuffer, rhs.m_NodeBuffer);
+		std::swap(m_NodeBufferEnd, rhs.m_NodeBufferEnd);
+		std::swap(m_NodeBufferSize, rhs.m_NodeBufferSize);
+		std::swap(m_NodeAddresses, rhs.m_NodeAddresses);
+		return *this;
+	}
+
 	inline size_t CImmutableDirectedGraph::NodeByteSize(const SNode& node)
 	{
 		return NodeByteSizeFromEdgeCount(node.EdgeCount);
@@ -0,0 +1,91 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include "RandomWalk.h"
+
+namespace jass
+{
+	size_t CalculateRandomWalkStationaryDistribution(const CCsrGraph& graph, float damping, float tolerance, size_t max_iterations, std::vector<float>& out_distribution)
+	{
+		const auto node_count = graph.NodeCount();
+		out_distribution.assign(node_count, node_count ? 1.0f / node_count : 0.0f);
+		if (0 == node_count)
+		{
+			return 0;
+		}
+
+		const auto row_offsets = graph.RowOffsets();
+		const auto columns = graph.Columns();
+
+		std::vector<float> inv_degree(node_count);
+		for (size_t node_index = 0; node_index < node_count; ++node_index)
+		{
+			const auto degree = row_offsets[node_index + 1] - row_offsets[node_index];
+			inv_degree[node_index] = degree ? 1.0f / degree : 0.0f;
+		}
+
+		std::vector<float> contribution(node_count);
+		std::vector<float> next(node_count);
+		auto* x = out_distribution.data();
+		auto* c = contribution.data();
+		const auto* w = inv_degree.data();
+
+		size_t iteration = 0;
+		while (iteration < max_iterations)
+		{
+			++iteration;
+
+			// Share of each node sent along each of its edges. Nodes without edges spread their
+			// share over all nodes, same as the random jump.
+			double dangling_sum = 0;
+			for (size_t i = 0; i < node_count; ++i)
+			{
+				c[i] = x[i] * w[i];
+				dangling_sum += (0 == w[i]) ? x[i] : 0.0f;
+			}
+
+			// Sparse matrix-vector product, pulling contributions along incoming edges. Edges are
+			// bidirectional, so a node's row also lists the nodes it receives from.
+			const float base = (float)((1.0 - damping + damping * dangling_sum) / node_count);
+			double delta = 0;
+			for (size_t i = 0; i < node_count; ++i)
+			{
+				float sum = 0;
+				const auto row_end = row_offsets[i + 1];
+				for (auto e = row_offsets[i]; e < row_end; ++e)
+				{
+					sum += c[columns[e]];
+				}
+				next[i] = base + damping * sum;
+				delta += std::abs(next[i] - x[i]);
+			}
+
+			std::swap(out_distribution, next);
+			x = out_distribution.data();
+
+			if (delta < tolerance)
+			{
+				break;
+			}
+		}
+
+		return iteration;
+	}
+}
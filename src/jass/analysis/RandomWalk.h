@@ -0,0 +1,32 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include "CsrGraph.h"
+
+namespace jass
+{
+	// Stationary distribution of a random walk that at each step follows a random edge with
+	// probability 'damping', and otherwise jumps to a random node (PageRank). Computed by power
+	// iteration until the L1 change between sweeps drops below 'tolerance'. Returns the number
+	// of sweeps made, which equals 'max_iterations' if it may not have converged.
+	size_t CalculateRandomWalkStationaryDistribution(const CCsrGraph& graph, float damping, float tolerance, size_t max_iterations, std::vector<float>& out_distribution);
+}
@@ -34,36 +34,37 @@ namespace jass
 		const IGraphView& gview)
 	{
 		const auto node_count = gview.NodeCount();
-		std::vector<QPointF> node_positions(node_count);
-		std::vector<uint32_t> node_categories(node_count);
-		gview.TryGetNodeAttributes(GRAPH_NODE_ATTTRIBUTE_POSITION, to_span(node_positions));
-		gview.TryGetNodeAttributes(GRAPH_NODE_ATTTRIBUTE_CATEGORY, to_span(node_categories));
 
-		WriteInsertGraphNodesOp(ctx.m_Data, [&](auto&& add)
+		std::vector<QPointF> temp_positions;
+		std::span<const QPointF> node_positions;
+		std::vector<uint32_t> temp_categories;
+		std::span<const uint32_t> node_categories;
+		{
+			size_t index;
+			SNodeAttributeDesc desc;
+			if (gview.FindNodeAttributes(GRAPH_NODE_ATTTRIBUTE_POSITION, index, desc) && QVariant::PointF == desc.Type)
 			{
-				for (CGraphModel::node_index_t node_index = 0; node_index < node_count; ++node_index)
-				{
-					add(
-						data_model.NodeCount() + node_index,
-						node_categories.empty() ? CGraphModel::NO_CATEGORY : node_categories[node_index],
-						node_positions.empty() ? 0 : node_positions[node_index].x(),
-						node_positions.empty() ? 0 : node_positions[node_index].y());
-				}
-			});
-
-		WriteInsertGraphEdgesOp(ctx.m_Data, [&](auto&& add)
+				node_positions = gview.NodeAttributeData(index, temp_positions);
+			}
+			else
+			{
+				temp_positions.resize(node_count, QPointF(0, 0));
+				node_positions = temp_positions;
+			}
+			if (gview.FindNodeAttributes(GRAPH_NODE_ATTTRIBUTE_CATEGORY, index, desc) && QVariant::UInt == desc.Type)
+			{
+				node_categories = gview.NodeAttributeData(index, temp_categories);
+			}
+			else
 			{
-				auto edge_index = data_model.EdgeCount();
-				std::vector<IGraphView::edge_t> edges(gview.EdgeCount());
-				gview.GetEdges(edges);
-				for (const auto& edge : edges)
-				{
-					SEdgeDesc desc;
-					desc.Index = edge_index++;
-					desc.Node0 = edge.first + data_model.NodeCount();
-					desc.Node1 = edge.second + data_model.NodeCount();
-					add(desc);
-				}
-			});
+				temp_categories.resize(node_count, CGraphModel::NO_CATEGORY);
+				node_categories = temp_categories;
+			}
+		}
+
+		std::vector<IGraphView::edge_t> edges(gview.EdgeCount());
+		gview.GetEdges(edges);
+
+		WriteAppendGraphOp(ctx.m_Data, node_positions, node_categories, edges);
 	}
-}
\ No newline at end of file
+}
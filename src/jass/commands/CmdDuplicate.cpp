@@ -31,20 +31,20 @@ namespace jass
 	{
 		const QPointF duplicate_offset(10, 10);
 
-		std::unordered_map<CGraphModel::node_index_t, CGraphModel::node_index_t> index_map;
-		index_map.reserve(node_mask.count_set_bits());
+		// Index of every duplicated node among the new nodes
+		std::vector<CGraphModel::node_index_t> new_node_indices(data_model.NodeCount(), CGraphModel::NO_NODE);
 
-		WriteInsertGraphNodesOp(ctx.m_Data, [&](auto&& add)
+		const auto new_node_count = node_mask.count_set_bits();
+		std::vector<CGraphModel::position_t> node_positions;
+		std::vector<CGraphModel::category_index_t> node_categories;
+		node_positions.reserve(new_node_count);
+		node_categories.reserve(new_node_count);
+		node_mask.for_each_set_bit([&](auto index)
 			{
-				auto new_node_index = (CGraphModel::node_index_t)data_model.NodeCount();
-				node_mask.for_each_set_bit([&](auto index)
-					{
-						const auto node_index = (CGraphModel::node_index_t)index;
-						const auto pos = duplicate_offset + data_model.NodePosition(node_index);
-						add(new_node_index, data_model.NodeCategory(node_index), pos.x() , pos.y());
-						index_map.insert(std::make_pair(node_index, new_node_index));
-						++new_node_index;
-					});
+				const auto node_index = (CGraphModel::node_index_t)index;
+				new_node_indices[node_index] = (CGraphModel::node_index_t)node_positions.size();
+				node_positions.push_back(duplicate_offset + data_model.NodePosition(node_index));
+				node_categories.push_back(data_model.NodeCategory(node_index));
 			});
 
 		std::vector<CGraphModel::node_pair_t> new_edges;
@@ -53,33 +53,13 @@ namespace jass
 				const auto node_index = (CGraphModel::node_index_t)index;
 				for (auto neighbour_index : data_model.NodeNeighbours(node_index))
 				{
-					if (neighbour_index <= node_index)
-					{
-						continue;
-					}
-					auto it = index_map.find(neighbour_index);
-					if (index_map.end() == it)
+					if (neighbour_index > node_index && CGraphModel::NO_NODE != new_node_indices[neighbour_index])
 					{
-						continue;
+						new_edges.push_back({ new_node_indices[node_index], new_node_indices[neighbour_index] });
 					}
-					new_edges.push_back({ index_map[node_index], index_map[neighbour_index] });
 				}
 			});
 
-		if (!new_edges.empty())
-		{
-			WriteInsertGraphEdgesOp(ctx.m_Data, [&](auto&& add)
-				{
-					for (CGraphModel::edge_index_t edge_index = 0; edge_index < new_edges.size(); ++edge_index)
-					{
-						const auto& node_pair = new_edges[edge_index];
-						SEdgeDesc edge_desc;
-						edge_desc.Index = edge_index + data_model.EdgeCount();
-						edge_desc.Node0 = std::min(node_pair.first, node_pair.second);
-						edge_desc.Node1 = std::max(node_pair.first, node_pair.second);
-						add(edge_desc);
-					}
-				});
-		}
+		WriteAppendGraphOp(ctx.m_Data, node_positions, node_categories, new_edges);
 	}
-}
\ No newline at end of file
+}
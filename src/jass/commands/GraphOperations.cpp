@@ -17,6 +17,7 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <numeric>
 #include <jass/Debug.h>
 #include <jass/GraphEditor/JassEditor.hpp>
 
@@ -199,6 +200,77 @@ namespace jass
 		jass_editor->SelectionModel().EndModify();
 	}
 
+	void AppendGraphProcessor(qapp::IEditor& editor, qapp::EOperation op, std::istream& in, std::streamsize size)
+	{
+		auto* jass_editor = dynamic_cast<CJassEditor*>(&editor);
+		ASSERT(jass_editor);
+		auto& data_model = jass_editor->DataModel();
+
+		const auto node_count = qapp::tread<uint32_t>(in);
+		const auto edge_count = qapp::tread<uint32_t>(in);
+
+		jass_editor->SelectionModel().BeginModify();
+
+		if (qapp::EOperation_Do == op)
+		{
+			std::vector<CGraphModel::position_t> node_positions(node_count);
+			std::vector<CGraphModel::category_index_t> node_categories(node_count);
+			std::vector<CGraphModel::node_pair_t> edges(edge_count);
+			in.read((char*)node_positions.data(), node_positions.size() * sizeof(CGraphModel::position_t));
+			in.read((char*)node_categories.data(), node_categories.size() * sizeof(CGraphModel::category_index_t));
+			in.read((char*)edges.data(), edges.size() * sizeof(CGraphModel::node_pair_t));
+
+			data_model.BeginTransaction();
+			const auto first_node_index = data_model.AppendNodes(node_positions, node_categories);
+			for (auto& edge : edges)
+			{
+				edge.first += first_node_index;
+				edge.second += first_node_index;
+			}
+			data_model.AppendEdges(edges);
+			data_model.Commit();
+
+			// Select added nodes
+			jass_editor->SelectionModel().DeselectAll();
+			for (auto node_index = first_node_index; node_index < data_model.NodeCount(); ++node_index)
+			{
+				jass_editor->SelectionModel().SelectNode(node_index);
+			}
+		}
+		else
+		{
+			// Nodes and edges are still last, as later operations have been undone. Removing the edges
+			// first saves RemoveNodes from looking them up through the neighbour tables.
+			std::vector<CGraphModel::edge_index_t> edge_indices(edge_count);
+			std::iota(edge_indices.begin(), edge_indices.end(), data_model.EdgeCount() - edge_count);
+			std::vector<CGraphModel::node_index_t> node_indices(node_count);
+			std::iota(node_indices.begin(), node_indices.end(), data_model.NodeCount() - node_count);
+			data_model.BeginTransaction();
+			data_model.RemoveEdges(edge_indices);
+			data_model.RemoveNodes(node_indices);
+			data_model.Commit();
+		}
+
+		jass_editor->SelectionModel().EndModify();
+	}
+
+	void WriteAppendGraphOp(
+		std::ostream& out,
+		std::span<const CGraphModel::position_t> node_positions,
+		std::span<const CGraphModel::category_index_t> node_categories,
+		std::span<const CGraphModel::node_pair_t> edges)
+	{
+		ASSERT(node_positions.size() == node_categories.size());
+		WriteOperation(out, AppendGraphProcessor, [&](std::ostream& out)
+			{
+				qapp::twrite(out, (uint32_t)node_positions.size());
+				qapp::twrite(out, (uint32_t)edges.size());
+				out.write((const char*)node_positions.data(), node_positions.size_bytes());
+				out.write((const char*)node_categories.data(), node_categories.size_bytes());
+				out.write((const char*)edges.data(), edges.size_bytes());
+			});
+	}
+
 	void DeleteGraphEdgesProcessor(qapp::IEditor& editor, qapp::EOperation op, std::istream& in, std::streamsize size)
 	{
 		InsertGraphEdgesProcessor(editor, qapp::EOperation_Do == op ? qapp::EOperation_Undo : qapp::EOperation_Do, in, size);
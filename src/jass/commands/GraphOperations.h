@@ -76,6 +76,20 @@ namespace jass
 	}
 
 
+	// Append graph
+	//
+	// Adds nodes and the edges between them after all existing nodes and edges. Edges refer to
+	// new nodes by their index among the new nodes. Data is written and applied in bulk.
+
+	void AppendGraphProcessor(qapp::IEditor& editor, qapp::EOperation op, std::istream& in, std::streamsize size);
+
+	void WriteAppendGraphOp(
+		std::ostream& out,
+		std::span<const CGraphModel::position_t> node_positions,
+		std::span<const CGraphModel::category_index_t> node_categories,
+		std::span<const CGraphModel::node_pair_t> edges);
+
+
 	// Delete graph edges
 
 	void DeleteGraphEdgesProcessor(qapp::IEditor& editor, qapp::EOperation op, std::istream& in, std::streamsize size);
@@ -72,9 +72,16 @@ namespace jass
 			ToBinary(desc.Name, out);
 			qapp::twrite(out, (uint8_t)desc.Type);
 			const size_t size = qapp::QVariantTypeSize(desc.Type) * node_count;
-			QByteArray data((int)size, 0);
-			gview.GetNodeAttributeData(node_attribute_index, data.data(), data.size());
-			out.write((char*)data.data(), data.size());
+			auto data = gview.NodeAttributeDataView(node_attribute_index);
+			QByteArray temp;
+			if (data.empty() && size > 0)
+			{
+				temp = QByteArray((int)size, 0);
+				gview.GetNodeAttributeData(node_attribute_index, temp.data(), temp.size());
+				data = std::span<const std::byte>((const std::byte*)temp.data(), temp.size());
+			}
+			ASSERT(data.size() == size);
+			out.write((const char*)data.data(), data.size());
 		}
 
 		const size_t edge_count = gview.EdgeCount();
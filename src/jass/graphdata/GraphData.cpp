@@ -57,6 +57,12 @@ namespace jass
 		memcpy(buffer, data.data(), size);
 	}
 
+	std::span<const std::byte> CGraphData::NodeAttributeDataView(size_t index) const
+	{
+		const auto& data = m_NodeAttributes[index].Data;
+		return std::span<const std::byte>((const std::byte*)data.data(), data.size());
+	}
+
 	size_t CGraphData::EdgeCount() const
 	{
 		return m_Edges.size();
@@ -42,6 +42,7 @@ namespace jass
 		size_t NodeAttributeCount() const override;
 		SNodeAttributeDesc NodeAttributeDesc(size_t index) const override;
 		void   GetNodeAttributeData(size_t index, void* buffer, size_t size) const override;
+		std::span<const std::byte> NodeAttributeDataView(size_t index) const override;
 		size_t EdgeCount() const override;
 		void   GetEdges(std::span<edge_t> out_edges) const override;
 
@@ -65,23 +65,13 @@ namespace jass
 		{
 			const auto* pts = (const QPointF*)data;
 			ASSERT(m_DataModel->NodeCount() * sizeof(*pts) == size);
-			m_DataModel->BeginModifyNodes();
-			for (CGraphModel::node_index_t i = 0; i < m_DataModel->NodeCount(); ++i)
-			{
-				m_DataModel->SetNodePosition(i, pts[i]);
-			}
-			m_DataModel->EndModifyNodes();
+			m_DataModel->SetNodePositions(std::span<const QPointF>(pts, m_DataModel->NodeCount()));
 		}
 		else if (desc.Name == GRAPH_NODE_ATTTRIBUTE_CATEGORY)
 		{
 			const auto* categories = (const uint32_t*)data;
 			ASSERT(m_DataModel->NodeCount() * sizeof(*categories) == size);
-			m_DataModel->BeginModifyNodes();
-			for (CGraphModel::node_index_t i = 0; i < m_DataModel->NodeCount(); ++i)
-			{
-				m_DataModel->SetNodeCategory(i, categories[i]);
-			}
-			m_DataModel->EndModifyNodes();
+			m_DataModel->SetNodeCategories(std::span<const uint32_t>(categories, m_DataModel->NodeCount()));
 		}
 	}
 
@@ -67,32 +67,21 @@ namespace jass
 
 	void CGraphModelGraphView::GetNodeAttributeData(size_t index, void* buffer, size_t size) const
 	{
-		if (index < std::size(s_NodeAttributeDescs))
-		{
-			if (0 == index)
-			{
-				ASSERT(NodeCount() * sizeof(QPointF) == size);
-				auto* to = (QPointF*)buffer;
-				for (size_t node_index = 0; node_index < m_DataModel->NodeCount(); ++node_index)
-				{
-					*to++ = m_DataModel->NodePosition((CGraphModel::node_index_t)node_index);
-				}
-			}
-			else if (1 == index)
-			{
-				ASSERT(NodeCount() * sizeof(uint32_t) == size);
-				auto* to = (uint32_t*)buffer;
-				for (size_t node_index = 0; node_index < m_DataModel->NodeCount(); ++node_index)
-				{
-					*to++ = m_DataModel->NodeCategory((CGraphModel::node_index_t)node_index);
-				}
-			}
-		}
-		else
+		const auto data = NodeAttributeDataView(index);
+		ASSERT(data.size() == size);
+		std::copy(data.begin(), data.end(), (std::byte*)buffer);
+	}
+
+	std::span<const std::byte> CGraphModelGraphView::NodeAttributeDataView(size_t index) const
+	{
+		switch (index)
 		{
-			auto& node_attribute = m_DataModel->NodeAttribute(index - std::size(s_NodeAttributeDescs));
-			node_attribute.Copy(buffer, size);
+		case 0:
+			return std::as_bytes(m_DataModel->NodePositions());
+		case 1:
+			return std::as_bytes(m_DataModel->NodeCategories());
 		}
+		return m_DataModel->NodeAttribute(index - std::size(s_NodeAttributeDescs)).Data();
 	}
 
 	size_t CGraphModelGraphView::EdgeCount() const
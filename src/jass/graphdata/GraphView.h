@@ -19,7 +19,9 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <cstddef>
 #include <span>
+#include <vector>
 #include <qapplib/utils/QVariantType.h>
 #include "GraphDataCommon.h"
 
@@ -36,12 +38,16 @@ namespace jass
 		virtual size_t NodeAttributeCount() const = 0;
 		virtual SNodeAttributeDesc NodeAttributeDesc(size_t index) const = 0;
 		virtual void   GetNodeAttributeData(size_t index, void* buffer, size_t size) const = 0;
+		// Returns an empty span if the node attribute is not stored contiguously
+		virtual std::span<const std::byte> NodeAttributeDataView(size_t index) const { return {}; }
 		virtual size_t EdgeCount() const = 0;
 		virtual void   GetEdges(std::span<edge_t> out_edges) const = 0;
 	
 		// Helpers
 		inline bool FindNodeAttributes(const QString& name, size_t& out_index, SNodeAttributeDesc& out_desc) const;
 		template <typename T> inline void GetNodeAttributeData(size_t index, std::span<T> out_span) const;
+		// Copies into 'temp' only if there is no view of the data
+		template <typename T> inline std::span<const T> NodeAttributeData(size_t index, std::vector<T>& temp) const;
 		
 		template <typename T>
 		inline bool TryGetNodeAttributes(const QString& name, std::span<T> out_data) const;
@@ -67,6 +73,19 @@ namespace jass
 		return GetNodeAttributeData(index, out_span.data(), out_span.size() * sizeof(T));
 	}
 
+	template <typename T> inline std::span<const T> IGraphView::NodeAttributeData(size_t index, std::vector<T>& temp) const
+	{
+		const auto view = NodeAttributeDataView(index);
+		if (!view.empty())
+		{
+			ASSERT(view.size() == NodeCount() * sizeof(T));
+			return std::span<const T>((const T*)view.data(), NodeCount());
+		}
+		temp.resize(NodeCount());
+		GetNodeAttributeData(index, temp.data(), temp.size() * sizeof(T));
+		return temp;
+	}
+
 	template <typename T>
 	inline bool IGraphView::TryGetNodeAttributes(const QString& name, std::span<T> out_data) const
 	{
@@ -35,8 +35,8 @@ namespace jass
 		{
 		case QVariant::UInt:
 			{
-				std::vector<uint32_t> data(graph_view.NodeCount());
-				graph_view.GetNodeAttributeData(node_attribute_index, to_span(data));
+				std::vector<uint32_t> temp;
+				const auto data = graph_view.NodeAttributeData(node_attribute_index, temp);
 				for (auto value : data)
 				{
 					arr.append((int)value);
@@ -45,8 +45,8 @@ namespace jass
 			break;
 		case (QVariant::Type)qapp::QVariantEx::Float:
 			{
-				std::vector<float> data(graph_view.NodeCount());
-				graph_view.GetNodeAttributeData(node_attribute_index, to_span(data));
+				std::vector<float> temp;
+				const auto data = graph_view.NodeAttributeData(node_attribute_index, temp);
 				for (auto value : data)
 				{
 					arr.append(value);
@@ -55,8 +55,8 @@ namespace jass
 			break;
 		case QVariant::PointF:
 			{
-				std::vector<QPointF> data(graph_view.NodeCount());
-				graph_view.GetNodeAttributeData(node_attribute_index, to_span(data));
+				std::vector<QPointF> temp;
+				const auto data = graph_view.NodeAttributeData(node_attribute_index, temp);
 				for (const auto& value : data)
 				{
 					arr.append(std::round(value.x() * 10) * .1);
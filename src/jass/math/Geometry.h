@@ -20,6 +20,8 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include <algorithm>
+#include <tuple>
+#include <vector>
 #include <QtCore/qline.h>
 #include <QtCore/qpoint.h>
 #include <QtCore/qrect.h>
@@ -49,6 +51,38 @@ namespace jass
 			std::abs(line.p2().y() - line.p1().y()));
 	}
 
+	// Removes duplicate lines, and moves lines that start and end on the same pixel to
+	// 'out_points'. For drawing dense line sets where many lines collapse at low zoom.
+	inline void MergeSubPixelLines(std::vector<QLine>& lines, std::vector<QPoint>& out_points)
+	{
+		auto line_less = [](const QLine& a, const QLine& b)
+			{
+				return std::make_tuple(a.x1(), a.y1(), a.x2(), a.y2()) < std::make_tuple(b.x1(), b.y1(), b.x2(), b.y2());
+			};
+		auto point_less = [](const QPoint& a, const QPoint& b)
+			{
+				return std::make_tuple(a.y(), a.x()) < std::make_tuple(b.y(), b.x());
+			};
+
+		for (auto& line : lines)
+		{
+			// Direction doesn't matter, so make equal lines compare equal
+			if (line_less(QLine(line.p2(), line.p1()), line))
+			{
+				line = QLine(line.p2(), line.p1());
+			}
+			if (line.p1() == line.p2())
+			{
+				out_points.push_back(line.p1());
+			}
+		}
+		lines.erase(std::remove_if(lines.begin(), lines.end(), [](const QLine& line) { return line.p1() == line.p2(); }), lines.end());
+		std::sort(lines.begin(), lines.end(), line_less);
+		lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+		std::sort(out_points.begin(), out_points.end(), point_less);
+		out_points.erase(std::unique(out_points.begin(), out_points.end()), out_points.end());
+	}
+
 	inline bool Intersects(const QRectF& rc, const QLineF& line)
 	{
 		// Test AABB intersection
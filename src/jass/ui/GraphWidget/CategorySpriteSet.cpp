@@ -20,17 +20,15 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <QtGui/qpainter.h>
 #include <jass/ui/ImageFx.h>
 #include <jass/Settings.hpp>
-#include "NodeSprite.h"
 #include "CategorySpriteSet.hpp"
+#include "NodeSpriteCache.h"
 
 namespace jass
 {
-	static const QRgb COLOR_SELECTED = qRgb(0x0a, 0x84, 0xff);
-	static const QRgb COLOR_HILIGHT = Blend(COLOR_SELECTED, 0xFFFFFFFF, 48);
-
-	CCategorySpriteSet::CCategorySpriteSet(const CCategorySet& categories, const CSettings& settings)
+	CCategorySpriteSet::CCategorySpriteSet(const CCategorySet& categories, const CSettings& settings, CNodeSpriteCache& sprite_cache)
 		: m_Categories(categories)
 		, m_Settings(settings)
+		, m_SpriteCache(sprite_cache)
 	{
 		connect(&categories, &CCategorySet::rowsInserted, this, &CCategorySpriteSet::OnCategoriesInserted);
 		connect(&categories, &CCategorySet::rowsRemoved,  this, &CCategorySpriteSet::OnCategoriesRemoved);
@@ -45,10 +43,7 @@ namespace jass
 	{
 		const auto inserted_count = last - first + 1;
 		InsertSprites(first * SPRITE_COUNT_PER_CATEGORY, inserted_count * SPRITE_COUNT_PER_CATEGORY);
-		for (int category_index = first; category_index <= last; ++category_index)
-		{
-			UpdateSpritesForCategory((size_t)category_index);
-		}
+		UpdateSpritesForCategories((size_t)first, (size_t)inserted_count);
 	}
 
 	void CCategorySpriteSet::OnCategoriesRemoved(const QModelIndex& parent, int first, int last)
@@ -64,10 +59,7 @@ namespace jass
 
 	void CCategorySpriteSet::OnCategoriesChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& /*roles*/)
 	{
-		for (auto category_index = (size_t)topLeft.row(); category_index <= (size_t)bottomRight.row(); ++category_index)
-		{
-			UpdateSpritesForCategory(category_index);
-		}
+		UpdateSpritesForCategories((size_t)topLeft.row(), (size_t)(bottomRight.row() - topLeft.row() + 1));
 		emit Changed();
 	}
 
@@ -80,9 +72,9 @@ namespace jass
 		}
 	}
 
-	float CCategorySpriteSet::SpriteScale() const
+	int CCategorySpriteSet::UiScale() const
 	{
-		return .01f * m_Settings.value(CSettings::UI_SCALE, 100).toInt();
+		return m_Settings.value(CSettings::UI_SCALE, 100).toInt();
 	}
 
 	void CCategorySpriteSet::UpdateSprites()
@@ -90,44 +82,30 @@ namespace jass
 		// NOTE: Last one will be "None" (with same index as number of categories)
 		Resize((m_Categories.Size() + 1) * SPRITE_COUNT_PER_CATEGORY);
 
-		for (size_t category_index = 0; category_index <= m_Categories.Size(); ++category_index)
-		{
-			UpdateSpritesForCategory(category_index);
-		}
+		UpdateSpritesForCategories(0, m_Categories.Size() + 1);
 	}
 
-	void CCategorySpriteSet::UpdateSpritesForCategory(size_t category_index)
+	void CCategorySpriteSet::UpdateSpritesForCategories(size_t first, size_t count)
 	{
-		QPixmap pixmap;
-		QPoint origin;
-
-		const auto sprite_scale = SpriteScale();
-
-		SNodeSpriteDesc desc;
-		desc.Radius = (9 * sprite_scale) + .5f;
-		desc.OutlineWidth = std::round(sprite_scale * 3);
-		desc.OutlineWidth2 = 0;
-		const auto shadow_offset = (float)std::max((int)1, (int)std::round(sprite_scale));
-		desc.ShadowOffset = { shadow_offset, shadow_offset };
-		desc.ShadowBlurRadius = std::round(sprite_scale * 3);
-		desc.OutlineColor = qRgb(255, 255, 255);
-		desc.ShadowColor = qRgba(0, 0, 0, 255);
-		desc.Shape = m_Categories.Shape(category_index);
-
-		desc.FillColor = m_Categories.Color(category_index);
-		CreateNodeSprite(desc, pixmap, origin);
-		UpdateSprite(category_index * SPRITE_COUNT_PER_CATEGORY + 0, std::move(pixmap), origin);
-
-		desc.OutlineColor2 = COLOR_SELECTED;
-		desc.OutlineWidth2 = desc.OutlineWidth;
-		CreateNodeSprite(desc, pixmap, origin);
-		UpdateSprite(category_index * SPRITE_COUNT_PER_CATEGORY + 1, std::move(pixmap), origin);
-
-		desc.OutlineColor2 = COLOR_HILIGHT;
-		desc.OutlineWidth2 = std::round(sprite_scale * 4);
-		desc.FillColor = Blend(m_Categories.Color(category_index), 0xFFFFFFFF, 64);
-		CreateNodeSprite(desc, pixmap, origin);
-		UpdateSprite(category_index * SPRITE_COUNT_PER_CATEGORY + 2, std::move(pixmap), origin);
+		// Three styles per category, in EStyle order
+		const auto ui_scale = UiScale();
+		std::vector<SNodeSpriteKey> keys;
+		keys.reserve(count * SPRITE_COUNT_PER_CATEGORY);
+		for (size_t category_index = first; category_index < first + count; ++category_index)
+		{
+			const auto shape = m_Categories.Shape(category_index);
+			const auto color = m_Categories.Color(category_index);
+			keys.push_back({ shape, EStyle::Normal, color, ui_scale });
+			keys.push_back({ shape, EStyle::Selected, color, ui_scale });
+			keys.push_back({ shape, EStyle::Hilighted, Blend(color, 0xFFFFFFFF, 64), ui_scale });
+		}
+
+		std::vector<CNodeSpriteCache::SSprite> sprites(keys.size());
+		m_SpriteCache.GetSprites(keys, sprites);
+		for (size_t i = 0; i < sprites.size(); ++i)
+		{
+			UpdateSprite(first * SPRITE_COUNT_PER_CATEGORY + i, std::move(sprites[i].Pixmap), sprites[i].Origin);
+		}
 	}
 }
 
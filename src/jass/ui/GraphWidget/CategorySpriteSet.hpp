@@ -26,6 +26,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 namespace jass
 {
 	class CCategorySet;
+	class CNodeSpriteCache;
 	class CSettings;
 
 	class CCategorySpriteSet: public QObject, public CSpriteSet
@@ -34,7 +35,7 @@ namespace jass
 	public:
 		using EStyle = CGraphNodeTheme::EStyle;
 
-		CCategorySpriteSet(const CCategorySet& categories, const CSettings& settings);
+		CCategorySpriteSet(const CCategorySet& categories, const CSettings& settings, CNodeSpriteCache& sprite_cache);
 
 		inline size_t SpriteIndex(size_t category_index, EStyle style) const;
 
@@ -51,14 +52,13 @@ namespace jass
 	private:
 		static const uint8_t SPRITE_COUNT_PER_CATEGORY = 3;
 
-		struct SSpriteDesc;
-
-		float SpriteScale() const;
+		int UiScale() const;
 		void UpdateSprites();
-		void UpdateSpritesForCategory(size_t catgory_index);
+		void UpdateSpritesForCategories(size_t first, size_t count);
 
 		const CCategorySet& m_Categories;
 		const CSettings& m_Settings;
+		CNodeSpriteCache& m_SpriteCache;
 	};
 
 	inline size_t CCategorySpriteSet::SpriteIndex(size_t category_index, EStyle style) const
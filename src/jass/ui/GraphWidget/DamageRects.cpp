@@ -0,0 +1,88 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <limits>
+#include "DamageRects.h"
+
+namespace jass
+{
+	void CDamageRects::Add(const QRect& rc)
+	{
+		if (rc.isEmpty())
+		{
+			return;
+		}
+
+		// Absorb every rect that is cheap to merge with, again after each merge as the rect grows
+		QRect merged = rc;
+		for (size_t i = 0; i < m_Rects.size(); )
+		{
+			if (MergeCost(merged, m_Rects[i]) <= MERGE_SLACK_AREA)
+			{
+				merged = merged.united(m_Rects[i]);
+				m_Rects[i] = m_Rects.back();
+				m_Rects.pop_back();
+				i = 0;
+				continue;
+			}
+			++i;
+		}
+		m_Rects.push_back(merged);
+
+		if (m_Rects.size() <= MAX_RECT_COUNT)
+		{
+			return;
+		}
+
+		size_t best_a = 0;
+		size_t best_b = 1;
+		int64_t best_cost = std::numeric_limits<int64_t>::max();
+		for (size_t a = 0; a < m_Rects.size(); ++a)
+		{
+			for (size_t b = a + 1; b < m_Rects.size(); ++b)
+			{
+				const auto cost = MergeCost(m_Rects[a], m_Rects[b]);
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_a = a;
+					best_b = b;
+				}
+			}
+		}
+		// Added again, as the merged rect may now overlap others
+		const auto pair_rect = m_Rects[best_a].united(m_Rects[best_b]);
+		m_Rects[best_b] = m_Rects.back();
+		m_Rects.pop_back();
+		m_Rects[best_a] = m_Rects.back();
+		m_Rects.pop_back();
+		Add(pair_rect);
+	}
+
+	int64_t CDamageRects::Area(const QRect& rc)
+	{
+		return (int64_t)rc.width() * rc.height();
+	}
+
+	int64_t CDamageRects::MergeCost(const QRect& a, const QRect& b)
+	{
+		// Overlap is counted twice in the sum, so overlapping rects tend to cost nothing
+		return Area(a.united(b)) - Area(a) - Area(b);
+	}
+}
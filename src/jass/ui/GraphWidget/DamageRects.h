@@ -0,0 +1,55 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <QtCore/qrect.h>
+
+namespace jass
+{
+	// Damaged screen area as a few rects. Rects that overlap or nearly touch are merged, and when
+	// there are too many, the two that merge with the least extra area are. Scattered damage then
+	// stays a handful of rects, instead of becoming one rect covering everything in between.
+	class CDamageRects
+	{
+	public:
+		static constexpr size_t MAX_RECT_COUNT = 16;
+
+		inline void Clear() { m_Rects.clear(); }
+
+		inline bool Empty() const { return m_Rects.empty(); }
+
+		void Add(const QRect& rc);
+
+		inline const std::vector<QRect>& Rects() const { return m_Rects; }
+
+	private:
+		// Merging costs less than repainting this many extra pixels
+		static constexpr int64_t MERGE_SLACK_AREA = 32 * 32;
+
+		static int64_t Area(const QRect& rc);
+
+		// Pixels that merging 'a' and 'b' adds, beyond those of both
+		static int64_t MergeCost(const QRect& a, const QRect& b);
+
+		std::vector<QRect> m_Rects;
+	};
+}
@@ -17,6 +17,9 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <numeric>
+
 #include <QtCore/qline.h>
 #include <QtGui/qpainter.h>
 #include <QtGui/qpen.h>
@@ -27,6 +30,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <jass/GraphModel.hpp>
 
 #include "EdgeGraphLayer.hpp"
+#include "DamageRects.h"
 
 namespace jass
 {
@@ -38,14 +42,27 @@ namespace jass
 	//static const QRgb COLOR_HILIGHT = qRgb(0xe7, 0x85, 0x1d);  // Orange
 	
 
-	// TODO: Improve performance
+	// Whether the bounding box of 'line', inflated by 'inflate_amount' for the line width, overlaps 'rc'
+	static bool LineBoxIntersects(const QLineF& line, const QRectF& rc, qreal inflate_amount)
+	{
+		return
+			std::min(line.x1(), line.x2()) - inflate_amount < rc.right() &&
+			std::max(line.x1(), line.x2()) + inflate_amount > rc.left() &&
+			std::min(line.y1(), line.y2()) - inflate_amount < rc.bottom() &&
+			std::max(line.y1(), line.y2()) + inflate_amount > rc.top();
+	}
+
 	template <class TFunc>
 	void CEdgeGraphLayer::ForEachPotentialEdgeInRange(const QRectF& range, TFunc&& func) const
 	{
-		for (auto& edge : m_Edges)
-		{
-			func(edge);
-		}
+		// Model edges span the full distance between nodes, so they cover our lines with cut ends
+		m_GraphModel.ForEachEdgeInRect(range, [&](CGraphModel::edge_index_t edge_index)
+			{
+				if (edge_index < m_Edges.size())
+				{
+					func(m_Edges[edge_index]);
+				}
+			});
 	}
 
 	CEdgeGraphLayer::CEdgeGraphLayer(CGraphWidget& graphWidget, CGraphModel& graph_model, CGraphSelectionModel& selection_model)
@@ -57,6 +74,7 @@ namespace jass
 		connect(&graph_model, &CGraphModel::EdgesRemoved, this, &CEdgeGraphLayer::OnEdgesRemoved);
 		connect(&selection_model, &CGraphSelectionModel::SelectionChanged, this, &CEdgeGraphLayer::OnSelectionChanged);
 		connect(&graph_model, &CGraphModel::NodesModified, this, &CEdgeGraphLayer::OnNodesModified);
+		connect(&graph_model, &CGraphModel::Changed, this, &CEdgeGraphLayer::OnGraphChanged);
 		RebuildEdges();
 	}
 
@@ -78,13 +96,13 @@ namespace jass
 
 		if (!rcUpdate.isEmpty())
 		{
-			Update(rcUpdate);
+			UpdateOverlay(rcUpdate);
 		}
 	}
 
 	void CEdgeGraphLayer::HideTempLine()
 	{
-		Update(LineRect(m_TempLine, m_TempLineWidth));
+		UpdateOverlay(LineRect(m_TempLine, m_TempLineWidth));
 		m_TempLine = QLineF();
 	}
 
@@ -122,43 +140,191 @@ namespace jass
 		Update(EdgeScreenRect(m_Edges[edge]));
 	}
 
+	// Screen space lines of the edges in some region, sorted into cells about the size of a tile,
+	// so that painting a tile only tests the lines near it
+	class CEdgeGraphLayer::CSnapshot: public IGraphLayerSnapshot
+	{
+	public:
+		CSnapshot(const std::vector<QLineF>* lines_per_style, const QRect& rc, ELevelOfDetail level_of_detail, float line_width, float hilight_line_width);
+
+		void Paint(QPainter& painter, const QRect& rc) const override;
+
+	private:
+		static constexpr int CELL_SIZE = 256;  // About a tile
+
+		inline int CellColumn(qreal x) const { return std::clamp((int)std::floor((x - m_Rect.left()) / CELL_SIZE), 0, m_Columns - 1); }
+		inline int CellRow(qreal y) const { return std::clamp((int)std::floor((y - m_Rect.top()) / CELL_SIZE), 0, m_Rows - 1); }
+
+		QRect m_Rect;
+		int m_Columns;
+		int m_Rows;
+		qreal m_MaxLineExtent = 0;  // Largest width or height of a line, to find lines reaching in from cells before a tile
+		std::vector<QLineF> m_Lines[STYLE_COUNT];  // Sorted by the cell of their top left corner
+		std::vector<uint32_t> m_CellStarts[STYLE_COUNT];  // Index of the first line of each cell in m_Lines, and of the end
+		ELevelOfDetail m_LevelOfDetail;
+		float m_LineWidth;
+		float m_HilightLineWidth;
+	};
+
+	CEdgeGraphLayer::CSnapshot::CSnapshot(const std::vector<QLineF>* lines_per_style, const QRect& rc, ELevelOfDetail level_of_detail, float line_width, float hilight_line_width)
+		: m_Rect(rc)
+		, m_Columns(std::max(1, (rc.width() + CELL_SIZE - 1) / CELL_SIZE))
+		, m_Rows(std::max(1, (rc.height() + CELL_SIZE - 1) / CELL_SIZE))
+		, m_LevelOfDetail(level_of_detail)
+		, m_LineWidth(line_width)
+		, m_HilightLineWidth(hilight_line_width)
+	{
+		// Counting sort by cell
+		std::vector<uint32_t> line_cells;
+		for (int style = 0; style < STYLE_COUNT; ++style)
+		{
+			const auto& lines = lines_per_style[style];
+			auto& cell_starts = m_CellStarts[style];
+			cell_starts.assign(m_Columns * m_Rows + 1, 0);
+			line_cells.resize(lines.size());
+			for (size_t i = 0; i < lines.size(); ++i)
+			{
+				const auto& line = lines[i];
+				m_MaxLineExtent = std::max(m_MaxLineExtent, std::max(std::abs(line.dx()), std::abs(line.dy())));
+				line_cells[i] = CellRow(std::min(line.y1(), line.y2())) * m_Columns + CellColumn(std::min(line.x1(), line.x2()));
+				++cell_starts[line_cells[i] + 1];
+			}
+			std::partial_sum(cell_starts.begin(), cell_starts.end(), cell_starts.begin());
+
+			auto next_in_cell = cell_starts;
+			m_Lines[style].resize(lines.size());
+			for (size_t i = 0; i < lines.size(); ++i)
+			{
+				m_Lines[style][next_in_cell[line_cells[i]]++] = lines[i];
+			}
+		}
+	}
+
+	void CEdgeGraphLayer::CSnapshot::Paint(QPainter& painter, const QRect& rc) const
+	{
+		// Lines were collected for a whole frame, only draw those near 'rc'
+		const QRectF rc_test(rc);
+		const qreal inflate_amount = .5 * std::max(m_LineWidth, m_HilightLineWidth);
+		const auto first_column = CellColumn(rc_test.left() - inflate_amount - m_MaxLineExtent);
+		const auto last_column = CellColumn(rc_test.right() + inflate_amount);
+		const auto first_row = CellRow(rc_test.top() - inflate_amount - m_MaxLineExtent);
+		const auto last_row = CellRow(rc_test.bottom() + inflate_amount);
+
+		std::vector<QLineF> lines[STYLE_COUNT];
+		for (int style = 0; style < STYLE_COUNT; ++style)
+		{
+			const auto& cell_starts = m_CellStarts[style];
+			for (int row = first_row; row <= last_row; ++row)
+			{
+				// Cells of a row are contiguous
+				const auto begin = cell_starts[row * m_Columns + first_column];
+				const auto end = cell_starts[row * m_Columns + last_column + 1];
+				for (auto i = begin; i < end; ++i)
+				{
+					if (LineBoxIntersects(m_Lines[style][i], rc_test, inflate_amount))
+					{
+						lines[style].push_back(m_Lines[style][i]);
+					}
+				}
+			}
+		}
+		std::vector<QLine> temp_merged_lines;
+		std::vector<QPoint> temp_merged_points;
+		DrawLines(painter, lines, m_LevelOfDetail, m_LineWidth, m_HilightLineWidth, temp_merged_lines, temp_merged_points);
+	}
+
 	void CEdgeGraphLayer::Paint(QPainter& painter, const QRect& rcClip)
 	{
-		QPen penNormal(COLOR_NORMAL);
-		penNormal.setWidth(m_LineWidth);
+		const auto level_of_detail = CollectLines(rcClip);
+		DrawLines(painter, m_TempLines, level_of_detail, m_LineWidth, m_TempLineWidth, m_TempMergedLines, m_TempMergedPoints);
+	}
 
-		QPen penSelected(COLOR_SELECTED);
-		penSelected.setWidth(m_LineWidth);
+	std::shared_ptr<const IGraphLayerSnapshot> CEdgeGraphLayer::Snapshot(const QRect& rc)
+	{
+		const auto level_of_detail = CollectLines(rc);
+		return std::make_shared<CSnapshot>(m_TempLines, rc, level_of_detail, m_LineWidth, m_TempLineWidth);
+	}
 
-		QPen penHilight(COLOR_HILIGHT);
-		penHilight.setWidth(m_TempLineWidth);
+	ELevelOfDetail CEdgeGraphLayer::CollectLines(const QRect& rc)
+	{
+		// Edges connect neighbouring nodes, so they are about as long as the node spacing
+		const auto level_of_detail = GraphWidget().LevelOfDetail(m_GraphModel.TypicalNodeSpacing());
 
-		const int inflate_amount = std::ceil(.5f * m_LineWidth);
-		const auto rcModelTest = GraphWidget().ModelFromScreen(QRectF(rcClip).adjusted(-inflate_amount, -inflate_amount, inflate_amount, inflate_amount));
+		const qreal inflate_amount = .5 * m_LineWidth;
+		const QRectF rc_test(rc);
+		const auto rcModelTest = GraphWidget().ModelFromScreen(rc_test.adjusted(-inflate_amount, -inflate_amount, inflate_amount, inflate_amount));
 
-		painter.setRenderHint(QPainter::Antialiasing);
+		// ScreenFromModel(pt) == pt * scale + offset
+		const qreal scale = GraphWidget().ModelToScreenScale();
+		const auto offset = GraphWidget().ScreenFromModel(QPointF(0, 0));
 
+		// Bucket visible lines by style, so that each style is drawn with a single pen change and
+		// call, mapping them to the screen on the way
+		for (auto& lines : m_TempLines)
+		{
+			lines.clear();
+		}
 		ForEachPotentialEdgeInRange(
 			rcModelTest,
 			[&](auto& edge)
 			{
-				if (rcModelTest.intersects(EdgeModelRect(edge)))
+				const QLineF line(edge.Line.p1() * scale + offset, edge.Line.p2() * scale + offset);
+				if (LineBoxIntersects(line, rc_test, inflate_amount))
 				{
-					if (IsHilighted(&edge - m_Edges.data()))
-						painter.setPen(penHilight);
-					else if (IsSelected(&edge - m_Edges.data()))
-						painter.setPen(penSelected);
-					else
-						painter.setPen(penNormal);
-					painter.drawLine(GraphWidget().ScreenFromModel(edge.Line.p1()), GraphWidget().ScreenFromModel(edge.Line.p2()));
+					const auto edge_index = &edge - m_Edges.data();
+					const auto style = IsHilighted(edge_index) ? STYLE_HILIGHT : (IsSelected(edge_index) ? STYLE_SELECTED : STYLE_NORMAL);
+					m_TempLines[style].push_back(line);
 				}
 			});
 
+		return level_of_detail;
+	}
+
+	void CEdgeGraphLayer::DrawLines(QPainter& painter, const std::vector<QLineF>* lines_per_style, ELevelOfDetail level_of_detail, float line_width, float hilight_line_width, std::vector<QLine>& temp_merged_lines, std::vector<QPoint>& temp_merged_points)
+	{
+		const bool full_detail = (ELevelOfDetail::Full == level_of_detail);
+
+		QPen pens[STYLE_COUNT] = { QPen(COLOR_NORMAL), QPen(COLOR_SELECTED), QPen(COLOR_HILIGHT) };
+		pens[STYLE_NORMAL].setWidth(full_detail ? line_width : 1);
+		pens[STYLE_SELECTED].setWidth(full_detail ? line_width : 1);
+		pens[STYLE_HILIGHT].setWidth(full_detail ? hilight_line_width : 2);
+
+		painter.setRenderHint(QPainter::Antialiasing, full_detail);
+		for (int style = 0; style < STYLE_COUNT; ++style)
+		{
+			const auto& lines = lines_per_style[style];
+			if (lines.empty())
+			{
+				continue;
+			}
+			painter.setPen(pens[style]);
+			if (ELevelOfDetail::Minimal != level_of_detail)
+			{
+				painter.drawLines(lines.data(), (int)lines.size());
+				continue;
+			}
+
+			// Many edges collapse into the same few pixels
+			temp_merged_lines.clear();
+			temp_merged_points.clear();
+			for (const auto& line : lines)
+			{
+				temp_merged_lines.push_back(line.toLine());
+			}
+			MergeSubPixelLines(temp_merged_lines, temp_merged_points);
+			painter.drawLines(temp_merged_lines.data(), (int)temp_merged_lines.size());
+			painter.drawPoints(temp_merged_points.data(), (int)temp_merged_points.size());
+		}
+	}
+
+	void CEdgeGraphLayer::PaintOverlay(QPainter& painter, const QRect& rcClip)
+	{
 		if (!m_TempLine.isNull())
 		{
 			QPen pen(COLOR_HILIGHT);
 			pen.setCapStyle(Qt::RoundCap);
 			pen.setWidth(m_TempLineWidth);
+			painter.setRenderHint(QPainter::Antialiasing);
 			painter.setPen(pen);
 			painter.drawLine(m_TempLine);
 		}
@@ -212,13 +378,23 @@ namespace jass
 		m_SelectionModel.EndModify();
 	}
 
-	void CEdgeGraphLayer::OnViewChanged(const QRect& rc, float screen_to_model_scale)
+	void CEdgeGraphLayer::OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change)
 	{
-		RebuildEdges();
+		// Item rects are kept in content coordinates, so a translation leaves them valid
+		if (EViewChange::Scale == change)
+		{
+			RebuildEdges();
+		}
 	}
 
 	void CEdgeGraphLayer::OnSelectionChanged()
 	{
+		if (m_EdgesDirty)
+		{
+			// Edge indices are stale until the rebuild, which takes the selection from the model
+			return;
+		}
+
 		m_TempSelectionMask.bitwise_xor(m_SelectionMask, m_SelectionModel.EdgeMask());
 
 		m_TempSelectionMask.for_each_set_bit([&](size_t edge_index)
@@ -230,21 +406,25 @@ namespace jass
 			});
 	}
 
-	void CEdgeGraphLayer::OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CEdgeGraphLayer::OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::index_moves_t& moves)
 	{
-		RebuildEdges();
-		Update();
+		m_EdgesDirty = true;
 	}
 
 	void CEdgeGraphLayer::OnEdgesRemoved(const CGraphModel::const_edge_indices_t& edge_indices)
 	{
-		RebuildEdges();
-		Update();
+		m_EdgesDirty = true;
 	}
 
-	void CEdgeGraphLayer::OnNodesModified(const bitvec& nodes_mask)
+	void CEdgeGraphLayer::OnNodesModified(const sparse_bitvec& nodes_mask)
 	{
-		QRect rc, rcUpdate;
+		if (m_EdgesDirty)
+		{
+			return;
+		}
+
+		QRect rc;
+		CDamageRects damage;
 		nodes_mask.for_each_set_bit([&](const size_t node_index)
 			{
 				const auto node_pos = m_GraphModel.NodePosition((CGraphModel::node_index_t)node_index);
@@ -252,14 +432,24 @@ namespace jass
 				{
 					if (MoveEdge(edge_index, node_pos, m_GraphModel.NodePosition(neighbour_index), rc))
 					{
-						rcUpdate = rcUpdate.united(rc);
+						damage.Add(rc);
 					}
 				});
 			});
-		if (!rcUpdate.isNull())
+		for (const auto& rc_damage : damage.Rects())
+		{
+			Update(rc_damage);
+		}
+	}
+
+	void CEdgeGraphLayer::OnGraphChanged(const CGraphModel::SChangeSet& changes)
+	{
+		if (!m_EdgesDirty)
 		{
-			Update(rcUpdate);
+			return;
 		}
+		RebuildEdges();
+		Update();
 	}
 
 	static QLineF CutEnds(const QLineF& line, float cut_length)
@@ -285,9 +475,11 @@ namespace jass
 			m_Edges[edge_index].Line = CutEnds(QLineF(p0, p1), CUT_END_LENGTH);
 		}
 
+		m_SelectionMask = m_SelectionModel.EdgeMask();
 		m_SelectionMask.resize(m_Edges.size());
 		m_HilightMask.resize(m_Edges.size());
 		m_HilightMask.clearAll();
+		m_EdgesDirty = false;
 	}
 
 	bool CEdgeGraphLayer::MoveEdge(size_t edge_index, const QPointF& p0, const QPointF& p1, QRect& out_update_rect)
@@ -304,17 +496,6 @@ namespace jass
 		return true;
 	}
 
-	QRectF CEdgeGraphLayer::EdgeModelRect(const SEdge& edge) const
-	{
-		const auto& line = edge.Line;
-		const float line_width_model = m_LineWidth * GraphWidget().ScreenToModelScale();
-		return QRectF(
-			std::min(line.p1().x(), line.p2().x()) - line_width_model * .5f,
-			std::min(line.p1().y(), line.p2().y()) - line_width_model * .5f,
-			std::abs(line.p2().x() - line.p1().x()) + line_width_model,
-			std::abs(line.p2().y() - line.p1().y()) + line_width_model);
-	}
-
 	QRect CEdgeGraphLayer::EdgeScreenRect(const SEdge& edge) const
 	{
 		const auto& line = edge.Line;
@@ -38,18 +38,22 @@ namespace jass
 
 		// CGraphLayer overrides
 		void Paint(QPainter& painter, const QRect& rc) override;
+		void PaintOverlay(QPainter& painter, const QRect& rc) override;
+		bool CanCachePaint() const override { return true; }
+		std::shared_ptr<const IGraphLayerSnapshot> Snapshot(const QRect& rc) override;
 		element_t HitTest(const QPoint& pt) override;
 		bool RangedHitTest(const QRect& rc, bitvec& out_hit_elements) const override;
 		void SetHilighted(element_t edge, bool hilighted) override;
 		void GetSelection(bitvec& out_selection_mask) const override;
 		void SetSelection(const bitvec& selection_mask) const override;
-		void OnViewChanged(const QRect& rc, float screen_to_model_scale) override;
+		void OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change) override;
 
 	private Q_SLOTS:
 		void OnSelectionChanged();
-		void OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::node_remap_table_t& remap_table);
+		void OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::index_moves_t& moves);
 		void OnEdgesRemoved(const CGraphModel::const_edge_indices_t& edge_indices);
-		void OnNodesModified(const bitvec& nodes_mask);
+		void OnNodesModified(const sparse_bitvec& nodes_mask);
+		void OnGraphChanged(const CGraphModel::SChangeSet& changes);
 
 	private:
 		struct SEdge
@@ -57,8 +61,24 @@ namespace jass
 			QLineF Line;
 		};
 
+		enum EStyle
+		{
+			STYLE_NORMAL,
+			STYLE_SELECTED,
+			STYLE_HILIGHT,
+			STYLE_COUNT
+		};
+
+		class CSnapshot;
+
 		inline bool IsSelected(element_t edge) const;
 
+		// Buckets the screen space lines of visible edges in m_TempLines by style
+		ELevelOfDetail CollectLines(const QRect& rc);
+
+		// Draws screen space lines per style
+		static void DrawLines(QPainter& painter, const std::vector<QLineF>* lines_per_style, ELevelOfDetail level_of_detail, float line_width, float hilight_line_width, std::vector<QLine>& temp_merged_lines, std::vector<QPoint>& temp_merged_points);
+
 		void RebuildEdges();
 
 		bool MoveEdge(size_t edge_index, const QPointF& p0, const QPointF& p1, QRect& out_update_rect);
@@ -66,7 +86,6 @@ namespace jass
 		template <class TFunc>
 		void ForEachPotentialEdgeInRange(const QRectF& range, TFunc&& func) const;
 
-		QRectF EdgeModelRect(const SEdge& edge) const;
 		QRect EdgeScreenRect(const SEdge& edge) const;
 		static QRect LineRect(const QLineF& line, float line_width);
 
@@ -76,6 +95,10 @@ namespace jass
 		float m_LineWidth = 2;
 		float m_TempLineWidth = 4;
 		std::vector<SEdge> m_Edges;
+		bool m_EdgesDirty = false;  // Edges inserted or removed, rebuilt once the transaction commits
+		std::vector<QLineF> m_TempLines[STYLE_COUNT];  // Screen space lines to draw per style, kept to avoid reallocation
+		std::vector<QLine> m_TempMergedLines;
+		std::vector<QPoint> m_TempMergedPoints;
 		QLineF m_TempLine;
 		bitvec m_SelectionMask;
 		bitvec m_TempSelectionMask;
@@ -69,19 +69,57 @@ namespace jass
 		m_Sprites.Draw(NodeShape(element), style, m_NodeColors[element], pos, painter);
 	}
 
+	void CGraphNodeAnalysisTheme::DrawElements(std::span<const SElementInstance> elements, QPainter& painter) const
+	{
+		AddFragments(elements, m_TempFragments);
+		m_Sprites.Atlas().DrawFragments(m_TempFragments, painter);
+	}
+
+	bool CGraphNodeAnalysisTheme::SnapshotElements(std::span<const SElementInstance> elements, CElementsSnapshot& out_snapshot) const
+	{
+		AddFragments(elements, out_snapshot.Fragments);
+		out_snapshot.Atlas = m_Sprites.Atlas().Image();
+		out_snapshot.LevelOfDetail = ELevelOfDetail::Full;
+		return true;
+	}
+
+	void CGraphNodeAnalysisTheme::AddFragments(std::span<const SElementInstance> elements, std::vector<QPainter::PixmapFragment>& fragments) const
+	{
+		const auto& atlas = m_Sprites.Atlas();
+		fragments.clear();
+		fragments.reserve(elements.size());
+		for (const auto& element : elements)
+		{
+			atlas.AddFragment(fragments, m_Sprites.SpriteIndex(NodeShape(element.Element), element.Style, m_NodeColors[element.Element]), element.Pos);
+		}
+	}
+
 	QRgb CGraphNodeAnalysisTheme::ElementColor(element_t element) const
 	{
 		return m_Sprites.Color(m_NodeColors[element]);
 	}
 
-	void CGraphNodeAnalysisTheme::OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices)
+	QSize CGraphNodeAnalysisTheme::MaxElementSize() const
+	{
+		QSize max_size(0, 0);
+		for (size_t shape = 0; shape < (size_t)EShape::_COUNT; ++shape)
+		{
+			for (size_t style = 0; style < (size_t)EStyle::_COUNT; ++style)
+			{
+				max_size = max_size.expandedTo(m_Sprites.Rect((EShape)shape, (EStyle)style).size());
+			}
+		}
+		return max_size;
+	}
+
+	void CGraphNodeAnalysisTheme::OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves)
 	{
-		collapse(m_NodeColors, node_indices);
+		remove_by_moves(m_NodeColors, moves, m_NodeColors.size() - node_indices.size());
 	}
 
-	void CGraphNodeAnalysisTheme::OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CGraphNodeAnalysisTheme::OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves)
 	{
-		expand(m_NodeColors, node_indices, (uint8_t)0);
+		insert_by_moves(m_NodeColors, node_indices, moves, (uint8_t)0);
 	}
 
 	void CGraphNodeAnalysisTheme::OnMetricUpdated(const QString& name, const std::span<const float>& values)
@@ -42,15 +42,20 @@ namespace jass
 		// CGraphNodeTheme overrides
 		QRect ElementLocalRect(element_t element, EStyle style) const override;
 		void  DrawElement(element_t element, EStyle style, const QPoint& pos, QPainter& painter) const override;
+		void  DrawElements(std::span<const SElementInstance> elements, QPainter& painter) const override;
+		bool  SnapshotElements(std::span<const SElementInstance> elements, CElementsSnapshot& out_snapshot) const override;
 		QRgb  ElementColor(element_t element) const override;
+		QSize MaxElementSize() const override;
 
 	private Q_SLOTS:
-		void OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices);
-		void OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table);
+		void OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves);
+		void OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves);
 		void OnMetricUpdated(const QString& name, const std::span<const float>& values);
 		void OnSpritesChanged();
 
 	private:
+		void AddFragments(std::span<const SElementInstance> elements, std::vector<QPainter::PixmapFragment>& fragments) const;
+
 		inline EShape NodeShape(element_t element) const;
 		void UpdateColors(const std::span<const float>& metric_values);
 
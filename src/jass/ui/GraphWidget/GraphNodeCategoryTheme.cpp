@@ -50,12 +50,48 @@ namespace jass
 		m_Sprites->DrawSprite(sprite_index, painter, pos);
 	}
 
+	void CGraphNodeCategoryTheme::DrawElements(std::span<const SElementInstance> elements, QPainter& painter) const
+	{
+		AddFragments(elements, m_TempFragments);
+		m_Sprites->Atlas().DrawFragments(m_TempFragments, painter);
+	}
+
+	bool CGraphNodeCategoryTheme::SnapshotElements(std::span<const SElementInstance> elements, CElementsSnapshot& out_snapshot) const
+	{
+		AddFragments(elements, out_snapshot.Fragments);
+		out_snapshot.Atlas = m_Sprites->Atlas().Image();
+		out_snapshot.LevelOfDetail = ELevelOfDetail::Full;
+		return true;
+	}
+
+	void CGraphNodeCategoryTheme::AddFragments(std::span<const SElementInstance> elements, std::vector<QPainter::PixmapFragment>& fragments) const
+	{
+		const auto& atlas = m_Sprites->Atlas();
+		fragments.clear();
+		fragments.reserve(elements.size());
+		for (const auto& element : elements)
+		{
+			const auto category_index = m_GraphModel.NodeCategory((CGraphModel::node_index_t)element.Element);
+			atlas.AddFragment(fragments, m_Sprites->SpriteIndex(category_index, element.Style), element.Pos);
+		}
+	}
+
 	QRgb CGraphNodeCategoryTheme::ElementColor(element_t element) const
 	{
 		const auto category_index = m_GraphModel.NodeCategory((CGraphModel::node_index_t)element);
 		return m_Categories.Color(category_index);
 	}
 
+	QSize CGraphNodeCategoryTheme::MaxElementSize() const
+	{
+		QSize max_size(0, 0);
+		for (size_t sprite_index = 0; sprite_index < m_Sprites->Count(); ++sprite_index)
+		{
+			max_size = max_size.expandedTo(m_Sprites->SpriteRect(sprite_index).size());
+		}
+		return max_size;
+	}
+
 	void CGraphNodeCategoryTheme::OnSpritesChanged()
 	{
 		emit Updated();
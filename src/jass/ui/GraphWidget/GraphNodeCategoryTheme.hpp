@@ -37,12 +37,17 @@ namespace jass
 		// CGraphNodeTheme overrides
 		QRect ElementLocalRect(element_t element, EStyle style) const override;
 		void  DrawElement(element_t element, EStyle style, const QPoint& pos, QPainter& painter) const override;
+		void  DrawElements(std::span<const SElementInstance> elements, QPainter& painter) const override;
+		bool  SnapshotElements(std::span<const SElementInstance> elements, CElementsSnapshot& out_snapshot) const override;
 		QRgb  ElementColor(element_t element) const override;
+		QSize MaxElementSize() const override;
 
 	private Q_SLOTS:
 		void OnSpritesChanged();
 
 	private:
+		void AddFragments(std::span<const SElementInstance> elements, std::vector<QPainter::PixmapFragment>& fragments) const;
+
 		static const uint8_t SPRITE_COUNT_PER_CATEGORY = 3;
 
 		struct SSpriteDesc;
@@ -17,10 +17,121 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include <QtGui/qpainter.h>
+
 #include "GraphNodeTheme.hpp"
+#include "SpriteAtlas.h"
 
 namespace jass
 {
+	static const QRgb COLOR_SELECTED = qRgb(0x0a, 0x84, 0xff);
+
+	void CGraphNodeTheme::DrawElements(std::span<const SElementInstance> elements, QPainter& painter) const
+	{
+		for (const auto& element : elements)
+		{
+			DrawElement(element.Element, element.Style, element.Pos, painter);
+		}
+	}
+
+	// Draws color runs of 'colored_points' as flat squares, or as single pixels for ELevelOfDetail::Minimal
+	static void DrawColoredPoints(std::span<const std::pair<QRgb, QPoint>> colored_points, ELevelOfDetail level_of_detail, QPainter& painter)
+	{
+		painter.setRenderHint(QPainter::Antialiasing, false);
+		std::vector<QPoint> points;
+		std::vector<QRect> rects;
+		for (auto run_begin = colored_points.begin(); run_begin != colored_points.end(); )
+		{
+			const auto color = run_begin->first;
+			auto run_end = run_begin;
+			points.clear();
+			rects.clear();
+			for (; run_end != colored_points.end() && run_end->first == color; ++run_end)
+			{
+				if (ELevelOfDetail::Minimal == level_of_detail)
+				{
+					points.push_back(run_end->second);
+				}
+				else
+				{
+					rects.emplace_back(run_end->second - QPoint(CGraphNodeTheme::SIMPLIFIED_ELEMENT_SIZE / 2, CGraphNodeTheme::SIMPLIFIED_ELEMENT_SIZE / 2), QSize(CGraphNodeTheme::SIMPLIFIED_ELEMENT_SIZE, CGraphNodeTheme::SIMPLIFIED_ELEMENT_SIZE));
+				}
+			}
+			if (!points.empty())
+			{
+				painter.setPen(QColor(color));
+				painter.drawPoints(points.data(), (int)points.size());
+			}
+			if (!rects.empty())
+			{
+				painter.setPen(Qt::NoPen);
+				painter.setBrush(QColor(color));
+				painter.drawRects(rects.data(), (int)rects.size());
+			}
+			run_begin = run_end;
+		}
+	}
+
+	void CGraphNodeTheme::DrawElementsSimplified(std::span<const SElementInstance> elements, ELevelOfDetail level_of_detail, QPainter& painter) const
+	{
+		CElementsSnapshot snapshot;
+		SnapshotElementsSimplified(elements, level_of_detail, snapshot);
+		DrawColoredPoints(snapshot.ColoredPoints, level_of_detail, painter);
+	}
+
+	void CGraphNodeTheme::SnapshotElementsSimplified(std::span<const SElementInstance> elements, ELevelOfDetail level_of_detail, CElementsSnapshot& out_snapshot) const
+	{
+		// Sort by color, so that each color is drawn with a single call, and merge elements that
+		// end up on the same pixel
+		auto& colored_points = out_snapshot.ColoredPoints;
+		colored_points.clear();
+		colored_points.reserve(elements.size());
+		for (const auto& element : elements)
+		{
+			const auto color = (EStyle::Normal == element.Style) ? ElementColor(element.Element) : COLOR_SELECTED;
+			colored_points.emplace_back(color, element.Pos);
+		}
+		auto less = [](const std::pair<QRgb, QPoint>& a, const std::pair<QRgb, QPoint>& b)
+			{
+				return std::make_tuple(a.first, a.second.y(), a.second.x()) < std::make_tuple(b.first, b.second.y(), b.second.x());
+			};
+		std::sort(colored_points.begin(), colored_points.end(), less);
+		colored_points.erase(std::unique(colored_points.begin(), colored_points.end()), colored_points.end());
+
+		out_snapshot.LevelOfDetail = level_of_detail;
+	}
+
+	void CGraphNodeTheme::CElementsSnapshot::Paint(QPainter& painter, const QRect& rc) const
+	{
+		// Elements were resolved for a whole frame, only draw those near 'rc'
+		if (ELevelOfDetail::Full == LevelOfDetail)
+		{
+			std::vector<QPainter::PixmapFragment> fragments;
+			for (const auto& fragment : Fragments)
+			{
+				if (rc.intersects(QRectF(fragment.x - .5 * fragment.width, fragment.y - .5 * fragment.height, fragment.width, fragment.height).toAlignedRect()))
+				{
+					fragments.push_back(fragment);
+				}
+			}
+			CSpriteAtlas::DrawFragments(fragments, Atlas, painter);
+			return;
+		}
+
+		const auto rc_test = rc.adjusted(-SIMPLIFIED_ELEMENT_SIZE, -SIMPLIFIED_ELEMENT_SIZE, SIMPLIFIED_ELEMENT_SIZE, SIMPLIFIED_ELEMENT_SIZE);
+		std::vector<std::pair<QRgb, QPoint>> colored_points;
+		for (const auto& colored_point : ColoredPoints)
+		{
+			if (rc_test.contains(colored_point.second))
+			{
+				colored_points.push_back(colored_point);
+			}
+		}
+		DrawColoredPoints(colored_points, LevelOfDetail, painter);
+	}
 }
 
 #include <moc_GraphNodeTheme.cpp>
\ No newline at end of file
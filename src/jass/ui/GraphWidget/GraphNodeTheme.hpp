@@ -19,6 +19,11 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <span>
+#include <utility>
+#include <vector>
+#include <QtGui/qimage.h>
+#include <QtGui/qpainter.h>
 #include "GraphWidget.hpp"
 
 namespace jass
@@ -40,7 +45,49 @@ namespace jass
 		virtual void  DrawElement(element_t element, EStyle style, const QPoint& pos, QPainter& painter) const = 0;
 		virtual QRgb  ElementColor(element_t element) const = 0;  // Not sure about this one. Currently only needed for SVG export.
 
+		// Largest ElementLocalRect of any element and style. May change only along with Updated.
+		virtual QSize MaxElementSize() const = 0;
+
+		struct SElementInstance
+		{
+			element_t Element;
+			EStyle    Style;
+			QPoint    Pos;
+		};
+
+		// Draws elements in the given order. Override to draw them all with a few calls instead of
+		// one DrawElement call each.
+		virtual void DrawElements(std::span<const SElementInstance> elements, QPainter& painter) const;
+
+		static constexpr int SIMPLIFIED_ELEMENT_SIZE = 4;
+
+		// Draws elements as flat squares of their color, or as single pixels for
+		// ELevelOfDetail::Minimal, for when they are too dense to tell apart
+		void DrawElementsSimplified(std::span<const SElementInstance> elements, ELevelOfDetail level_of_detail, QPainter& painter) const;
+
+		// What DrawElements or DrawElementsSimplified draw, resolved to sprites and colors, so that
+		// it can be painted on the render thread
+		class CElementsSnapshot: public IGraphLayerSnapshot
+		{
+		public:
+			ELevelOfDetail LevelOfDetail = ELevelOfDetail::Full;
+			QImage Atlas;
+			std::vector<QPainter::PixmapFragment> Fragments;   // Full detail
+			std::vector<std::pair<QRgb, QPoint>> ColoredPoints;  // Simplified, sorted by color
+
+			void Paint(QPainter& painter, const QRect& rc) const override;
+		};
+
+		// Returns false if the theme can only draw on the UI thread
+		virtual bool SnapshotElements(std::span<const SElementInstance> elements, CElementsSnapshot& out_snapshot) const { return false; }
+
+		void SnapshotElementsSimplified(std::span<const SElementInstance> elements, ELevelOfDetail level_of_detail, CElementsSnapshot& out_snapshot) const;
+
 	Q_SIGNALS:
 		void Updated();
+
+	protected:
+		// For DrawElements overrides, kept to avoid reallocating every paint
+		mutable std::vector<QPainter::PixmapFragment> m_TempFragments;
 	};
 }
\ No newline at end of file
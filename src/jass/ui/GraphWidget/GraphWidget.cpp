@@ -20,6 +20,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <QtCore/qtimer.h>
 #include <QtGui/qevent.h>
 #include <QtGui/qpainter.h>
+#include <QtGui/qscreen.h>
 #include <QtWidgets/qtooltip.h>
 
 #include <jass/math/Geometry.h>
@@ -27,6 +28,8 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <jass/Debug.h>
 
 #include "GraphWidget.hpp"
+#include "TileCache.h"
+#include "TileRenderWorker.hpp"
 
 namespace jass
 {
@@ -55,8 +58,16 @@ namespace jass
 	};
 
 	CGraphWidget::CGraphWidget(QWidget* parent)
-		: m_ZoomLevel(DEFAULT_ZOOM_LEVEL)
+		: m_TileRenderWorker(new CTileRenderWorker)
+		, m_ZoomLevel(DEFAULT_ZOOM_LEVEL)
 	{
+		VERIFY(connect(m_TileRenderWorker.get(), &CTileRenderWorker::FrameRendered, this, &CGraphWidget::OnTileFrameRendered, Qt::QueuedConnection));
+
+		m_RepaintTimer = new QTimer(this);
+		m_RepaintTimer->setSingleShot(true);
+		m_RepaintTimer->setTimerType(Qt::PreciseTimer);
+		VERIFY(connect(m_RepaintTimer, &QTimer::timeout, this, &CGraphWidget::OnRepaintTimer));
+
 		setMouseTracking(true);
 
 		// Set the focus policy to accept keyboard focus
@@ -71,6 +82,9 @@ namespace jass
 
 	CGraphWidget::~CGraphWidget()
 	{
+		// Layers may call Update while being destroyed, which looks up their group
+		m_LayerGroups.clear();
+		m_Layers.clear();
 	}
 
 	void CGraphWidget::SetDelegate(IGraphWidgetDelegate* dlgt)
@@ -155,6 +169,7 @@ namespace jass
 	void CGraphWidget::InsertLayer(size_t index, std::unique_ptr<CGraphLayer>&& layer)
 	{
 		m_Layers.insert(m_Layers.begin() + index, std::move(layer));
+		RebuildLayerGroups();
 	}
 
 	void CGraphWidget::AppendLayer(std::unique_ptr<CGraphLayer>&& layer)
@@ -167,9 +182,61 @@ namespace jass
 		auto it = m_Layers.begin() + index;
 		auto layer = std::move(*it);
 		m_Layers.erase(it);
+		RebuildLayerGroups();
+		update();
 		return std::move(layer);
 	}
 
+	void CGraphWidget::UpdateLayer(const CGraphLayer& layer, const QRect& rc)
+	{
+		// Layers rebuild their geometry when the view changes, but what they draw stays the same,
+		// so tiles cached at other zoom levels remain valid
+		if (!m_NotifyingViewChanged)
+		{
+			if (auto* group = FindLayerGroup(layer))
+			{
+				group->TileCache->Invalidate(rc.translated(-m_ScreenTranslation), m_ScreenToModelScale);
+			}
+		}
+		ScheduleRepaint(rc);
+	}
+
+	void CGraphWidget::UpdateLayer(const CGraphLayer& layer)
+	{
+		if (!m_NotifyingViewChanged)
+		{
+			if (auto* group = FindLayerGroup(layer))
+			{
+				group->TileCache->InvalidateAll(m_ScreenToModelScale);
+			}
+		}
+		ScheduleRepaint(rect());
+	}
+
+	void CGraphWidget::ScheduleRepaint(const QRect& rc)
+	{
+		if (rc.isEmpty())
+		{
+			return;
+		}
+
+		const auto* scr = screen();
+		const qreal refresh_rate = (scr && scr->refreshRate() > 0) ? scr->refreshRate() : 60;
+		const auto frame_interval_ms = (qint64)(1000 / refresh_rate);
+		const auto elapsed_ms = m_SinceLastPaint.isValid() ? m_SinceLastPaint.elapsed() : frame_interval_ms;
+		if (elapsed_ms >= frame_interval_ms && !m_RepaintTimer->isActive())
+		{
+			update(rc);
+			return;
+		}
+
+		m_PendingRepaint += rc;
+		if (!m_RepaintTimer->isActive())
+		{
+			m_RepaintTimer->start((int)std::max<qint64>(0, frame_interval_ms - elapsed_ms));
+		}
+	}
+
 	void CGraphWidget::SetScreenTranslation(const QPoint& translation)
 	{
 		m_ScreenTranslation = translation;
@@ -182,6 +249,30 @@ namespace jass
 		m_ModelToScreenScale = 1.0f / scale;
 	}
 
+	void CGraphWidget::SetLevelOfDetailThresholds(const SLevelOfDetailThresholds& thresholds)
+	{
+		m_LevelOfDetailThresholds = thresholds;
+		for (auto& group : m_LayerGroups)
+		{
+			group.TileCache->Clear();
+		}
+		update();
+	}
+
+	ELevelOfDetail CGraphWidget::LevelOfDetail(qreal model_spacing) const
+	{
+		const auto screen_spacing = model_spacing * m_ModelToScreenScale;
+		if (screen_spacing < m_LevelOfDetailThresholds.MinimalBelow)
+		{
+			return ELevelOfDetail::Minimal;
+		}
+		if (screen_spacing < m_LevelOfDetailThresholds.ReducedBelow)
+		{
+			return ELevelOfDetail::Reduced;
+		}
+		return ELevelOfDetail::Full;
+	}
+
 	void CGraphWidget::SetInputProcessor(CInputEventProcessor* input_processor)
 	{
 		m_InputProcessor = input_processor;
@@ -196,9 +287,48 @@ namespace jass
 		painter.setBrush(Qt::white);
 		painter.drawRect(rect());
 
-		for (size_t layer_index = 0; layer_index < m_Layers.size(); ++layer_index)
+		m_SinceLastPaint.start();
+
+		const auto& rc = event->rect();
+		const auto region = event->region().translated(-m_ScreenTranslation);
+		auto group_it = m_LayerGroups.begin();
+		for (size_t layer_index = 0; layer_index < m_Layers.size(); )
 		{
-			m_Layers[layer_index]->Paint(painter, event->rect());
+			if (group_it == m_LayerGroups.end() || group_it->FirstLayer != layer_index)
+			{
+				m_Layers[layer_index]->Paint(painter, rc);
+				m_Layers[layer_index]->PaintOverlay(painter, rc);
+				++layer_index;
+				continue;
+			}
+
+			const auto& group = *group_it++;
+			group.TileCache->Paint(painter, region, m_ScreenTranslation, m_ScreenToModelScale, devicePixelRatioF(),
+				[&](QPainter& tile_painter, const QRect& rc_tile)
+				{
+					for (size_t i = group.FirstLayer; i < group.FirstLayer + group.LayerCount; ++i)
+					{
+						m_Layers[i]->Paint(tile_painter, rc_tile);
+					}
+				},
+				[&](const QRect& rc_snapshot, CTileRenderWorker::snapshots_t& out_snapshots)
+				{
+					for (size_t i = group.FirstLayer; i < group.FirstLayer + group.LayerCount; ++i)
+					{
+						auto snapshot = m_Layers[i]->Snapshot(rc_snapshot);
+						if (!snapshot)
+						{
+							return false;
+						}
+						out_snapshots.push_back(std::move(snapshot));
+					}
+					return true;
+				});
+			for (size_t i = group.FirstLayer; i < group.FirstLayer + group.LayerCount; ++i)
+			{
+				m_Layers[i]->PaintOverlay(painter, rc);
+			}
+			layer_index += group.LayerCount;
 		}
 	}
 
@@ -228,7 +358,7 @@ namespace jass
 							const auto screen_space_translation_f = (ModelTranslation() + model_space_delta) * ModelToScreenScale();
 							SetScreenTranslation(QPointFromRoundedQPointF(screen_space_translation_f));
 
-							NotifyViewChanged();
+							NotifyViewChanged(EViewChange::Scale);
 
 							update();
 						}
@@ -261,6 +391,7 @@ namespace jass
 					const auto delta = mouseEvent.pos() - m_MouseRef;
 					m_MouseRef = mouseEvent.pos();
 					SetScreenTranslation(m_ScreenTranslation + delta);
+					NotifyViewChanged(EViewChange::Translation);
 					update();
 				}
 				break;
@@ -286,12 +417,72 @@ namespace jass
 
 	}
 
-	void CGraphWidget::NotifyViewChanged()
+	void CGraphWidget::OnTileFrameRendered()
+	{
+		CTileRenderWorker::SFrame frame;
+		while (m_TileRenderWorker->TryGrabRendered(frame))
+		{
+			// Caches may have been replaced since the frame was submitted
+			for (auto& group : m_LayerGroups)
+			{
+				if (group.TileCache.get() == frame.Owner)
+				{
+					const auto rc_updated = group.TileCache->ApplyRenderedFrame(frame);
+					if (!rc_updated.isEmpty())
+					{
+						update(rc_updated.translated(m_ScreenTranslation));
+					}
+				}
+			}
+		}
+	}
+
+	void CGraphWidget::OnRepaintTimer()
+	{
+		update(m_PendingRepaint);
+		m_PendingRepaint = QRegion();
+	}
+
+	void CGraphWidget::NotifyViewChanged(EViewChange change)
 	{
+		m_NotifyingViewChanged = true;
 		for (auto& layer : m_Layers)
 		{
-			layer->OnViewChanged(rect(), ScreenToModelScale());
+			layer->OnViewChanged(rect(), ScreenToModelScale(), change);
+		}
+		m_NotifyingViewChanged = false;
+	}
+
+	void CGraphWidget::RebuildLayerGroups()
+	{
+		m_LayerGroups.clear();
+		for (size_t layer_index = 0; layer_index < m_Layers.size(); ++layer_index)
+		{
+			if (!m_Layers[layer_index]->CanCachePaint())
+			{
+				continue;
+			}
+			if (m_LayerGroups.empty() || m_LayerGroups.back().FirstLayer + m_LayerGroups.back().LayerCount != layer_index)
+			{
+				m_LayerGroups.push_back({ layer_index, 0, std::make_unique<CTileCache>(m_TileRenderWorker.get()) });
+			}
+			++m_LayerGroups.back().LayerCount;
+		}
+	}
+
+	CGraphWidget::SLayerGroup* CGraphWidget::FindLayerGroup(const CGraphLayer& layer)
+	{
+		for (auto& group : m_LayerGroups)
+		{
+			for (size_t layer_index = group.FirstLayer; layer_index < group.FirstLayer + group.LayerCount; ++layer_index)
+			{
+				if (m_Layers[layer_index].get() == &layer)
+				{
+					return &group;
+				}
+			}
 		}
+		return nullptr;
 	}
 
 	void CGraphWidget::UpdateTooltip(const QMouseEvent& event)
@@ -19,8 +19,11 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <memory>
 #include <stack>
 #include <vector>
+#include <QtCore/qelapsedtimer.h>
+#include <QtGui/qregion.h>
 #include <QtWidgets/qwidget.h>
 #include <jass/ui/InputEventProcessor.h>
 #include <jass/utils/bitvec.h>
@@ -32,6 +35,29 @@ namespace jass
 {
 	class bitvec;
 	class CGraphWidget;
+	class CTileCache;
+	class CTileRenderWorker;
+
+	// How much detail layers draw elements with. Elements that are closer together on screen than
+	// the thresholds of the widget would overlap anyway, and are drawn simplified.
+	enum class ELevelOfDetail
+	{
+		Full,     // Sprites and antialiased lines
+		Reduced,  // Small flat squares and aliased hairlines
+		Minimal,  // Single pixels, with elements on the same pixel merged
+	};
+
+	enum class EViewChange
+	{
+		Translation,  // Panned, screen positions shifted by the same offset
+		Scale,        // Zoomed, possibly also translated
+	};
+
+	struct SLevelOfDetailThresholds
+	{
+		float ReducedBelow = 6;     // Screen pixels between neighbouring nodes
+		float MinimalBelow = 1.5f;
+	};
 
 	class CGraphLayerContext
 	{
@@ -44,6 +70,16 @@ namespace jass
 		QWidget& m_Widget;
 	};
 
+	// Copy of what a layer paints in some region, which can be painted on the render thread while
+	// the layer goes on changing
+	class IGraphLayerSnapshot
+	{
+	public:
+		virtual ~IGraphLayerSnapshot() {}
+		// 'rc' is in screen coordinates of the view the snapshot was taken in
+		virtual void Paint(QPainter& painter, const QRect& rc) const = 0;
+	};
+
 	class CGraphLayer
 	{
 	public:
@@ -54,12 +90,22 @@ namespace jass
 		virtual ~CGraphLayer() {}
 
 		virtual void Paint(QPainter& painter, const QRect& rc) {}
+		// Painted on top of Paint, for content that changes too often to be cached, such as tool
+		// feedback. Report changes with UpdateOverlay.
+		virtual void PaintOverlay(QPainter& painter, const QRect& rc) {}
+		// True if everything Paint draws is reported with Update when it changes, so that the widget
+		// may keep the output in a tile cache instead of calling Paint every frame.
+		virtual bool CanCachePaint() const { return false; }
+		// For layers that can cache their paint output, a snapshot of what Paint draws in 'rc', so
+		// that the tiles can be rendered on the render thread. Returns null to be painted on the UI
+		// thread instead.
+		virtual std::shared_ptr<const IGraphLayerSnapshot> Snapshot(const QRect& rc) { return nullptr; }
 		virtual element_t HitTest(const QPoint& pt) { return NO_ELEMENT; }
 		virtual bool RangedHitTest(const QRect& rc, bitvec& out_hit_elements) const { return false; }
 		virtual void SetHilighted(element_t edge, bool hilighted) {}
 		virtual void GetSelection(bitvec& out_selection_mask) const { out_selection_mask.clear(); }
 		virtual void SetSelection(const bitvec& selection_mask) const { }
-		virtual void OnViewChanged(const QRect& rc, float screen_to_model_scale) {}
+		virtual void OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change) {}
 		
 		virtual bool CanMoveElements() const { return false; }
 		virtual void BeginMoveElements(const bitvec& element_mask) {}
@@ -68,6 +114,7 @@ namespace jass
 
 		inline void Update();
 		inline void Update(const QRect& rc);
+		inline void UpdateOverlay(const QRect& rc);
 
 		inline CGraphWidget& GraphWidget() { return m_GraphWidget; }
 		inline const CGraphWidget& GraphWidget() const { return m_GraphWidget; }
@@ -111,6 +158,13 @@ namespace jass
 
 		std::unique_ptr<CGraphLayer> RemoveLayer(size_t index);
 
+		// Repaints 'rc', and re-renders it in the tile cache of the layer
+		void UpdateLayer(const CGraphLayer& layer, const QRect& rc);
+		void UpdateLayer(const CGraphLayer& layer);
+
+		// Repaints 'rc', but no more often than the display refreshes. Requests arriving in between are merged.
+		void ScheduleRepaint(const QRect& rc);
+
 		inline const QPoint& ScreenTranslation() const;
 		inline const QPointF& ModelTranslation() const;
 		void SetScreenTranslation(const QPoint& translation);
@@ -119,6 +173,12 @@ namespace jass
 		inline float ModelToScreenScale() const;
 		void SetScreenToModelScale(float scale);  // 2 --> 200% zoom
 
+		void SetLevelOfDetailThresholds(const SLevelOfDetailThresholds& thresholds);
+		inline const SLevelOfDetailThresholds& LevelOfDetailThresholds() const { return m_LevelOfDetailThresholds; }
+
+		// Level of detail for drawing elements that are 'model_spacing' apart in model space
+		ELevelOfDetail LevelOfDetail(qreal model_spacing) const;
+
 		inline QPointF ScreenFromModel(const QPointF& pt_model) const;
 		inline QPointF ModelFromScreen(const QPoint& pt_screen) const;
 		inline QPointF ModelFromScreen(const QPointF& pt_screen) const;
@@ -134,6 +194,8 @@ namespace jass
 
 	private Q_SLOTS:
 		void OnTooltipTimer();
+		void OnTileFrameRendered();
+		void OnRepaintTimer();
 
 	private:
 		enum class EState
@@ -142,7 +204,19 @@ namespace jass
 			Panning,
 		};
 
-		void NotifyViewChanged();
+		// Consecutive layers that can cache their paint output share a tile cache
+		struct SLayerGroup
+		{
+			size_t FirstLayer;
+			size_t LayerCount;
+			std::unique_ptr<CTileCache> TileCache;
+		};
+
+		void NotifyViewChanged(EViewChange change);
+
+		void RebuildLayerGroups();
+
+		SLayerGroup* FindLayerGroup(const CGraphLayer& layer);
 
 		void UpdateTooltip(const QMouseEvent& event);
 
@@ -153,13 +227,20 @@ namespace jass
 		IGraphWidgetDelegate* m_Delegate = nullptr;
 		CInputEventProcessor* m_InputProcessor = nullptr;
 		std::vector<std::unique_ptr<CGraphLayer>> m_Layers;
+		std::unique_ptr<CTileRenderWorker> m_TileRenderWorker;  // Outlives the tile caches
+		std::vector<SLayerGroup> m_LayerGroups;
+		bool m_NotifyingViewChanged = false;
 		uint8_t m_ZoomLevel;
 		QPoint m_ScreenTranslation;
 		QPointF m_ModelTranslation;
 		float m_ScreenToModelScale = 1;
 		float m_ModelToScreenScale = 1;
+		SLevelOfDetailThresholds m_LevelOfDetailThresholds;
 		EState m_State = EState::Idle;
 		QPoint m_MouseRef;
+		QTimer* m_RepaintTimer = nullptr;
+		QElapsedTimer m_SinceLastPaint;
+		QRegion m_PendingRepaint;
 
 		struct SToolTip
 		{
@@ -218,6 +299,7 @@ namespace jass
 
 	// CGraphLayer Implementation
 
-	inline void CGraphLayer::Update() { m_GraphWidget.update(); }
-	inline void CGraphLayer::Update(const QRect& rc) { m_GraphWidget.update(rc); }
+	inline void CGraphLayer::Update() { m_GraphWidget.UpdateLayer(*this); }
+	inline void CGraphLayer::Update(const QRect& rc) { m_GraphWidget.UpdateLayer(*this, rc); }
+	inline void CGraphLayer::UpdateOverlay(const QRect& rc) { m_GraphWidget.ScheduleRepaint(rc); }
 }
\ No newline at end of file
@@ -17,20 +17,228 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cmath>
 #include <QtGui/qpainter.h>
+#include <jass/Debug.h>
 #include "ImageGraphLayer.hpp"
 
 namespace jass
 {
-	void CImageGraphLayer::SetImage(QPixmap&& image)
+	// Calls 'fn(level_index, tile_index, rc_tile_model)' for the tiles intersecting 'rc_model', of the
+	// smallest level that still has at least one pixel per device pixel
+	template <class TFunc>
+	static void ForEachVisibleTile(const CImagePyramid& pyramid, const QRectF& rc_model, qreal image_pixels_per_device_pixel, TFunc&& fn)
 	{
-		m_Image = std::move(image);
+		size_t level_index = 0;
+		while (level_index + 1 < pyramid.LevelCount() && pyramid.Level(level_index + 1).Scale.width() <= image_pixels_per_device_pixel)
+		{
+			++level_index;
+		}
+		const auto& level = pyramid.Level(level_index);
+
+		const auto tile_model_width = CImagePyramid::TILE_SIZE * level.Scale.width();
+		const auto tile_model_height = CImagePyramid::TILE_SIZE * level.Scale.height();
+		const auto column_begin = std::max(0, (int)std::floor(rc_model.left() / tile_model_width));
+		const auto column_end = std::min(level.Columns, (int)std::floor(rc_model.right() / tile_model_width) + 1);
+		const auto row_begin = std::max(0, (int)std::floor(rc_model.top() / tile_model_height));
+		const auto row_end = std::min(level.Rows, (int)std::floor(rc_model.bottom() / tile_model_height) + 1);
+		for (int row = row_begin; row < row_end; ++row)
+		{
+			for (int column = column_begin; column < column_end; ++column)
+			{
+				fn(level_index, (size_t)row * level.Columns + column, pyramid.TileRect(level_index, column, row));
+			}
+		}
+	}
+
+	// Draws the pyramid tiles as images, which unlike pixmaps can be drawn on any thread. The
+	// pyramid never changes once built.
+	class CImageGraphLayer::CSnapshot: public IGraphLayerSnapshot
+	{
+	public:
+		CSnapshot(std::shared_ptr<const CImagePyramid> pyramid, const CGraphWidget& graph_widget)
+			: m_Pyramid(std::move(pyramid))
+			, m_ScreenToModelScale(graph_widget.ScreenToModelScale())
+			, m_ModelToScreenScale(graph_widget.ModelToScreenScale())
+			, m_ModelTranslation(graph_widget.ModelTranslation())
+		{
+		}
+
+		void Paint(QPainter& painter, const QRect& rc) const override
+		{
+			if (!m_Pyramid)
+			{
+				return;
+			}
+
+			// Same mapping as CGraphWidget::ModelFromScreen and ScreenFromModel
+			const QRectF rc_model(QPointF(rc.topLeft()) * m_ScreenToModelScale - m_ModelTranslation, QSizeF(rc.size()) * m_ScreenToModelScale);
+			painter.setRenderHint(QPainter::SmoothPixmapTransform);
+			ForEachVisibleTile(*m_Pyramid, rc_model, m_ScreenToModelScale / painter.device()->devicePixelRatioF(), [&](size_t level_index, size_t tile_index, const QRectF& rc_tile_model)
+				{
+					const QRectF rc_tile_screen((rc_tile_model.topLeft() + m_ModelTranslation) * m_ModelToScreenScale, rc_tile_model.size() * m_ModelToScreenScale);
+					const auto& image = m_Pyramid->Level(level_index).Tiles[tile_index];
+					painter.drawImage(rc_tile_screen, image, QRectF(image.rect()));
+				});
+		}
+
+	private:
+		std::shared_ptr<const CImagePyramid> m_Pyramid;
+		qreal m_ScreenToModelScale;
+		qreal m_ModelToScreenScale;
+		QPointF m_ModelTranslation;
+	};
+
+	CImageGraphLayer::CImageGraphLayer(CGraphWidget& graphWidget)
+		: CGraphLayer(graphWidget)
+	{
+		VERIFY(connect(this, &CImageGraphLayer::PyramidBuilt, this, &CImageGraphLayer::OnPyramidBuilt));
+	}
+
+	CImageGraphLayer::~CImageGraphLayer()
+	{
+		m_CancelBuild = true;
+		if (m_BuildResult.valid())
+		{
+			m_BuildResult.wait();
+		}
+	}
+
+	void CImageGraphLayer::SetImageData(const QByteArray& image_data)
+	{
+		m_CancelBuild = true;
+		if (m_BuildResult.valid())
+		{
+			m_BuildResult.wait();
+		}
+		m_CancelBuild = false;
+
+		{
+			// Drop a result that hasn't been picked up yet
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_BuiltPyramid.reset();
+		}
+
+		m_Pyramid.reset();
+		m_Tiles.clear();
+		m_UploadedByteCount = 0;
+		Update();
+
+		if (image_data.isEmpty())
+		{
+			return;
+		}
+
+		m_BuildResult = std::async(std::launch::async, [this, image_data]()
+			{
+				auto pyramid = CImagePyramid::Build(image_data, m_CancelBuild);
+				if (!pyramid)
+				{
+					return;
+				}
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					m_BuiltPyramid = std::move(pyramid);
+				}
+				emit PyramidBuilt();
+			});
+	}
+
+	void CImageGraphLayer::OnPyramidBuilt()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			if (!m_BuiltPyramid)
+			{
+				return;
+			}
+			m_Pyramid = std::move(m_BuiltPyramid);
+		}
+
+		m_Tiles.resize(m_Pyramid->LevelCount());
+		for (size_t level_index = 0; level_index < m_Pyramid->LevelCount(); ++level_index)
+		{
+			m_Tiles[level_index].resize(m_Pyramid->Level(level_index).Tiles.size());
+		}
 		Update();
 	}
 
 	void CImageGraphLayer::Paint(QPainter& painter, const QRect& rc)
 	{
+		if (!m_Pyramid)
+		{
+			return;
+		}
+
+		++m_PaintCount;
+
 		painter.setRenderHint(QPainter::SmoothPixmapTransform);
-		painter.drawPixmap(QRectF(rc), m_Image, GraphWidget().ModelFromScreen(rc));
+		const auto image_pixels_per_device_pixel = GraphWidget().ScreenToModelScale() / painter.device()->devicePixelRatioF();
+		ForEachVisibleTile(*m_Pyramid, GraphWidget().ModelFromScreen(rc), image_pixels_per_device_pixel, [&](size_t level_index, size_t tile_index, const QRectF& rc_tile_model)
+			{
+				const QRectF rc_tile_screen(GraphWidget().ScreenFromModel(rc_tile_model.topLeft()), GraphWidget().ScreenFromModel(rc_tile_model.bottomRight()));
+				const auto& pixmap = TilePixmap(level_index, tile_index);
+				painter.drawPixmap(rc_tile_screen, pixmap, QRectF(pixmap.rect()));
+			});
+
+		if (m_UploadedByteCount > MAX_UPLOADED_BYTE_COUNT)
+		{
+			EvictTiles();
+		}
 	}
-}
\ No newline at end of file
+
+	std::shared_ptr<const IGraphLayerSnapshot> CImageGraphLayer::Snapshot(const QRect& rc)
+	{
+		return std::make_shared<CSnapshot>(m_Pyramid, GraphWidget());
+	}
+
+	const QPixmap& CImageGraphLayer::TilePixmap(size_t level_index, size_t tile_index)
+	{
+		auto& tile = m_Tiles[level_index][tile_index];
+		if (tile.Pixmap.isNull())
+		{
+			const auto& image = m_Pyramid->Level(level_index).Tiles[tile_index];
+			tile.Pixmap = QPixmap::fromImage(image);
+			m_UploadedByteCount += (size_t)image.sizeInBytes();
+		}
+		tile.LastUsed = m_PaintCount;
+		return tile.Pixmap;
+	}
+
+	void CImageGraphLayer::EvictTiles()
+	{
+		// Least recently drawn first, but never what the current paint drew
+		struct SCandidate
+		{
+			uint64_t LastUsed;
+			size_t   Level;
+			size_t   Tile;
+		};
+		std::vector<SCandidate> candidates;
+		for (size_t level_index = 0; level_index < m_Tiles.size(); ++level_index)
+		{
+			for (size_t tile_index = 0; tile_index < m_Tiles[level_index].size(); ++tile_index)
+			{
+				const auto& tile = m_Tiles[level_index][tile_index];
+				if (!tile.Pixmap.isNull() && tile.LastUsed != m_PaintCount)
+				{
+					candidates.push_back({ tile.LastUsed, level_index, tile_index });
+				}
+			}
+		}
+		std::sort(candidates.begin(), candidates.end(), [](const SCandidate& a, const SCandidate& b) { return a.LastUsed < b.LastUsed; });
+
+		for (const auto& candidate : candidates)
+		{
+			if (m_UploadedByteCount <= MAX_UPLOADED_BYTE_COUNT)
+			{
+				break;
+			}
+			m_Tiles[candidate.Level][candidate.Tile].Pixmap = QPixmap();
+			m_UploadedByteCount -= (size_t)m_Pyramid->Level(candidate.Level).Tiles[candidate.Tile].sizeInBytes();
+		}
+	}
+}
+
+#include <moc_ImageGraphLayer.cpp>
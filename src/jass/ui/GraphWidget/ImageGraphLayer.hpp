@@ -19,25 +19,63 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <vector>
+#include <QtCore/qobject.h>
 #include <QtGui/qpixmap.h>
 
 #include "GraphWidget.hpp"
+#include "ImagePyramid.h"
 
 namespace jass
 {
-	class CImageGraphLayer: public CGraphLayer
+	class CImageGraphLayer: public QObject, public CGraphLayer
 	{
+		Q_OBJECT
 	public:
-		CImageGraphLayer(CGraphWidget& graphWidget) : CGraphLayer(graphWidget) {}
+		CImageGraphLayer(CGraphWidget& graphWidget);
+		~CImageGraphLayer();
 
-		void SetImage(QPixmap&& image);
-		inline QPixmap& Image() { return m_Image; }
+		// The image is decoded and its pyramid built on a background thread. Until then, and if the
+		// image can't be decoded, nothing is drawn.
+		void SetImageData(const QByteArray& image_data);
 
 		// CGraphLayer overrides
 		void Paint(QPainter& painter, const QRect& rc) override;
+		bool CanCachePaint() const override { return true; }
+		std::shared_ptr<const IGraphLayerSnapshot> Snapshot(const QRect& rc) override;
+
+	Q_SIGNALS:
+		void PyramidBuilt();
+
+	private Q_SLOTS:
+		void OnPyramidBuilt();
 
 	private:
-		QPixmap m_Image;
+		static const size_t MAX_UPLOADED_BYTE_COUNT = 128 * 1024 * 1024;
+
+		class CSnapshot;
+
+		struct STile
+		{
+			QPixmap  Pixmap;  // Created from the pyramid tile when first visible
+			uint64_t LastUsed = 0;
+		};
+
+		const QPixmap& TilePixmap(size_t level_index, size_t tile_index);
+		void EvictTiles();
+
+		std::shared_ptr<const CImagePyramid> m_Pyramid;
+		std::vector<std::vector<STile>> m_Tiles;  // Per level
+		size_t m_UploadedByteCount = 0;
+		uint64_t m_PaintCount = 0;
+
+		std::future<void> m_BuildResult;
+		std::atomic<bool> m_CancelBuild = false;
+		std::mutex m_Mutex;
+		std::shared_ptr<const CImagePyramid> m_BuiltPyramid;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,66 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ImagePyramid.h"
+
+namespace jass
+{
+	std::shared_ptr<CImagePyramid> CImagePyramid::Build(const QByteArray& image_data, const std::atomic<bool>& cancel)
+	{
+		QImage image;
+		if (!image.loadFromData(image_data) || image.isNull())
+		{
+			return nullptr;
+		}
+		image.convertTo(QImage::Format_ARGB32_Premultiplied);
+
+		auto pyramid = std::make_shared<CImagePyramid>();
+		const auto full_size = image.size();
+		while (true)
+		{
+			if (cancel)
+			{
+				return nullptr;
+			}
+
+			SLevel level;
+			level.Size = image.size();
+			level.Scale = QSizeF((qreal)full_size.width() / level.Size.width(), (qreal)full_size.height() / level.Size.height());
+			level.Columns = (level.Size.width() + TILE_SIZE - 1) / TILE_SIZE;
+			level.Rows = (level.Size.height() + TILE_SIZE - 1) / TILE_SIZE;
+			level.Tiles.reserve((size_t)level.Columns * level.Rows);
+			for (int row = 0; row < level.Rows; ++row)
+			{
+				for (int column = 0; column < level.Columns; ++column)
+				{
+					level.Tiles.push_back(image.copy(QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE).intersected(image.rect())));
+				}
+			}
+			pyramid->m_Levels.push_back(std::move(level));
+
+			if (image.width() <= TILE_SIZE && image.height() <= TILE_SIZE)
+			{
+				break;
+			}
+			image = image.scaled((image.width() + 1) / 2, (image.height() + 1) / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		}
+
+		return pyramid;
+	}
+}
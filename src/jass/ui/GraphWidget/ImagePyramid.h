@@ -0,0 +1,70 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qrect.h>
+#include <QtGui/qimage.h>
+
+namespace jass
+{
+	// An image, and copies of it halved in size down to a single tile, split into tiles. Lets
+	// views at any zoom be drawn from about as many image pixels as they cover on screen.
+	class CImagePyramid
+	{
+	public:
+		static constexpr int TILE_SIZE = 512;
+
+		struct SLevel
+		{
+			QSize  Size;
+			QSizeF Scale;  // Full size image pixels per pixel of this level
+			int    Columns;
+			int    Rows;
+			std::vector<QImage> Tiles;  // Row by row
+		};
+
+		// Decodes the image and builds the levels. Safe to call from any thread. Returns null if
+		// the image could not be decoded, or if 'cancel' got set.
+		static std::shared_ptr<CImagePyramid> Build(const QByteArray& image_data, const std::atomic<bool>& cancel);
+
+		inline QSize Size() const { return m_Levels.front().Size; }
+
+		inline size_t LevelCount() const { return m_Levels.size(); }
+
+		inline const SLevel& Level(size_t level_index) const { return m_Levels[level_index]; }
+
+		// Rect of a tile in full size image pixels
+		inline QRectF TileRect(size_t level_index, int column, int row) const;
+
+	private:
+		std::vector<SLevel> m_Levels;
+	};
+
+	inline QRectF CImagePyramid::TileRect(size_t level_index, int column, int row) const
+	{
+		const auto& level = m_Levels[level_index];
+		const QRect rc_tile = QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE).intersected(QRect(QPoint(0, 0), level.Size));
+		return QRectF(rc_tile.x() * level.Scale.width(), rc_tile.y() * level.Scale.height(), rc_tile.width() * level.Scale.width(), rc_tile.height() * level.Scale.height());
+	}
+}
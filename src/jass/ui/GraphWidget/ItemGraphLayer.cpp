@@ -29,6 +29,8 @@ namespace jass
 
 	void CItemGraphLayer::Paint(QPainter& painter, const QRect& rcClip)
 	{
+		const auto translation = GraphWidget().ScreenTranslation();
+		m_MaxItemSize = QSize(0, 0);
 		for (size_t item_index = 0; item_index < m_Items.size(); ++item_index)
 		{
 			const auto itemRect = ItemRect(item_index);
@@ -37,15 +39,32 @@ namespace jass
 			{
 				DrawItem(item_index, painter, itemRect);
 			}
-			m_Items[item_index].LastRect = itemRect;
+			m_Items[item_index].LastRect = itemRect.translated(-translation);
+			m_MaxItemSize = m_MaxItemSize.expandedTo(itemRect.size());
 		}
 	}
 
 	CItemGraphLayer::element_t CItemGraphLayer::HitTest(const QPoint& pt)
 	{
+		const auto pt_content = pt - GraphWidget().ScreenTranslation();
+
+		// Topmost item wins, which is the one drawn last
+		element_t hit_item = NO_ELEMENT;
+		const auto any_candidates = ForEachItemCandidate(QRect(pt, QSize(1, 1)), [&](element_t item_index)
+			{
+				if (item_index < m_Items.size() && m_Items[item_index].LastRect.contains(pt_content) && (NO_ELEMENT == hit_item || item_index > hit_item))
+				{
+					hit_item = item_index;
+				}
+			});
+		if (any_candidates)
+		{
+			return hit_item;
+		}
+
 		for (size_t item_index = m_Items.size() - 1; item_index < m_Items.size(); --item_index)
 		{
-			if (m_Items[item_index].LastRect.contains(pt))
+			if (m_Items[item_index].LastRect.contains(pt_content))
 			{
 				return item_index;
 			}
@@ -55,12 +74,27 @@ namespace jass
 
 	bool CItemGraphLayer::RangedHitTest(const QRect& rc, bitvec& out_hit_elements) const
 	{
+		const auto rc_content = rc.translated(-GraphWidget().ScreenTranslation());
+
 		bool any_hit = false;
 		out_hit_elements.clear();
 		out_hit_elements.resize(m_Items.size());
+		const auto any_candidates = ForEachItemCandidate(rc, [&](element_t item_index)
+			{
+				if (item_index < m_Items.size() && rc_content.intersects(m_Items[item_index].LastRect))
+				{
+					out_hit_elements.set(item_index);
+					any_hit = true;
+				}
+			});
+		if (any_candidates)
+		{
+			return any_hit;
+		}
+
 		for (size_t item_index = 0; item_index < m_Items.size(); ++item_index)
 		{
-			if (rc.intersects(m_Items[item_index].LastRect))
+			if (rc_content.intersects(m_Items[item_index].LastRect))
 			{
 				out_hit_elements.set(item_index);
 				any_hit = true;
@@ -69,6 +103,11 @@ namespace jass
 		return any_hit;
 	}
 
+	bool CItemGraphLayer::ForEachItemCandidate(const QRect& rc, const std::function<void(element_t)>& fn) const
+	{
+		return false;
+	}
+
 	void CItemGraphLayer::ClearItems()
 	{
 		if (m_Items.empty())
@@ -92,4 +131,23 @@ namespace jass
 
 		Update();
 	}
+
+	void CItemGraphLayer::UpdateItemRects()
+	{
+		const auto translation = GraphWidget().ScreenTranslation();
+		m_MaxItemSize = QSize(0, 0);
+		for (size_t item_index = 0; item_index < m_Items.size(); ++item_index)
+		{
+			const auto itemRect = ItemRect(item_index);
+			m_Items[item_index].LastRect = itemRect.translated(-translation);
+			m_MaxItemSize = m_MaxItemSize.expandedTo(itemRect.size());
+		}
+	}
+
+	void CItemGraphLayer::UpdateItemRect(element_t element)
+	{
+		const auto itemRect = ItemRect(element);
+		m_Items[element].LastRect = itemRect.translated(-GraphWidget().ScreenTranslation());
+		m_MaxItemSize = m_MaxItemSize.expandedTo(itemRect.size());
+	}
 }
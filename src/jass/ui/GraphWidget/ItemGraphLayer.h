@@ -19,6 +19,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <functional>
 #include <vector>
 #include "GraphWidget.hpp"
 
@@ -34,7 +35,7 @@ namespace jass
 		virtual QRect ItemRect(element_t element) const = 0;
 		virtual void DrawItem(element_t element, QPainter& painter, const QRect& rc) const = 0;
 
-		inline const QRect& LastItemRect(element_t element) const;
+		inline QRect LastItemRect(element_t element) const;
 
 		// CGraphLayer overrides
 		void      Paint(QPainter& painter, const QRect& rc) override;
@@ -45,17 +46,33 @@ namespace jass
 		void ClearItems();
 		void InsertItems(size_t index, size_t count);
 
+		// Sets the last rect of every item to its current rect. Paint may be skipped while the
+		// widget draws cached content, so call this when the view changes.
+		void UpdateItemRects();
+
+		// Sets the last rect of one item to its current rect, for layers that keep them up to date
+		// as items change instead of calling UpdateItemRects every paint
+		void UpdateItemRect(element_t element);
+
+		// Override to speed up hit tests. Should call fn for every item that may have been drawn
+		// intersecting 'rc', and return true. Returning false tests every item.
+		virtual bool ForEachItemCandidate(const QRect& rc, const std::function<void(element_t)>& fn) const;
+
+		// Largest item drawn by last Paint
+		inline const QSize& MaxItemSize() const { return m_MaxItemSize; }
+
 	private:
 		struct SItem
 		{
-			QRect LastRect;  // Rect of last time it was drawn
+			QRect LastRect;  // Rect of last time it was drawn, in content coordinates (without view translation)
 		};
 
 		std::vector<SItem> m_Items;
+		QSize m_MaxItemSize;
 	};
 
-	inline const QRect& CItemGraphLayer::LastItemRect(element_t element) const
+	inline QRect CItemGraphLayer::LastItemRect(element_t element) const
 	{
-		return m_Items[element].LastRect;
+		return m_Items[element].LastRect.translated(GraphWidget().ScreenTranslation());
 	}
 }
\ No newline at end of file
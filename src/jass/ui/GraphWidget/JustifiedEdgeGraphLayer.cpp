@@ -24,9 +24,11 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <jass/math/Geometry.h>
 #include <jass/ui/ImageFx.h>
 #include <jass/Debug.h>
+#include <jass/GraphEditor/JustifiedGraph.h>
 #include <jass/GraphModel.hpp>
 
 #include "JustifiedEdgeGraphLayer.hpp"
+#include "DamageRects.h"
 
 namespace jass
 {
@@ -44,21 +46,27 @@ namespace jass
 		connect(&graph_model, &CGraphModel::EdgesInserted, this, &CJustifiedEdgeGraphLayer::OnEdgesInserted);
 		connect(&graph_model, &CGraphModel::EdgesRemoved, this, &CJustifiedEdgeGraphLayer::OnEdgesRemoved);
 		connect(&graph_model, &CGraphModel::NodesModified, this, &CJustifiedEdgeGraphLayer::OnNodesModified);
+		connect(&graph_model, &CGraphModel::Changed, this, &CJustifiedEdgeGraphLayer::OnGraphChanged);
 		
 		Reset();
 	}
 
 	void CJustifiedEdgeGraphLayer::Paint(QPainter& painter, const QRect& rcClip)
 	{
+		const auto level_of_detail = GraphWidget().LevelOfDetail(JUSTIFIED_GRAPH_SPACING);
+		const bool full_detail = (ELevelOfDetail::Full == level_of_detail);
+
 		QPen penNormal(COLOR_NORMAL);
-		penNormal.setWidth(m_LineWidth);
+		penNormal.setWidth(full_detail ? m_LineWidth : 1);
 		painter.setPen(penNormal);
 
-		painter.setRenderHint(QPainter::Antialiasing);
+		painter.setRenderHint(QPainter::Antialiasing, full_detail);
 
 		const int inflateAmount = m_LineWidth + 2;
 		const auto rcIntersect = QRectF(rcClip.adjusted(-inflateAmount, -inflateAmount, +inflateAmount, +inflateAmount));
 
+		const auto translation = GraphWidget().ScreenTranslation();
+		m_TempLines.clear();
 		QPoint p0, p1;
 		for (size_t edge_index = 0; edge_index < m_GraphModel.EdgeCount(); ++edge_index)
 		{
@@ -66,51 +74,76 @@ namespace jass
 			{
 				continue;
 			}
-			const QLineF line(p0, p1);
-			if (!Intersects(rcIntersect, line))
+			if (!Intersects(rcIntersect, QLineF(p0, p1)))
 			{
 				continue;
 			}
-			painter.drawLine(line);
-			m_Edges[edge_index].LastRect = EdgeRect(p0, p1);
+			m_TempLines.emplace_back(p0, p1);
+			m_Edges[edge_index].LastRect = EdgeRect(p0, p1).translated(-translation);
+		}
+
+		if (ELevelOfDetail::Minimal == level_of_detail)
+		{
+			m_TempMergedPoints.clear();
+			MergeSubPixelLines(m_TempLines, m_TempMergedPoints);
+			painter.drawPoints(m_TempMergedPoints.data(), (int)m_TempMergedPoints.size());
+		}
+		if (!m_TempLines.empty())
+		{
+			painter.drawLines(m_TempLines.data(), (int)m_TempLines.size());
 		}
 	}
 
-	void CJustifiedEdgeGraphLayer::OnViewChanged(const QRect& rc, float screen_to_model_scale)
+	void CJustifiedEdgeGraphLayer::OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change)
 	{
-		Reset();
+		// Item rects are kept in content coordinates, so a translation leaves them valid
+		if (EViewChange::Scale == change)
+		{
+			Reset();
+		}
 	}
 
 	void CJustifiedEdgeGraphLayer::OnEdgesAdded(size_t count)
 	{
-		Reset();
+		m_EdgesDirty = true;
 	}
 
-	void CJustifiedEdgeGraphLayer::OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CJustifiedEdgeGraphLayer::OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::index_moves_t& moves)
 	{
-		Reset();
+		m_EdgesDirty = true;
 	}
 
 	void CJustifiedEdgeGraphLayer::OnEdgesRemoved(const CGraphModel::const_edge_indices_t& edge_indices)
 	{
-		Reset();
+		m_EdgesDirty = true;
 	}
 
-	void CJustifiedEdgeGraphLayer::OnNodesModified(const bitvec& nodes_mask)
+	void CJustifiedEdgeGraphLayer::OnNodesModified(const sparse_bitvec& nodes_mask)
 	{
-		QRect rcUpdate;
+		if (m_EdgesDirty)
+		{
+			return;
+		}
+
+		CDamageRects damage;
 		nodes_mask.for_each_set_bit([&](const size_t node_index)
 			{
-				const auto node_pos = m_GraphModel.NodePosition((CGraphModel::node_index_t)node_index);
 				m_GraphModel.ForEachEdgeFromNode((CGraphModel::node_index_t)node_index, [&](auto edge_index, auto neighbour_index)
 				{
-					rcUpdate = rcUpdate.united(m_Edges[edge_index].LastRect);
-					rcUpdate = rcUpdate.united(EdgeRect(edge_index));
+					damage.Add(m_Edges[edge_index].LastRect.translated(GraphWidget().ScreenTranslation()).united(EdgeRect(edge_index)));
 				});
 			});
-		if (!rcUpdate.isEmpty())
+		for (const auto& rc : damage.Rects())
+		{
+			Update(rc);
+		}
+	}
+
+	void CJustifiedEdgeGraphLayer::OnGraphChanged(const CGraphModel::SChangeSet& changes)
+	{
+		if (m_EdgesDirty)
 		{
-			Update(rcUpdate);
+			Reset();
 		}
 	}
 
@@ -159,6 +192,7 @@ namespace jass
 	{
 		m_Edges.clear();
 		m_Edges.resize(m_GraphModel.EdgeCount(), {});
+		m_EdgesDirty = false;
 		Update();
 	}
 }
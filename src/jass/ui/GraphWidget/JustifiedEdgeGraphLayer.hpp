@@ -20,6 +20,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include <vector>
+#include <QtCore/qline.h>
 #include <jass/GraphModel.hpp>
 #include <jass/StandardNodeAttributes.h>
 #include "GraphWidget.hpp"
@@ -34,13 +35,15 @@ namespace jass
 
 		// CGraphLayer overrides
 		void Paint(QPainter& painter, const QRect& rc) override;
-		void OnViewChanged(const QRect& rc, float screen_to_model_scale) override;
+		bool CanCachePaint() const override { return true; }
+		void OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change) override;
 
 	private Q_SLOTS:
 		void OnEdgesAdded(size_t count);
-		void OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::node_remap_table_t& remap_table);
+		void OnEdgesInserted(const CGraphModel::const_edge_indices_t& edge_indices, const CGraphModel::index_moves_t& moves);
 		void OnEdgesRemoved(const CGraphModel::const_edge_indices_t& edge_indices);
-		void OnNodesModified(const bitvec& nodes_mask);
+		void OnNodesModified(const sparse_bitvec& nodes_mask);
+		void OnGraphChanged(const CGraphModel::SChangeSet& changes);
 
 	private:
 		bool   IsNodeJustified(size_t node_index) const;
@@ -51,7 +54,7 @@ namespace jass
 
 		struct SEdge
 		{
-			QRect LastRect;
+			QRect LastRect;  // Content coordinates (without view translation)
 		};
 
 		void Reset();
@@ -61,6 +64,9 @@ namespace jass
 		JPosition_NodeAttribute_t* m_JPositionNodeAttribute = nullptr;
 
 		int m_LineWidth = 2;
+		bool m_EdgesDirty = false;  // Edges inserted or removed, reset once the transaction commits
 		std::vector<SEdge> m_Edges;
+		std::vector<QLine> m_TempLines;
+		std::vector<QPoint> m_TempMergedPoints;
 	};
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <qapplib/commands/CommandHistory.hpp>
 
 #include <jass/math/Geometry.h>
@@ -24,8 +25,10 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <jass/commands/CmdSetNodeAttributes.h>
 #include <jass/GraphEditor/Analyses.hpp>
 #include <jass/GraphEditor/JassEditor.hpp>
+#include <jass/GraphEditor/JustifiedGraph.h>
 
 #include "JustifiedNodeGraphLayer.hpp"
+#include "DamageRects.h"
 
 namespace jass
 {
@@ -44,6 +47,7 @@ namespace jass
 		connect(&m_GraphModel, &CGraphModel::NodesRemoved, this, &CJustifiedNodeGraphLayer::OnNodesRemoved);
 		connect(&m_GraphModel, &CGraphModel::NodesInserted, this, &CJustifiedNodeGraphLayer::OnNodesInserted);
 		connect(&m_GraphModel, &CGraphModel::NodesModified, this, &CJustifiedNodeGraphLayer::OnNodesModified);
+		connect(&m_GraphModel, &CGraphModel::Changed, this, &CJustifiedNodeGraphLayer::OnGraphChanged);
 
 		RebuildNodes();
 	}
@@ -83,6 +87,44 @@ namespace jass
 	}
 
 
+	void CJustifiedNodeGraphLayer::Paint(QPainter& painter, const QRect& rc)
+	{
+		const auto level_of_detail = GraphWidget().LevelOfDetail(JUSTIFIED_GRAPH_SPACING);
+		if (!m_JPositionNodeAttribute)
+		{
+			CItemGraphLayer::Paint(painter, rc);
+			return;
+		}
+
+		// Item rects are what hit tests and updates of moved nodes go by
+		UpdateItemRects();
+
+		const auto margin = (ELevelOfDetail::Full == level_of_detail) ? std::max(MaxItemSize().width(), MaxItemSize().height()) : CGraphNodeTheme::SIMPLIFIED_ELEMENT_SIZE;
+		const auto rc_test = rc.adjusted(-margin, -margin, margin, margin);
+		m_TempElements.clear();
+		for (size_t node_index = 0; node_index < m_GraphModel.NodeCount(); ++node_index)
+		{
+			if (m_JPositionNodeAttribute->Value(node_index).y() < 0)
+			{
+				continue;
+			}
+			const auto pos = ElementPosition(node_index);
+			if (rc_test.contains(pos))
+			{
+				m_TempElements.push_back({ node_index, ElementStyle(node_index), pos });
+			}
+		}
+
+		if (ELevelOfDetail::Full == level_of_detail)
+		{
+			m_Theme->DrawElements(m_TempElements, painter);
+		}
+		else
+		{
+			m_Theme->DrawElementsSimplified(m_TempElements, level_of_detail, painter);
+		}
+	}
+
 	void CJustifiedNodeGraphLayer::SetHilighted(element_t element, bool hilighted)
 	{
 		if (m_HilightMask.get(element) == hilighted)
@@ -115,9 +157,13 @@ namespace jass
 		m_SelectionModel.EndModify();
 	}
 
-	void CJustifiedNodeGraphLayer::OnViewChanged(const QRect& rc, float screen_to_model_scale)
+	void CJustifiedNodeGraphLayer::OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change)
 	{
-		RebuildNodes();
+		// Item rects are kept in content coordinates, so a translation leaves them valid
+		if (EViewChange::Scale == change)
+		{
+			RebuildNodes();
+		}
 	}
 
 	bool CJustifiedNodeGraphLayer::CanMoveElements() const
@@ -176,6 +222,12 @@ namespace jass
 
 	void CJustifiedNodeGraphLayer::OnSelectionChanged()
 	{
+		if (m_NodesDirty)
+		{
+			// Node indices are stale until the rebuild, which takes the selection from the model
+			return;
+		}
+
 		m_TempSelectionMask.bitwise_xor(m_SelectionMask, m_SelectionModel.NodeMask());
 
 		m_TempSelectionMask.for_each_set_bit([&](size_t node_index)
@@ -187,37 +239,43 @@ namespace jass
 
 	void CJustifiedNodeGraphLayer::OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices)
 	{
-		RebuildNodes();
-		Update();
+		m_NodesDirty = true;
 	}
 
-	void CJustifiedNodeGraphLayer::OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CJustifiedNodeGraphLayer::OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves)
 	{
-		RebuildNodes();
-		Update();
+		m_NodesDirty = true;
 	}
 
-	void CJustifiedNodeGraphLayer::OnNodesModified(const bitvec& node_mask)
+	void CJustifiedNodeGraphLayer::OnNodesModified(const sparse_bitvec& node_mask)
 	{
-		QRect rcUpdate;
+		if (m_NodesDirty)
+		{
+			return;
+		}
+
+		// Moved nodes may be far apart, so repaint around each rather than their bounding rect
+		CDamageRects damage;
 		node_mask.for_each_set_bit([&](const size_t node_index)
 			{
-				if (rcUpdate.isEmpty())
-				{
-					rcUpdate = ItemRect(node_index);
-				}
-				else
-				{
-					rcUpdate = rcUpdate.united(ItemRect(node_index));
-				}
-				rcUpdate = rcUpdate.united(LastItemRect(node_index));
+				damage.Add(ItemRect(node_index).united(LastItemRect(node_index)));
 			});
-		if (!rcUpdate.isEmpty())
+		for (const auto& rc : damage.Rects())
 		{
-			Update(rcUpdate);
+			Update(rc);
 		}
 	}
 
+	void CJustifiedNodeGraphLayer::OnGraphChanged(const CGraphModel::SChangeSet& changes)
+	{
+		if (!m_NodesDirty)
+		{
+			return;
+		}
+		RebuildNodes();
+		Update();
+	}
+
 	void CJustifiedNodeGraphLayer::OnThemeUpdated()
 	{
 		Update();
@@ -251,9 +309,12 @@ namespace jass
 	{
 		ClearItems();
 		InsertItems(0, m_GraphModel.NodeCount());
+		m_SelectionMask = m_SelectionModel.NodeMask();
 		m_SelectionMask.resize(m_GraphModel.NodeCount());
 		m_HilightMask.resize(m_GraphModel.NodeCount());
 		m_HilightMask.clearAll();
+		UpdateItemRects();
+		m_NodesDirty = false;
 	}
 }
 
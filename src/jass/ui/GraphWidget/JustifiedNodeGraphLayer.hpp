@@ -51,10 +51,12 @@ namespace jass
 		void DrawItem(element_t element, QPainter& painter, const QRect& rc) const override;
 
 		// CGraphLayer overrides
+		void Paint(QPainter& painter, const QRect& rc) override;
 		void SetHilighted(element_t edge, bool hilighted) override;
 		void GetSelection(bitvec& out_selection_mask) const override;
 		void SetSelection(const bitvec& selection_mask) const override;
-		void OnViewChanged(const QRect& rc, float screen_to_model_scale) override;
+		void OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change) override;
+		bool CanCachePaint() const override { return true; }
 
 		bool CanMoveElements() const override;
 		void BeginMoveElements(const bitvec& element_mask) override;
@@ -64,8 +66,9 @@ namespace jass
 	private Q_SLOTS:
 		void OnSelectionChanged();
 		void OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices);
-		void OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table);
-		void OnNodesModified(const bitvec& node_mask);
+		void OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves);
+		void OnNodesModified(const sparse_bitvec& node_mask);
+		void OnGraphChanged(const CGraphModel::SChangeSet& changes);
 		void OnThemeUpdated();
 
 	private:
@@ -87,11 +90,13 @@ namespace jass
 
 		std::shared_ptr<CGraphNodeTheme> m_Theme;
 
+		bool m_NodesDirty = false;  // Nodes inserted or removed, rebuilt once the transaction commits
 		bitvec m_SelectionMask;
 		bitvec m_TempSelectionMask;
 		bitvec m_HilightMask;
 		bitvec m_MoveElementMask;
 		std::vector<QPointF> m_TempPoints;
+		std::vector<CGraphNodeTheme::SElementInstance> m_TempElements;
 	};
 
 	inline bool CJustifiedNodeGraphLayer::IsNodeSelected(size_t node_index) const { return m_SelectionMask.get(node_index); }
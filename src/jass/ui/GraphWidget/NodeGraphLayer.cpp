@@ -17,6 +17,7 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <qapplib/commands/CommandHistory.hpp>
 
 #include <jass/math/Geometry.h>
@@ -25,6 +26,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <jass/GraphEditor/JassEditor.hpp>
 
 #include "NodeGraphLayer.hpp"
+#include "DamageRects.h"
 
 namespace jass
 {
@@ -40,6 +42,7 @@ namespace jass
 		connect(&m_GraphModel, &CGraphModel::NodesRemoved, this, &CNodeGraphLayer::OnNodesRemoved);
 		connect(&m_GraphModel, &CGraphModel::NodesInserted, this, &CNodeGraphLayer::OnNodesInserted);
 		connect(&m_GraphModel, &CGraphModel::NodesModified, this, &CNodeGraphLayer::OnNodesModified);
+		connect(&m_GraphModel, &CGraphModel::Changed, this, &CNodeGraphLayer::OnGraphChanged);
 
 		RebuildNodes();
 	}
@@ -66,6 +69,8 @@ namespace jass
 		if (m_Theme)
 		{
 			connect(m_Theme.get(), &CGraphNodeTheme::Updated, this, &CNodeGraphLayer::OnThemeUpdated);
+			m_MaxElementSize = m_Theme->MaxElementSize();
+			UpdateItemRects();
 		}
 
 		Update();
@@ -85,6 +90,12 @@ namespace jass
 		return EElementStyle::Normal;
 	}
 
+	CNodeGraphLayer::element_t CNodeGraphLayer::NearestElement(const QPoint& pt, int max_distance) const
+	{
+		const auto node_index = m_GraphModel.NearestNode(GraphWidget().ModelFromScreen(pt), max_distance * GraphWidget().ScreenToModelScale());
+		return (CGraphModel::NO_NODE == node_index) ? NO_ELEMENT : (element_t)node_index;
+	}
+
 	QRect CNodeGraphLayer::ItemRect(element_t element) const
 	{
 		return m_Theme->ElementLocalRect(element, ElementStyle(element)).translated(ElementPosition(element));
@@ -95,6 +106,60 @@ namespace jass
 		m_Theme->DrawElement(element, ElementStyle(element), ElementPosition(element), painter);
 	}
 
+	void CNodeGraphLayer::Paint(QPainter& painter, const QRect& rc)
+	{
+		const auto level_of_detail = CollectElements(rc);
+		if (ELevelOfDetail::Full == level_of_detail)
+		{
+			m_Theme->DrawElements(m_TempElements, painter);
+		}
+		else
+		{
+			m_Theme->DrawElementsSimplified(m_TempElements, level_of_detail, painter);
+		}
+	}
+
+	std::shared_ptr<const IGraphLayerSnapshot> CNodeGraphLayer::Snapshot(const QRect& rc)
+	{
+		auto snapshot = std::make_shared<CGraphNodeTheme::CElementsSnapshot>();
+		const auto level_of_detail = CollectElements(rc);
+		if (ELevelOfDetail::Full == level_of_detail)
+		{
+			if (!m_Theme->SnapshotElements(m_TempElements, *snapshot))
+			{
+				return nullptr;
+			}
+		}
+		else
+		{
+			m_Theme->SnapshotElementsSimplified(m_TempElements, level_of_detail, *snapshot);
+		}
+		return snapshot;
+	}
+
+	ELevelOfDetail CNodeGraphLayer::CollectElements(const QRect& rc)
+	{
+		const auto level_of_detail = GraphWidget().LevelOfDetail(m_GraphModel.TypicalNodeSpacing());
+
+		const auto margin = (ELevelOfDetail::Full == level_of_detail) ? ItemMargin() : CGraphNodeTheme::SIMPLIFIED_ELEMENT_SIZE;
+		m_TempElements.clear();
+		m_GraphModel.ForEachNodeInRect(GraphWidget().ModelFromScreen(rc.adjusted(-margin, -margin, margin, margin)), [&](CGraphModel::node_index_t node_index)
+			{
+				m_TempElements.push_back({ (element_t)node_index, ElementStyle(node_index), ElementPosition(node_index) });
+			});
+
+		if (ELevelOfDetail::Full == level_of_detail)
+		{
+			// Draw in index order, as hit tests let the last drawn node win
+			std::sort(m_TempElements.begin(), m_TempElements.end(), [](const CGraphNodeTheme::SElementInstance& a, const CGraphNodeTheme::SElementInstance& b)
+				{
+					return a.Element < b.Element;
+				});
+		}
+
+		return level_of_detail;
+	}
+
 	void CNodeGraphLayer::SetHilighted(element_t element, bool hilighted)
 	{
 		if (m_HilightMask.get(element) == hilighted)
@@ -106,6 +171,7 @@ namespace jass
 		else
 			m_HilightMask.clear(element);
 		Update(ItemRect(element).united(LastItemRect(element)));
+		UpdateItemRect(element);
 	}
 
 	void CNodeGraphLayer::GetSelection(bitvec& out_selection_mask) const
@@ -127,9 +193,13 @@ namespace jass
 		m_SelectionModel.EndModify();
 	}
 
-	void CNodeGraphLayer::OnViewChanged(const QRect& rc, float screen_to_model_scale)
+	void CNodeGraphLayer::OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change)
 	{
-		RebuildNodes();
+		// Item rects are kept in content coordinates, so a translation leaves them valid
+		if (EViewChange::Scale == change)
+		{
+			RebuildNodes();
+		}
 	}
 
 	bool CNodeGraphLayer::CanMoveElements() const
@@ -182,52 +252,81 @@ namespace jass
 		}
 	}
 
+	bool CNodeGraphLayer::ForEachItemCandidate(const QRect& rc, const std::function<void(element_t)>& fn) const
+	{
+		// Items are drawn around node positions, so any item intersecting 'rc' belongs to a node
+		// within one item size of it
+		const auto margin = ItemMargin();
+		const auto rc_model = GraphWidget().ModelFromScreen(rc.adjusted(-margin, -margin, margin, margin));
+		m_GraphModel.ForEachNodeInRect(rc_model, [&](CGraphModel::node_index_t node_index)
+			{
+				fn((element_t)node_index);
+			});
+		return true;
+	}
+
 	void CNodeGraphLayer::OnSelectionChanged()
 	{
+		if (m_NodesDirty)
+		{
+			// Node indices are stale until the rebuild, which takes the selection from the model
+			return;
+		}
+
 		m_TempSelectionMask.bitwise_xor(m_SelectionMask, m_SelectionModel.NodeMask());
 
 		m_TempSelectionMask.for_each_set_bit([&](size_t node_index)
 			{
 				m_SelectionMask.toggle(node_index);
 				Update(ItemRect(node_index).united(LastItemRect(node_index)));
+				UpdateItemRect(node_index);
 			});
 	}
 
 	void CNodeGraphLayer::OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices)
 	{
-		RebuildNodes();
-		Update();
+		m_NodesDirty = true;
 	}
 
-	void CNodeGraphLayer::OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table)
+	void CNodeGraphLayer::OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves)
 	{
-		RebuildNodes();
-		Update();
+		m_NodesDirty = true;
 	}
 
-	void CNodeGraphLayer::OnNodesModified(const bitvec& node_mask)
+	void CNodeGraphLayer::OnNodesModified(const sparse_bitvec& node_mask)
 	{
-		QRect rcUpdate;
+		if (m_NodesDirty)
+		{
+			return;
+		}
+
+		// Moved nodes may be far apart, so repaint around each rather than their bounding rect
+		CDamageRects damage;
 		node_mask.for_each_set_bit([&](const size_t node_index)
 			{
-				if (rcUpdate.isEmpty())
-				{
-					rcUpdate = ItemRect(node_index);
-				}
-				else
-				{
-					rcUpdate = rcUpdate.united(ItemRect(node_index));
-				}
-				rcUpdate = rcUpdate.united(LastItemRect(node_index));
+				damage.Add(ItemRect(node_index).united(LastItemRect(node_index)));
+				UpdateItemRect(node_index);
 			});
-		if (!rcUpdate.isEmpty())
+		for (const auto& rc : damage.Rects())
 		{
-			Update(rcUpdate);
+			Update(rc);
 		}
 	}
 
+	void CNodeGraphLayer::OnGraphChanged(const CGraphModel::SChangeSet& changes)
+	{
+		if (!m_NodesDirty)
+		{
+			return;
+		}
+		RebuildNodes();
+		Update();
+	}
+
 	void CNodeGraphLayer::OnThemeUpdated()
 	{
+		m_MaxElementSize = m_Theme->MaxElementSize();
+		UpdateItemRects();
 		Update();
 	}
 
@@ -235,9 +334,12 @@ namespace jass
 	{
 		ClearItems();
 		InsertItems(0, m_GraphModel.NodeCount());
+		m_SelectionMask = m_SelectionModel.NodeMask();
 		m_SelectionMask.resize(m_GraphModel.NodeCount());
 		m_HilightMask.resize(m_GraphModel.NodeCount());
 		m_HilightMask.clearAll();
+		m_NodesDirty = false;
+		UpdateItemRects();
 	}
 }
 
@@ -52,15 +52,21 @@ namespace jass
 
 		EElementStyle ElementStyle(element_t element) const;
 
+		// Returns NO_ELEMENT if no node is within 'max_distance' pixels of 'pt'
+		element_t NearestElement(const QPoint& pt, int max_distance) const;
+
 		// CItemGraphLayer overrides
 		QRect ItemRect(element_t element) const override;
 		void DrawItem(element_t element, QPainter& painter, const QRect& rc) const override;
 
 		// CGraphLayer overrides
+		void Paint(QPainter& painter, const QRect& rc) override;
 		void SetHilighted(element_t edge, bool hilighted) override;
 		void GetSelection(bitvec& out_selection_mask) const override;
 		void SetSelection(const bitvec& selection_mask) const override;
-		void OnViewChanged(const QRect& rc, float screen_to_model_scale) override;
+		void OnViewChanged(const QRect& rc, float screen_to_model_scale, EViewChange change) override;
+		bool CanCachePaint() const override { return true; }
+		std::shared_ptr<const IGraphLayerSnapshot> Snapshot(const QRect& rc) override;
 
 		bool CanMoveElements() const override;
 		void BeginMoveElements(const bitvec& element_mask) override;
@@ -70,10 +76,15 @@ namespace jass
 	private Q_SLOTS:
 		void OnSelectionChanged();
 		void OnNodesRemoved(const CGraphModel::const_node_indices_t& node_indices);
-		void OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::node_remap_table_t& remap_table);
-		void OnNodesModified(const bitvec& node_mask);
+		void OnNodesInserted(const CGraphModel::const_node_indices_t& node_indices, const CGraphModel::index_moves_t& moves);
+		void OnNodesModified(const sparse_bitvec& node_mask);
+		void OnGraphChanged(const CGraphModel::SChangeSet& changes);
 		void OnThemeUpdated();
 
+	protected:
+		// CItemGraphLayer overrides
+		bool ForEachItemCandidate(const QRect& rc, const std::function<void(element_t)>& fn) const override;
+
 	private:
 
 		inline bool IsNodeSelected(element_t node_index) const;
@@ -81,17 +92,26 @@ namespace jass
 
 		void RebuildNodes();
 
+		// Largest item size of the theme, in pixels around a node position
+		inline int ItemMargin() const { return std::max(m_MaxElementSize.width(), m_MaxElementSize.height()); }
+
+		// Nodes to draw in 'rc' into m_TempElements, in drawing order
+		ELevelOfDetail CollectElements(const QRect& rc);
+
 		CGraphModel& m_GraphModel;
 		CGraphSelectionModel& m_SelectionModel;
 		qapp::CCommandHistory& m_CommandHistory;
 		
 		std::shared_ptr<CGraphNodeTheme> m_Theme;
+		QSize m_MaxElementSize;  // Of m_Theme, updated along with it
 		
+		bool m_NodesDirty = false;  // Nodes inserted or removed, rebuilt once the transaction commits
 		bitvec m_SelectionMask;
 		bitvec m_TempSelectionMask;
 		bitvec m_HilightMask;
 		bitvec m_MoveElementMask;
 		std::vector<QPointF> m_TempPoints;
+		std::vector<CGraphNodeTheme::SElementInstance> m_TempElements;
 	};
 
 	inline bool CNodeGraphLayer::IsNodeSelected(size_t node_index) const { return m_SelectionMask.get(node_index); }
@@ -24,6 +24,13 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 namespace jass
 {
 	void CreateNodeSprite(const SNodeSpriteDesc& desc, QPixmap& out_pixmap, QPoint& out_origin)
+	{
+		QImage image;
+		CreateNodeSpriteImage(desc, image, out_origin);
+		out_pixmap = QPixmap::fromImage(image);
+	}
+
+	void CreateNodeSpriteImage(const SNodeSpriteDesc& desc, QImage& out_image, QPoint& out_origin)
 	{
 		const auto points = GetShapePoints(desc.Shape);
 
@@ -39,13 +46,13 @@ namespace jass
 
 		const QPoint origin = { -(int)std::floor(bb_min.x()), -(int)std::floor(bb_min.y()) };
 		const QPoint dim = { origin.x() + (int)std::ceil(bb_max.x()), origin.y() + (int)std::ceil(bb_max.y())};
-		QImage image(dim.x(), dim.y(), QImage::Format_ARGB32);
+		out_image = QImage(dim.x(), dim.y(), QImage::Format_ARGB32);
 
 		// Clear
-		image.fill(Qt::transparent);
+		out_image.fill(Qt::transparent);
 
 		// Create a QPainter to draw on the QPixmap
-		QPainter painter(&image);
+		QPainter painter(&out_image);
 
 		painter.setRenderHint(QPainter::Antialiasing, true);
 
@@ -108,9 +115,8 @@ namespace jass
 			painter.drawPolygon(polygon);
 		}
 
-		DropShadow(image, desc.ShadowColor, desc.ShadowBlurRadius, (int)shadowOffset.x(), (int)shadowOffset.y(), 2.0f);
+		DropShadow(out_image, desc.ShadowColor, desc.ShadowBlurRadius, (int)shadowOffset.x(), (int)shadowOffset.y(), 2.0f);
 
-		out_pixmap = QPixmap::fromImage(image);
 		out_origin = { origin.x() - desc.Offset.x(), origin.y() - desc.Offset.y() };
 	}
 }
\ No newline at end of file
@@ -21,6 +21,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #include <jass/Shape.h>
 
+class QImage;
 class QPixmap;
 
 namespace jass
@@ -41,4 +42,7 @@ namespace jass
 	};
 
 	void CreateNodeSprite(const SNodeSpriteDesc& desc, QPixmap& out_pixmap, QPoint& out_origin);
+
+	// Same as CreateNodeSprite, but safe to call from any thread
+	void CreateNodeSpriteImage(const SNodeSpriteDesc& desc, QImage& out_image, QPoint& out_origin);
 }
\ No newline at end of file
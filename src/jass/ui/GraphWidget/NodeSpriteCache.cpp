@@ -0,0 +1,186 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <thread>
+#include <QtCore/qdir.h>
+#include <QtCore/qsavefile.h>
+#include <QtGui/qimage.h>
+#include <jass/Debug.h>
+#include <jass/ui/ImageFx.h>
+#include "NodeSprite.h"
+#include "NodeSpriteCache.h"
+
+namespace jass
+{
+	static const QRgb COLOR_SELECTED = qRgb(0x0a, 0x84, 0xff);
+	static const QRgb COLOR_HILIGHT = Blend(COLOR_SELECTED, 0xFFFFFFFF, 48);
+
+	// Bump when sprites are drawn differently, so that old ones on disk are not used
+	static const int DISK_CACHE_VERSION = 1;
+
+	static const char* const ORIGIN_TEXT_KEY = "Origin";
+
+	static SNodeSpriteDesc NodeSpriteDesc(const SNodeSpriteKey& key)
+	{
+		using EStyle = CGraphNodeTheme::EStyle;
+
+		const auto sprite_scale = .01f * key.Scale;
+
+		SNodeSpriteDesc desc;
+		desc.Shape = key.Shape;
+		desc.Radius = (9 * sprite_scale) + .5f;
+		desc.OutlineWidth = std::round(sprite_scale * 3);
+		desc.OutlineWidth2 = 0;
+		const auto shadow_offset = (float)std::max((int)1, (int)std::round(sprite_scale));
+		desc.ShadowOffset = { shadow_offset, shadow_offset };
+		desc.ShadowBlurRadius = std::round(sprite_scale * 3);
+		desc.FillColor = key.FillColor;
+		desc.OutlineColor = qRgb(255, 255, 255);
+		desc.ShadowColor = qRgba(0, 0, 0, 255);
+
+		if (EStyle::Selected == key.Style)
+		{
+			desc.OutlineColor2 = COLOR_SELECTED;
+			desc.OutlineWidth2 = desc.OutlineWidth;
+		}
+		else if (EStyle::Hilighted == key.Style)
+		{
+			desc.OutlineColor2 = COLOR_HILIGHT;
+			desc.OutlineWidth2 = std::round(sprite_scale * 4);
+		}
+
+		return desc;
+	}
+
+	void CNodeSpriteCache::SetDiskCacheDirectory(const QString& path)
+	{
+		m_DiskCacheDirectory = path;
+		if (!path.isEmpty() && !QDir().mkpath(path))
+		{
+			m_DiskCacheDirectory.clear();
+		}
+	}
+
+	void CNodeSpriteCache::GetSprites(std::span<const SNodeSpriteKey> keys, std::span<SSprite> out_sprites)
+	{
+		ASSERT(keys.size() == out_sprites.size());
+
+		if (m_Sprites.size() + keys.size() > MAX_SPRITE_COUNT)
+		{
+			m_Sprites.clear();
+		}
+
+		// Distinct keys not in memory
+		std::vector<size_t> missing;
+		std::vector<uint64_t> missing_packed_keys;
+		flat_hash_map<size_t> missing_index_by_key;
+		for (size_t key_index = 0; key_index < keys.size(); ++key_index)
+		{
+			const auto packed_key = PackKey(keys[key_index]);
+			if (!m_Sprites.find(packed_key) && missing_index_by_key.insert(packed_key, missing.size()))
+			{
+				missing.push_back(key_index);
+				missing_packed_keys.push_back(packed_key);
+			}
+		}
+
+		if (!missing.empty())
+		{
+			std::vector<QImage> images(missing.size());
+			std::vector<QPoint> origins(missing.size());
+			auto create_range = [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						LoadOrCreateSprite(keys[missing[i]], images[i], origins[i]);
+					}
+				};
+
+			// Calling thread takes the first share
+			const size_t thread_count = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), missing.size()));
+			std::vector<std::future<void>> results;
+			results.reserve(thread_count - 1);
+			for (size_t thread_index = 1; thread_index < thread_count; ++thread_index)
+			{
+				results.push_back(std::async(std::launch::async, create_range, missing.size() * thread_index / thread_count, missing.size() * (thread_index + 1) / thread_count));
+			}
+			create_range(0, missing.size() / thread_count);
+			for (auto& result : results)
+			{
+				result.wait();
+			}
+
+			// Pixmaps may only be created on the UI thread
+			for (size_t i = 0; i < missing.size(); ++i)
+			{
+				m_Sprites.insert(missing_packed_keys[i], { QPixmap::fromImage(images[i]), origins[i] });
+			}
+		}
+
+		for (size_t key_index = 0; key_index < keys.size(); ++key_index)
+		{
+			const auto* sprite = m_Sprites.find(PackKey(keys[key_index]));
+			ASSERT(sprite);
+			out_sprites[key_index] = *sprite;
+		}
+	}
+
+	uint64_t CNodeSpriteCache::PackKey(const SNodeSpriteKey& key)
+	{
+		return ((uint64_t)key.Shape << 56) | ((uint64_t)key.Style << 48) | ((uint64_t)(uint16_t)key.Scale << 32) | (uint64_t)key.FillColor;
+	}
+
+	QString CNodeSpriteCache::DiskCachePath(uint64_t packed_key) const
+	{
+		return QString("%1/node%2_%3.png").arg(m_DiskCacheDirectory).arg(DISK_CACHE_VERSION).arg(packed_key, 16, 16, QChar('0'));
+	}
+
+	void CNodeSpriteCache::LoadOrCreateSprite(const SNodeSpriteKey& key, QImage& out_image, QPoint& out_origin) const
+	{
+		if (m_DiskCacheDirectory.isEmpty())
+		{
+			CreateNodeSpriteImage(NodeSpriteDesc(key), out_image, out_origin);
+			return;
+		}
+
+		const auto path = DiskCachePath(PackKey(key));
+		if (out_image.load(path, "PNG"))
+		{
+			const auto origin = out_image.text(ORIGIN_TEXT_KEY).split(',');
+			if (2 == origin.size())
+			{
+				out_origin = QPoint(origin[0].toInt(), origin[1].toInt());
+				return;
+			}
+		}
+
+		CreateNodeSpriteImage(NodeSpriteDesc(key), out_image, out_origin);
+
+		// Written to a temporary file first, so that other instances never read a partial file
+		out_image.setText(ORIGIN_TEXT_KEY, QString("%1,%2").arg(out_origin.x()).arg(out_origin.y()));
+		QSaveFile file(path);
+		if (file.open(QIODevice::WriteOnly) && out_image.save(&file, "PNG"))
+		{
+			file.commit();
+		}
+	}
+}
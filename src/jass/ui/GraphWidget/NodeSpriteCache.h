@@ -0,0 +1,69 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <QtCore/qstring.h>
+#include <QtGui/qpixmap.h>
+#include <jass/utils/flat_hash_map.h>
+#include <jass/Shape.h>
+#include "GraphNodeTheme.hpp"
+
+namespace jass
+{
+	struct SNodeSpriteKey
+	{
+		EShape                  Shape;
+		CGraphNodeTheme::EStyle Style;
+		QRgb                    FillColor;
+		int                     Scale;  // UI scale in percent
+	};
+
+	// Node sprites by shape, style, color and scale, so that each variant is only rasterized once.
+	// Optionally also kept on disk, so that they survive restarts.
+	class CNodeSpriteCache
+	{
+	public:
+		struct SSprite
+		{
+			QPixmap Pixmap;
+			QPoint  Origin;
+		};
+
+		// Empty path disables the disk cache
+		void SetDiskCacheDirectory(const QString& path);
+
+		// Sprites not in memory are loaded from disk or rasterized, spread over worker threads
+		void GetSprites(std::span<const SNodeSpriteKey> keys, std::span<SSprite> out_sprites);
+
+	private:
+		static const size_t MAX_SPRITE_COUNT = 16384;
+
+		static uint64_t PackKey(const SNodeSpriteKey& key);
+
+		QString DiskCachePath(uint64_t packed_key) const;
+
+		void LoadOrCreateSprite(const SNodeSpriteKey& key, QImage& out_image, QPoint& out_origin) const;
+
+		QString m_DiskCacheDirectory;
+		flat_hash_map<SSprite> m_Sprites;
+	};
+}
@@ -22,15 +22,13 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <jass/Settings.hpp>
 #include <jass/ui/ImageFx.h>
 #include "PaletteSpriteSet.h"
-#include "NodeSprite.h"
+#include "NodeSpriteCache.h"
 
 namespace jass
 {
-	static const QRgb COLOR_SELECTED = qRgb(0x0a, 0x84, 0xff);
-	static const QRgb COLOR_HILIGHT = Blend(COLOR_SELECTED, 0xFFFFFFFF, 48);
-
-	CPaletteSpriteSet::CPaletteSpriteSet(const std::span<const QRgb>& palette, QRgb no_color, const CSettings& settings)
+	CPaletteSpriteSet::CPaletteSpriteSet(const std::span<const QRgb>& palette, QRgb no_color, const CSettings& settings, CNodeSpriteCache& sprite_cache)
 		: m_Settings(settings)
+		, m_SpriteCache(sprite_cache)
 	{
 		m_Palette.reserve(palette.size() + 1);
 		m_Palette.insert(m_Palette.begin(), palette.begin(), palette.end());
@@ -41,75 +39,48 @@ namespace jass
 
 	void CPaletteSpriteSet::Draw(EShape shape, EStyle style, uint32_t palette_index, const QPoint& pos, QPainter& painter) const
 	{
-		const auto& sprite = Sprite(shape, style);
-		palette_index = std::min(palette_index, (uint32_t)(m_Palette.size() - 1));
-		painter.drawPixmap(pos - sprite.Origin, sprite.Pixmap, QRect(0, sprite.Size.height() * palette_index, sprite.Size.width(), sprite.Size.height()));
+		Atlas().DrawSprite(SpriteIndex(shape, style, palette_index), painter, pos);
 	}
 
 	void CPaletteSpriteSet::OnSettingChanged(const QString& key, const QVariant& newValue)
 	{
 		if (key == CSettings::UI_SCALE)
 		{
-			for (auto& sprite : m_Sprites)
-			{
-				sprite.Pixmap = QPixmap();
-			}
+			m_Atlas.Clear();
 			emit Changed();
 		}
 	}
 
-	float CPaletteSpriteSet::SpriteScale() const
+	int CPaletteSpriteSet::UiScale() const
 	{
-		return .01f * m_Settings.value(CSettings::UI_SCALE, 100).toInt();
+		return m_Settings.value(CSettings::UI_SCALE, 100).toInt();
 	}
 
-	void CPaletteSpriteSet::CreateSprite(EShape shape, EStyle style, const std::span<const QRgb>& palette, SSprite& out_sprite)
+	void CPaletteSpriteSet::CreateSprites(CSpriteAtlas& atlas)
 	{
-		QPixmap pixmap;
-		QPoint origin;
-
-		const auto sprite_scale = SpriteScale();
-
-		SNodeSpriteDesc desc;
-		desc.Radius = (9 * sprite_scale) + .5f;
-		desc.OutlineWidth = std::round(sprite_scale * 3);
-		desc.OutlineWidth2 = 0;
-		const auto shadow_offset = (float)std::max((int)1, (int)std::round(sprite_scale));
-		desc.ShadowOffset = { shadow_offset, shadow_offset };
-		desc.ShadowBlurRadius = std::round(sprite_scale * 3);
-		desc.OutlineColor = qRgb(255, 255, 255);
-		desc.ShadowColor = qRgba(0, 0, 0, 255);
-		desc.Shape = shape;
-
-		if (EStyle::Selected == style)
-		{
-			desc.OutlineColor2 = COLOR_SELECTED;
-			desc.OutlineWidth2 = desc.OutlineWidth;
-		}
-		else if (EStyle::Hilighted == style)
+		// In SpriteIndex order
+		const auto ui_scale = UiScale();
+		std::vector<SNodeSpriteKey> keys;
+		keys.reserve((size_t)EShape::_COUNT * STYLE_COUNT * m_Palette.size());
+		for (uint32_t shape = 0; shape < (uint32_t)EShape::_COUNT; ++shape)
 		{
-			desc.OutlineColor2 = COLOR_HILIGHT;
-			desc.OutlineWidth2 = std::round(sprite_scale * 4);
+			for (uint8_t style = 0; style < STYLE_COUNT; ++style)
+			{
+				for (const auto color : m_Palette)
+				{
+					keys.push_back({ (EShape)shape, (EStyle)style, color, ui_scale });
+				}
+			}
 		}
 
-		QPixmap pmTemp;
-
-		desc.FillColor = palette.front();
-		CreateNodeSprite(desc, pmTemp, out_sprite.Origin);
-		out_sprite.Size = pmTemp.size();
-
-		out_sprite.Pixmap = QPixmap(out_sprite.Size.width(), out_sprite.Size.height() * (int)palette.size());
-		out_sprite.Pixmap.fill(Qt::transparent);
-
-		QPainter painter(&out_sprite.Pixmap);
-		painter.drawPixmap(0, 0, pmTemp);
-
-		for (size_t palette_index = 1; palette_index < palette.size(); ++palette_index)
+		std::vector<CNodeSpriteCache::SSprite> sprites(keys.size());
+		m_SpriteCache.GetSprites(keys, sprites);
+		for (auto& sprite : sprites)
 		{
-			desc.FillColor = palette[palette_index];
-			CreateNodeSprite(desc, pmTemp, out_sprite.Origin);
-			painter.drawPixmap(0, (int)palette_index * out_sprite.Size.height(), pmTemp);
+			atlas.Add(std::move(sprite.Pixmap), sprite.Origin);
 		}
+
+		atlas.Pack();
 	}
 
 	void InterpolatePalette(const std::span<const QRgb>& in_colors, const std::span<QRgb>& out_colors)
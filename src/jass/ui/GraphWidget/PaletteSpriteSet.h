@@ -22,10 +22,11 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <span>
 #include <jass/GraphEditor/CategorySet.hpp>
 #include "GraphNodeTheme.hpp"
-#include "SpriteSet.h"
+#include "SpriteAtlas.h"
 
 namespace jass
 {
+	class CNodeSpriteCache;
 	class CSettings;
 
 	class CPaletteSpriteSet: public QObject
@@ -34,7 +35,7 @@ namespace jass
 	public:
 		using EStyle = CGraphNodeTheme::EStyle;
 
-		CPaletteSpriteSet(const std::span<const QRgb>& palette, QRgb no_color, const CSettings& settings);
+		CPaletteSpriteSet(const std::span<const QRgb>& palette, QRgb no_color, const CSettings& settings, CNodeSpriteCache& sprite_cache);
 
 		inline size_t PaletteSize() const { return m_Palette.size() - 1; }
 
@@ -43,6 +44,10 @@ namespace jass
 		inline QRect Rect(EShape shape, EStyle style) const;
 		void Draw(EShape shape, EStyle style, uint32_t palette_index, const QPoint& pos, QPainter& painter) const;
 
+		// Sprites of all shapes, styles and colors, indexed by SpriteIndex
+		inline const CSpriteAtlas& Atlas() const;
+		inline size_t SpriteIndex(EShape shape, EStyle style, uint32_t palette_index) const;
+
 	Q_SIGNALS:
 		void Changed();
 
@@ -52,41 +57,42 @@ namespace jass
 	private:
 		static const uint8_t STYLE_COUNT = (uint8_t)EStyle::_COUNT;
 
-		float SpriteScale() const;
-
-		struct SSprite
-		{
-			QPoint Origin;
-			QSize  Size;
-			QPixmap Pixmap;
-		};
+		int UiScale() const;
 
 		const CSettings& m_Settings;
-		SSprite m_Sprites[(uint32_t)EShape::_COUNT * STYLE_COUNT];
+		CNodeSpriteCache& m_SpriteCache;
+		CSpriteAtlas m_Atlas;
 		std::vector<QRgb> m_Palette;
 
+		inline CSpriteAtlas& Atlas();
 
-		inline SSprite&       Sprite(EShape shape, EStyle style);
-		inline const SSprite& Sprite(EShape shape, EStyle style) const { return const_cast<CPaletteSpriteSet*>(this)->Sprite(shape, style); }
-
-		void CreateSprite(EShape shape, EStyle style, const std::span<const QRgb>& palette, SSprite& out_sprite);
+		void CreateSprites(CSpriteAtlas& atlas);
 	};
 
 	inline QRect CPaletteSpriteSet::Rect(EShape shape, EStyle style) const
 	{
-		const auto& sprite = Sprite(shape, style);
-		return QRect(-sprite.Origin.x(), -sprite.Origin.y(), sprite.Size.width(), sprite.Size.height());
+		return Atlas().SpriteRect(SpriteIndex(shape, style, 0));
+	}
+
+	inline const CSpriteAtlas& CPaletteSpriteSet::Atlas() const
+	{
+		return const_cast<CPaletteSpriteSet*>(this)->Atlas();
 	}
 
-	inline CPaletteSpriteSet::SSprite& CPaletteSpriteSet::Sprite(EShape shape, EStyle style)
+	inline CSpriteAtlas& CPaletteSpriteSet::Atlas()
 	{
-		auto& sprite = m_Sprites[(uint32_t)shape * STYLE_COUNT + (uint8_t)style];
-		if (sprite.Pixmap.isNull())
+		if (m_Atlas.Empty())
 		{
-			CreateSprite(shape, style, m_Palette, sprite);
-			ASSERT(!sprite.Pixmap.isNull());
+			CreateSprites(m_Atlas);
+			ASSERT(!m_Atlas.Empty());
 		}
-		return sprite;
+		return m_Atlas;
+	}
+
+	inline size_t CPaletteSpriteSet::SpriteIndex(EShape shape, EStyle style, uint32_t palette_index) const
+	{
+		palette_index = std::min(palette_index, (uint32_t)(m_Palette.size() - 1));
+		return ((size_t)shape * STYLE_COUNT + (uint8_t)style) * m_Palette.size() + palette_index;
 	}
 
 	void InterpolatePalette(const std::span<const QRgb>& in_colors, const std::span<QRgb>& out_colors);
@@ -0,0 +1,143 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtGui/qpainter.h>
+#include <QtGui/qpen.h>
+#include <QtGui/qpolygon.h>
+
+#include <jass/Debug.h>
+
+#include "PathGraphLayer.hpp"
+
+namespace jass
+{
+	static const QRgb COLOR_PATH = qRgba(0xe7, 0x85, 0x1d, 0xE0);  // Orange
+	static const QRgb COLOR_ALTERNATIVE_PATH = qRgba(0xe7, 0x85, 0x1d, 0x80);
+
+	CPathGraphLayer::CPathGraphLayer(CGraphWidget& graphWidget, CGraphModel& graph_model, EPositions positions)
+		: CGraphLayer(graphWidget)
+		, m_GraphModel(graph_model)
+		, m_Positions(positions)
+	{
+		// Any change in topology invalidates the node indices of the paths
+		connect(&graph_model, &CGraphModel::Changed, this, &CPathGraphLayer::OnGraphChanged);
+		connect(&graph_model, &CGraphModel::NodesModified, this, &CPathGraphLayer::OnNodesModified);
+	}
+
+	void CPathGraphLayer::SetPaths(std::vector<path_t>&& paths)
+	{
+		m_Paths = std::move(paths);
+		Update();
+	}
+
+	void CPathGraphLayer::ClearPaths()
+	{
+		if (m_Paths.empty())
+		{
+			return;
+		}
+		m_Paths.clear();
+		Update();
+	}
+
+	void CPathGraphLayer::Paint(QPainter& painter, const QRect& rc)
+	{
+		if (m_Paths.empty())
+		{
+			return;
+		}
+
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.setBrush(Qt::NoBrush);
+
+		// Alternatives first, so that the primary path ends up on top
+		for (size_t path_index = m_Paths.size(); path_index-- > 0;)
+		{
+			QPen pen(QColor::fromRgba(path_index ? COLOR_ALTERNATIVE_PATH : COLOR_PATH));
+			pen.setWidthF(path_index ? m_AlternativeLineWidth : m_LineWidth);
+			pen.setCapStyle(Qt::RoundCap);
+			pen.setJoinStyle(Qt::RoundJoin);
+			painter.setPen(pen);
+			PaintPath(painter, m_Paths[path_index]);
+		}
+	}
+
+	void CPathGraphLayer::OnGraphChanged(const CGraphModel::SChangeSet& changes)
+	{
+		if (changes.TopologyChanged())
+		{
+			ClearPaths();
+		}
+	}
+
+	void CPathGraphLayer::OnNodesModified(const sparse_bitvec& nodes_mask)
+	{
+		if (!m_Paths.empty())
+		{
+			Update();
+		}
+	}
+
+	bool CPathGraphLayer::TryGetNodePos(size_t node_index, QPointF& out_pos) const
+	{
+		if (node_index >= m_GraphModel.NodeCount())
+		{
+			return false;
+		}
+		if (EPositions::Justified == m_Positions)
+		{
+			const auto* jposition_attribute = TryGetJPositionNodeAttribute(m_GraphModel);
+			if (!jposition_attribute || jposition_attribute->Value(node_index).y() < 0)
+			{
+				return false;
+			}
+			out_pos = GraphWidget().ScreenFromModel(jposition_attribute->Value(node_index));
+			return true;
+		}
+		out_pos = GraphWidget().ScreenFromModel(m_GraphModel.NodePosition((CGraphModel::node_index_t)node_index));
+		return true;
+	}
+
+	void CPathGraphLayer::PaintPath(QPainter& painter, const path_t& path) const
+	{
+		// Nodes without a position (e.g. not part of the justified graph) break the path
+		QPolygonF polyline;
+		polyline.reserve((int)path.size());
+		QPointF pos;
+		for (const auto node_index : path)
+		{
+			if (TryGetNodePos(node_index, pos))
+			{
+				polyline.append(pos);
+				continue;
+			}
+			if (polyline.size() > 1)
+			{
+				painter.drawPolyline(polyline);
+			}
+			polyline.clear();
+		}
+		if (polyline.size() > 1)
+		{
+			painter.drawPolyline(polyline);
+		}
+	}
+}
+
+#include <moc_PathGraphLayer.cpp>
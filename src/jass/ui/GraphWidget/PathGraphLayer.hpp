@@ -0,0 +1,66 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <jass/GraphModel.hpp>
+#include <jass/StandardNodeAttributes.h>
+#include "GraphWidget.hpp"
+
+namespace jass
+{
+	// Overlay that hilights one or more paths through the graph. The first path is the
+	// primary one, any following paths are drawn as alternatives.
+	class CPathGraphLayer: public QObject, public CGraphLayer
+	{
+		Q_OBJECT
+	public:
+		typedef std::vector<CGraphModel::node_index_t> path_t;
+
+		enum class EPositions
+		{
+			Plan,
+			Justified,
+		};
+
+		CPathGraphLayer(CGraphWidget& graphWidget, CGraphModel& graph_model, EPositions positions);
+
+		void SetPaths(std::vector<path_t>&& paths);
+		void ClearPaths();
+		inline const std::vector<path_t>& Paths() const { return m_Paths; }
+
+		// CGraphLayer overrides
+		void Paint(QPainter& painter, const QRect& rc) override;
+
+	private Q_SLOTS:
+		void OnGraphChanged(const CGraphModel::SChangeSet& changes);
+		void OnNodesModified(const sparse_bitvec& nodes_mask);
+
+	private:
+		bool TryGetNodePos(size_t node_index, QPointF& out_pos) const;
+		void PaintPath(QPainter& painter, const path_t& path) const;
+
+		CGraphModel& m_GraphModel;
+		EPositions m_Positions;
+		float m_LineWidth = 6;
+		float m_AlternativeLineWidth = 3;
+		std::vector<path_t> m_Paths;
+	};
+}
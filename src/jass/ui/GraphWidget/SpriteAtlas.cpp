@@ -0,0 +1,130 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <jass/Debug.h>
+#include "SpriteAtlas.h"
+
+namespace jass
+{
+	void CSpriteAtlas::Clear()
+	{
+		m_Sprites.clear();
+		m_PendingPixmaps.clear();
+		m_Image = QImage();
+		m_Pixmap = QPixmap();
+	}
+
+	size_t CSpriteAtlas::Add(QPixmap&& pixmap, const QPoint& origin)
+	{
+		ASSERT(m_Pixmap.isNull() && "Clear a packed atlas before adding sprites");
+		m_Sprites.push_back({ QRect(QPoint(0, 0), pixmap.size()), origin });
+		m_PendingPixmaps.push_back(std::move(pixmap));
+		return m_Sprites.size() - 1;
+	}
+
+	void CSpriteAtlas::Pack()
+	{
+		if (m_PendingPixmaps.empty())
+		{
+			return;
+		}
+
+		// Shelf packing, tallest sprites first
+		std::vector<size_t> order(m_Sprites.size());
+		std::iota(order.begin(), order.end(), (size_t)0);
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+			{
+				return m_Sprites[a].SourceRect.height() > m_Sprites[b].SourceRect.height();
+			});
+
+		int64_t area = 0;
+		int max_width = 0;
+		for (const auto& sprite : m_Sprites)
+		{
+			area += (int64_t)(sprite.SourceRect.width() + PADDING) * (sprite.SourceRect.height() + PADDING);
+			max_width = std::max(max_width, sprite.SourceRect.width() + PADDING);
+		}
+		const auto atlas_width = std::max(max_width, (int)std::ceil(std::sqrt((double)area)));
+
+		QPoint pos(0, 0);
+		int shelf_height = 0;
+		for (const auto sprite_index : order)
+		{
+			auto& rc = m_Sprites[sprite_index].SourceRect;
+			if (pos.x() + rc.width() > atlas_width)
+			{
+				pos = QPoint(0, pos.y() + shelf_height);
+				shelf_height = 0;
+			}
+			rc.moveTopLeft(pos);
+			pos.rx() += rc.width() + PADDING;
+			shelf_height = std::max(shelf_height, rc.height() + PADDING);
+		}
+		const auto atlas_height = pos.y() + shelf_height;
+
+		m_Image = QImage(std::max(1, atlas_width), std::max(1, atlas_height), QImage::Format_ARGB32_Premultiplied);
+		m_Image.fill(Qt::transparent);
+		{
+			QPainter painter(&m_Image);
+			painter.setCompositionMode(QPainter::CompositionMode_Source);
+			for (size_t sprite_index = 0; sprite_index < m_Sprites.size(); ++sprite_index)
+			{
+				painter.drawPixmap(m_Sprites[sprite_index].SourceRect.topLeft(), m_PendingPixmaps[sprite_index]);
+			}
+		}
+		m_Pixmap = QPixmap::fromImage(m_Image);
+
+		m_PendingPixmaps.clear();
+	}
+
+	QRect CSpriteAtlas::SpriteRect(size_t index) const
+	{
+		const auto& sprite = m_Sprites[index];
+		return QRect(-sprite.Origin, sprite.SourceRect.size());
+	}
+
+	void CSpriteAtlas::DrawSprite(size_t index, QPainter& painter, const QPoint& at) const
+	{
+		ASSERT(m_PendingPixmaps.empty() && "Pack the atlas before drawing");
+		const auto& sprite = m_Sprites[index];
+		painter.drawPixmap(at - sprite.Origin, m_Pixmap, sprite.SourceRect);
+	}
+
+	void CSpriteAtlas::DrawFragments(const std::span<const QPainter::PixmapFragment>& fragments, QPainter& painter) const
+	{
+		ASSERT(m_PendingPixmaps.empty() && "Pack the atlas before drawing");
+		if (!fragments.empty())
+		{
+			painter.drawPixmapFragments(fragments.data(), (int)fragments.size(), m_Pixmap);
+		}
+	}
+
+	void CSpriteAtlas::DrawFragments(const std::span<const QPainter::PixmapFragment>& fragments, const QImage& image, QPainter& painter)
+	{
+		// Fragments are unscaled and unrotated, as AddFragment creates them
+		for (const auto& fragment : fragments)
+		{
+			const QPointF top_left(fragment.x - .5 * fragment.width, fragment.y - .5 * fragment.height);
+			painter.drawImage(top_left, image, QRectF(fragment.sourceLeft, fragment.sourceTop, fragment.width, fragment.height));
+		}
+	}
+}
@@ -0,0 +1,83 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <QtGui/qimage.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qpixmap.h>
+
+namespace jass
+{
+	// Sprites packed into a single pixmap, so that any number of them can be drawn with one call
+	// to QPainter::drawPixmapFragments
+	class CSpriteAtlas
+	{
+	public:
+		void Clear();
+
+		// Sprites get indices in the order they are added, and are placed in the atlas by Pack.
+		// Clear a packed atlas before adding more.
+		size_t Add(QPixmap&& pixmap, const QPoint& origin);
+
+		void Pack();
+
+		inline size_t Count() const { return m_Sprites.size(); }
+
+		inline bool Empty() const { return m_Sprites.empty(); }
+
+		QRect SpriteRect(size_t index) const;
+
+		void DrawSprite(size_t index, QPainter& painter, const QPoint& at) const;
+
+		inline void AddFragment(std::vector<QPainter::PixmapFragment>& fragments, size_t index, const QPoint& at) const;
+
+		void DrawFragments(const std::span<const QPainter::PixmapFragment>& fragments, QPainter& painter) const;
+
+		// The atlas as an image, for drawing fragments on threads other than the UI thread
+		inline const QImage& Image() const { return m_Image; }
+
+		static void DrawFragments(const std::span<const QPainter::PixmapFragment>& fragments, const QImage& image, QPainter& painter);
+
+	private:
+		static const int PADDING = 1;
+
+		struct SSprite
+		{
+			QRect  SourceRect;
+			QPoint Origin;
+		};
+
+		std::vector<SSprite> m_Sprites;
+		std::vector<QPixmap> m_PendingPixmaps;
+		QImage m_Image;
+		QPixmap m_Pixmap;
+	};
+
+	inline void CSpriteAtlas::AddFragment(std::vector<QPainter::PixmapFragment>& fragments, size_t index, const QPoint& at) const
+	{
+		const auto& sprite = m_Sprites[index];
+		const auto& rc = sprite.SourceRect;
+		// Fragments are positioned by their center
+		const QPointF center(at.x() - sprite.Origin.x() + .5 * rc.width(), at.y() - sprite.Origin.y() + .5 * rc.height());
+		fragments.push_back(QPainter::PixmapFragment::create(center, rc));
+	}
+}
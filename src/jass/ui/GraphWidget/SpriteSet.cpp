@@ -29,6 +29,7 @@ namespace jass
 	void CSpriteSet::Clear()
 	{
 		m_Sprites.clear();
+		m_AtlasValid = false;
 	}
 
 	size_t CSpriteSet::AddSprite(QPixmap&& pixmap, const QPoint& origin)
@@ -40,22 +41,26 @@ namespace jass
 	void CSpriteSet::UpdateSprite(size_t index, QPixmap&& pixmap, const QPoint& origin)
 	{
 		m_Sprites[index] = { std::move(pixmap), origin };
+		m_AtlasValid = false;
 	}
 
 	void CSpriteSet::RemoveSprites(size_t first, size_t count)
 	{
 		auto it = m_Sprites.begin() + first;
 		m_Sprites.erase(it, it + count);
+		m_AtlasValid = false;
 	}
 
 	void CSpriteSet::InsertSprite(size_t index, QPixmap&& pixmap, const QPoint& origin)
 	{
 		m_Sprites.insert(m_Sprites.begin() + index, { std::move(pixmap), origin });
+		m_AtlasValid = false;
 	}
 
 	void CSpriteSet::InsertSprites(size_t index, size_t count)
 	{
 		m_Sprites.insert(m_Sprites.begin() + index, count, {});
+		m_AtlasValid = false;
 	}
 
 	QRect CSpriteSet::SpriteRect(size_t index) const
@@ -70,4 +75,19 @@ namespace jass
 		const auto& sprite = m_Sprites[index];
 		painter.drawPixmap(at - sprite.Origin, sprite.Pixmap);
 	}
+
+	const CSpriteAtlas& CSpriteSet::Atlas() const
+	{
+		if (!m_AtlasValid)
+		{
+			m_Atlas.Clear();
+			for (const auto& sprite : m_Sprites)
+			{
+				m_Atlas.Add(QPixmap(sprite.Pixmap), sprite.Origin);
+			}
+			m_Atlas.Pack();
+			m_AtlasValid = true;
+		}
+		return m_Atlas;
+	}
 }
\ No newline at end of file
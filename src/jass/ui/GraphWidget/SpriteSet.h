@@ -22,6 +22,7 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 #include <vector>
 #include <QtCore/qpoint.h>
 #include <QtGui/qpixmap.h>
+#include "SpriteAtlas.h"
 
 namespace jass
 {
@@ -34,7 +35,7 @@ namespace jass
 
 		inline size_t Count() const { return m_Sprites.size(); }
 
-		inline void Resize(size_t count) { m_Sprites.resize(count); }
+		inline void Resize(size_t count) { m_Sprites.resize(count); m_AtlasValid = false; }
 
 		size_t AddSprite(QPixmap&& pixmap, const QPoint& origin);
 
@@ -50,6 +51,10 @@ namespace jass
 
 		void DrawSprite(size_t index, QPainter& painter, const QPoint& at) const;
 
+		// All sprites packed into one pixmap, with the same indices as in the set. Repacked on
+		// first use after any change.
+		const CSpriteAtlas& Atlas() const;
+
 	private:
 		struct SSprite
 		{
@@ -58,5 +63,7 @@ namespace jass
 		};
 
 		std::vector<SSprite> m_Sprites;
+		mutable CSpriteAtlas m_Atlas;
+		mutable bool m_AtlasValid = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,440 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <QtGui/qpainter.h>
+#include <QtGui/qregion.h>
+
+#include "TileCache.h"
+
+namespace jass
+{
+	static int FloorDiv(int a, int b)
+	{
+		return (a >= 0) ? (a / b) : -((b - 1 - a) / b);
+	}
+
+	CTileCache::CTileCache(CTileRenderWorker* render_worker)
+		: m_RenderWorker(render_worker)
+	{
+	}
+
+	CTileCache::~CTileCache()
+	{
+		if (m_RenderWorker)
+		{
+			CTileRenderWorker::SFrame frame;
+			m_RenderWorker->TryWithdraw(this, frame);
+		}
+	}
+
+	void CTileCache::Clear()
+	{
+		m_Levels.clear();
+		m_CurrentLevel = 0;
+		m_Tiles.clear();
+		m_TileIndexByKey.clear();
+		m_ByteCount = 0;
+	}
+
+	void CTileCache::Invalidate(const QRect& rc, float zoom)
+	{
+		DropOtherLevels(zoom);
+
+		if (rc.isEmpty())
+		{
+			return;
+		}
+		const auto x0 = FloorDiv(rc.left(), TILE_SIZE);
+		const auto y0 = FloorDiv(rc.top(), TILE_SIZE);
+		const auto x1 = FloorDiv(rc.right(), TILE_SIZE);
+		const auto y1 = FloorDiv(rc.bottom(), TILE_SIZE);
+		for (int y = y0; y <= y1; ++y)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				if (auto* tile_index = m_TileIndexByKey.find(TileKey(m_CurrentLevel, x, y)))
+				{
+					auto& tile = m_Tiles[*tile_index];
+					tile.Dirty = tile.Dirty.united(rc.intersected(TileRect(tile)));
+					tile.Generation = NewGeneration();
+				}
+			}
+		}
+	}
+
+	void CTileCache::InvalidateAll(float zoom)
+	{
+		DropOtherLevels(zoom);
+
+		for (auto& tile : m_Tiles)
+		{
+			tile.Dirty = TileRect(tile);
+			tile.Generation = NewGeneration();
+		}
+	}
+
+	void CTileCache::Paint(QPainter& painter, const QRegion& region, const QPoint& origin, float zoom, qreal device_pixel_ratio, const render_fn_t& render, const snapshot_fn_t& snapshot)
+	{
+		if (device_pixel_ratio != m_DevicePixelRatio)
+		{
+			Clear();
+			m_DevicePixelRatio = device_pixel_ratio;
+		}
+		m_CurrentLevel = FindOrAddLevel(zoom);
+		++m_Frame;
+
+		const bool render_async = m_RenderWorker && snapshot;
+		m_TempTileIndices.clear();
+		if (render_async)
+		{
+			// A frame still queued is superseded by the one of this paint, which takes over its tiles.
+			// Tiles of other zoom levels are submitted again when drawn.
+			CTileRenderWorker::SFrame queued_frame;
+			if (m_RenderWorker->TryWithdraw(this, queued_frame))
+			{
+				for (const auto& frame_tile : queued_frame.Tiles)
+				{
+					auto* tile_index = m_TileIndexByKey.find(frame_tile.Key);
+					if (!tile_index || m_Tiles[*tile_index].Dirty.isEmpty())
+					{
+						continue;
+					}
+					auto& tile = m_Tiles[*tile_index];
+					if (tile.Level == m_CurrentLevel)
+					{
+						tile.SubmittedGeneration = tile.Generation;
+						m_TempTileIndices.push_back(*tile_index);
+					}
+					else
+					{
+						tile.SubmittedGeneration = NO_GENERATION;
+					}
+				}
+			}
+		}
+
+		m_TempVisibleTileIndices.clear();
+		for (const auto& rc : region)
+		{
+			const auto x0 = FloorDiv(rc.left(), TILE_SIZE);
+			const auto y0 = FloorDiv(rc.top(), TILE_SIZE);
+			const auto x1 = FloorDiv(rc.right(), TILE_SIZE);
+			const auto y1 = FloorDiv(rc.bottom(), TILE_SIZE);
+			for (int y = y0; y <= y1; ++y)
+			{
+				for (int x = x0; x <= x1; ++x)
+				{
+					auto& tile = FindOrAddTile(m_CurrentLevel, x, y, device_pixel_ratio);
+					if (tile.LastUsedFrame == m_Frame)
+					{
+						// Also touched by an earlier rect
+						continue;
+					}
+					tile.LastUsedFrame = m_Frame;
+					m_TempVisibleTileIndices.push_back((uint32_t)(&tile - m_Tiles.data()));
+					// Tiles of a frame being rendered are left to it
+					if (!tile.Dirty.isEmpty() && tile.SubmittedGeneration != tile.Generation)
+					{
+						m_TempTileIndices.push_back((uint32_t)(&tile - m_Tiles.data()));
+					}
+				}
+			}
+		}
+
+		if (!m_TempTileIndices.empty() && !(render_async && SubmitTiles(origin, snapshot)))
+		{
+			RenderTiles(origin, render);
+		}
+
+		if (m_TempVisibleTileIndices.empty())
+		{
+			return;
+		}
+		QRegion placeholder_region;
+		for (const auto tile_index : m_TempVisibleTileIndices)
+		{
+			const auto& tile = m_Tiles[tile_index];
+			if (tile.Rendered)
+			{
+				painter.drawImage(TileRect(tile).topLeft() + origin, tile.Image);
+			}
+			else
+			{
+				placeholder_region += region.intersected(TileRect(tile));
+			}
+		}
+		if (!placeholder_region.isEmpty())
+		{
+			DrawPlaceholders(painter, placeholder_region, origin);
+		}
+
+		EvictTiles();
+	}
+
+	QRect CTileCache::ApplyRenderedFrame(CTileRenderWorker::SFrame& frame)
+	{
+		QRect rc_updated;
+		for (auto& frame_tile : frame.Tiles)
+		{
+			auto* tile_index = m_TileIndexByKey.find(frame_tile.Key);
+			if (!tile_index)
+			{
+				continue;
+			}
+			auto& tile = m_Tiles[*tile_index];
+			if (tile.Generation != frame_tile.Generation)
+			{
+				// Invalidated since, a later frame renders it
+				continue;
+			}
+			tile.Image = std::move(frame_tile.Image);
+			tile.Dirty = QRect();
+			tile.Rendered = true;
+			if (tile.Level == m_CurrentLevel)
+			{
+				rc_updated = rc_updated.united(TileRect(tile));
+			}
+		}
+		return rc_updated;
+	}
+
+	void CTileCache::RenderTiles(const QPoint& origin, const render_fn_t& render)
+	{
+		for (const auto tile_index : m_TempTileIndices)
+		{
+			auto& tile = m_Tiles[tile_index];
+			const auto tile_origin = TileRect(tile).topLeft();
+			const auto rc_dirty_local = tile.Dirty.translated(-tile_origin);
+			QPainter tile_painter(&tile.Image);
+			tile_painter.setCompositionMode(QPainter::CompositionMode_Source);
+			tile_painter.fillRect(rc_dirty_local, Qt::transparent);
+			tile_painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+			tile_painter.setClipRect(rc_dirty_local);
+			tile_painter.translate(-(tile_origin + origin));
+			render(tile_painter, tile.Dirty.translated(origin));
+			tile.Dirty = QRect();
+			tile.Rendered = true;
+		}
+	}
+
+	bool CTileCache::SubmitTiles(const QPoint& origin, const snapshot_fn_t& snapshot)
+	{
+		QRect rc_dirty;
+		for (const auto tile_index : m_TempTileIndices)
+		{
+			rc_dirty = rc_dirty.united(m_Tiles[tile_index].Dirty);
+		}
+
+		CTileRenderWorker::SFrame frame;
+		frame.Owner = this;
+		if (!snapshot(rc_dirty.translated(origin), frame.Snapshots))
+		{
+			return false;
+		}
+		frame.Tiles.reserve(m_TempTileIndices.size());
+		for (const auto tile_index : m_TempTileIndices)
+		{
+			auto& tile = m_Tiles[tile_index];
+			frame.Tiles.push_back({ TileKey(tile.Level, tile.X, tile.Y), tile.Generation, tile.Image, TileRect(tile).topLeft() + origin, tile.Dirty.translated(origin) });
+			tile.SubmittedGeneration = tile.Generation;
+		}
+		m_RenderWorker->Submit(std::move(frame));
+		return true;
+	}
+
+	void CTileCache::DrawPlaceholders(QPainter& painter, const QRegion& region, const QPoint& origin) const
+	{
+		// Until tiles are first rendered, stretch what the most recently drawn other zoom level has
+		// of their area, which is there when zooming
+		const STile* latest_tile = nullptr;
+		for (const auto& tile : m_Tiles)
+		{
+			if (tile.Level != m_CurrentLevel && tile.Rendered && (!latest_tile || tile.LastUsedFrame > latest_tile->LastUsedFrame))
+			{
+				latest_tile = &tile;
+			}
+		}
+		if (!latest_tile)
+		{
+			return;
+		}
+		const auto level = latest_tile->Level;
+
+		// Content coordinates are proportional to model coordinates over zoom
+		const qreal scale = (qreal)m_Levels[level] / m_Levels[m_CurrentLevel];
+		const QRectF rc_region = region.boundingRect();
+		painter.save();
+		painter.setClipRegion(region.translated(origin));
+		painter.setRenderHint(QPainter::SmoothPixmapTransform);
+		for (const auto& tile : m_Tiles)
+		{
+			if (tile.Level != level || !tile.Rendered)
+			{
+				continue;
+			}
+			const QRectF rc_tile(QPointF(TileRect(tile).topLeft()) * scale, QSizeF(TILE_SIZE * scale, TILE_SIZE * scale));
+			if (rc_tile.intersects(rc_region))
+			{
+				painter.drawImage(rc_tile.translated(origin), tile.Image);
+			}
+		}
+		painter.restore();
+	}
+
+	uint64_t CTileCache::TileKey(uint8_t level, int x, int y)
+	{
+		// 28 bits per coordinate. Levels are far below 255, so no key collides with the empty key.
+		return ((uint64_t)level << 56) | ((uint64_t)(x & 0xfffffff) << 28) | (uint64_t)(y & 0xfffffff);
+	}
+
+	uint32_t CTileCache::NewGeneration()
+	{
+		// Shared by all caches, so that frames rendered for a cache since destroyed match no tile
+		// of one created in its place
+		static uint32_t s_LastGeneration = NO_GENERATION;
+		if (++s_LastGeneration == NO_GENERATION)
+		{
+			++s_LastGeneration;
+		}
+		return s_LastGeneration;
+	}
+
+	uint8_t CTileCache::FindOrAddLevel(float zoom)
+	{
+		for (size_t level = 0; level < m_Levels.size(); ++level)
+		{
+			if (m_Levels[level] == zoom)
+			{
+				return (uint8_t)level;
+			}
+		}
+		if (m_Levels.size() >= MAX_LEVEL_COUNT)
+		{
+			// Recycle the level least recently drawn
+			std::vector<uint32_t> last_used_frame(m_Levels.size(), 0);
+			for (const auto& tile : m_Tiles)
+			{
+				last_used_frame[tile.Level] = std::max(last_used_frame[tile.Level], tile.LastUsedFrame);
+			}
+			const auto level = (uint8_t)(std::min_element(last_used_frame.begin(), last_used_frame.end()) - last_used_frame.begin());
+			RemoveTiles([&](const STile& tile) { return tile.Level == level; });
+			m_Levels[level] = zoom;
+			return level;
+		}
+		m_Levels.push_back(zoom);
+		return (uint8_t)(m_Levels.size() - 1);
+	}
+
+	void CTileCache::DropOtherLevels(float zoom)
+	{
+		m_CurrentLevel = FindOrAddLevel(zoom);
+		if (m_Levels.size() > 1)
+		{
+			RemoveTiles([&](const STile& tile) { return tile.Level != m_CurrentLevel; });
+			for (auto& tile : m_Tiles)
+			{
+				// Frames being rendered go by the old keys, so submit their tiles again
+				tile.Level = 0;
+				tile.SubmittedGeneration = NO_GENERATION;
+			}
+			m_Levels.assign(1, zoom);
+			m_CurrentLevel = 0;
+			RebuildTileIndex();
+		}
+	}
+
+	CTileCache::STile& CTileCache::FindOrAddTile(uint8_t level, int x, int y, qreal device_pixel_ratio)
+	{
+		const auto key = TileKey(level, x, y);
+		if (auto* tile_index = m_TileIndexByKey.find(key))
+		{
+			return m_Tiles[*tile_index];
+		}
+
+		m_TileIndexByKey.insert(key, (uint32_t)m_Tiles.size());
+		auto& tile = m_Tiles.emplace_back();
+		tile.Level = level;
+		tile.X = x;
+		tile.Y = y;
+		const auto pixel_size = (int)std::ceil(TILE_SIZE * device_pixel_ratio);
+		tile.Image = QImage(pixel_size, pixel_size, QImage::Format_ARGB32_Premultiplied);
+		tile.Image.setDevicePixelRatio(device_pixel_ratio);
+		tile.Dirty = TileRect(tile);
+		tile.Rendered = false;
+		tile.Generation = NewGeneration();
+		tile.SubmittedGeneration = NO_GENERATION;
+		tile.LastUsedFrame = m_Frame - 1;  // Not drawn yet, Paint marks it
+		m_ByteCount += tile.Image.sizeInBytes();
+		return tile;
+	}
+
+	template <class TPred>
+	void CTileCache::RemoveTiles(TPred&& pred)
+	{
+		auto it = std::remove_if(m_Tiles.begin(), m_Tiles.end(), [&](const STile& tile)
+			{
+				if (!pred(tile))
+				{
+					return false;
+				}
+				m_ByteCount -= tile.Image.sizeInBytes();
+				return true;
+			});
+		if (it == m_Tiles.end())
+		{
+			return;
+		}
+		m_Tiles.erase(it, m_Tiles.end());
+		RebuildTileIndex();
+	}
+
+	void CTileCache::RebuildTileIndex()
+	{
+		m_TileIndexByKey.clear();
+		for (uint32_t tile_index = 0; tile_index < (uint32_t)m_Tiles.size(); ++tile_index)
+		{
+			const auto& tile = m_Tiles[tile_index];
+			m_TileIndexByKey.insert(TileKey(tile.Level, tile.X, tile.Y), tile_index);
+		}
+	}
+
+	void CTileCache::EvictTiles()
+	{
+		if (m_ByteCount <= MAX_BYTE_COUNT)
+		{
+			return;
+		}
+
+		// Drop least recently drawn tiles first, but never the ones on screen
+		std::vector<uint32_t> frames;
+		frames.reserve(m_Tiles.size());
+		for (const auto& tile : m_Tiles)
+		{
+			frames.push_back(tile.LastUsedFrame);
+		}
+		std::sort(frames.begin(), frames.end());
+		const auto bytes_per_tile = m_Tiles.front().Image.sizeInBytes();
+		const auto excess_tile_count = (size_t)((m_ByteCount - MAX_BYTE_COUNT + bytes_per_tile - 1) / bytes_per_tile);
+		const auto oldest_kept_frame = std::min(frames[std::min(excess_tile_count, frames.size() - 1)], m_Frame);
+		RemoveTiles([&](const STile& tile) { return tile.LastUsedFrame < oldest_kept_frame; });
+	}
+}
@@ -0,0 +1,130 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <QtCore/qrect.h>
+#include <QtGui/qimage.h>
+#include <jass/utils/flat_hash_map.h>
+#include "TileRenderWorker.hpp"
+
+class QPainter;
+class QRegion;
+
+namespace jass
+{
+	// Offscreen raster cache of what a group of layers draws, split into square tiles. Tiles are
+	// addressed in content coordinates, i.e. screen coordinates without the view translation, so
+	// they stay valid while panning. Tiles of a few zoom levels are kept at a time.
+	//
+	// With a render worker, invalidated tiles are rendered from snapshots on its thread, and drawn
+	// as last rendered until then.
+	class CTileCache
+	{
+	public:
+		static constexpr int TILE_SIZE = 256;
+
+		// Renders the content in 'rc', in screen coordinates
+		typedef std::function<void(QPainter& painter, const QRect& rc)> render_fn_t;
+
+		// Takes snapshots of the content in 'rc', in screen coordinates, or returns false if it can
+		// only be rendered on the UI thread
+		typedef std::function<bool(const QRect& rc, CTileRenderWorker::snapshots_t& out_snapshots)> snapshot_fn_t;
+
+		CTileCache(CTileRenderWorker* render_worker = nullptr);
+		~CTileCache();
+
+		void Clear();
+
+		// Marks the tile parts intersecting 'rc' (content coordinates at 'zoom') for re-rendering.
+		// Tiles of other zoom levels are dropped.
+		void Invalidate(const QRect& rc, float zoom);
+
+		// Marks all tiles for re-rendering, which unlike Clear lets the render worker replace them
+		// while they are still drawn. Tiles of other zoom levels are dropped.
+		void InvalidateAll(float zoom);
+
+		// Draws the content intersecting 'region' (content coordinates) with the content origin at
+		// 'origin' on screen. Missing and invalidated tile parts are rendered with 'render' first, or
+		// submitted to the render worker with snapshots from 'snapshot' if there is one. Only tiles
+		// that the rects of 'region' touch are visited.
+		void Paint(QPainter& painter, const QRegion& region, const QPoint& origin, float zoom, qreal device_pixel_ratio, const render_fn_t& render, const snapshot_fn_t& snapshot = nullptr);
+
+		// Takes the tiles of a frame from the render worker that are still current. Returns their
+		// rect at the current zoom level (content coordinates), for repainting.
+		QRect ApplyRenderedFrame(CTileRenderWorker::SFrame& frame);
+
+	private:
+		struct STile
+		{
+			uint8_t Level;
+			int X;
+			int Y;
+			QImage Image;
+			QRect Dirty;  // Content coordinates
+			bool Rendered;
+			uint32_t Generation;           // Renewed whenever the tile is invalidated
+			uint32_t SubmittedGeneration;  // Of the last frame submitted to the render worker
+			uint32_t LastUsedFrame;
+		};
+
+		static constexpr size_t MAX_LEVEL_COUNT = 8;
+		static constexpr size_t MAX_BYTE_COUNT = 96 << 20;
+		static constexpr uint32_t NO_GENERATION = 0;
+
+		static uint64_t TileKey(uint8_t level, int x, int y);
+
+		static uint32_t NewGeneration();
+
+		inline QRect TileRect(const STile& tile) const { return QRect(tile.X * TILE_SIZE, tile.Y * TILE_SIZE, TILE_SIZE, TILE_SIZE); }
+
+		uint8_t FindOrAddLevel(float zoom);
+
+		void DropOtherLevels(float zoom);
+
+		STile& FindOrAddTile(uint8_t level, int x, int y, qreal device_pixel_ratio);
+
+		template <class TPred>
+		void RemoveTiles(TPred&& pred);
+
+		void RebuildTileIndex();
+
+		void EvictTiles();
+
+		void RenderTiles(const QPoint& origin, const render_fn_t& render);
+
+		bool SubmitTiles(const QPoint& origin, const snapshot_fn_t& snapshot);
+
+		void DrawPlaceholders(QPainter& painter, const QRegion& region, const QPoint& origin) const;
+
+		CTileRenderWorker* m_RenderWorker;
+		std::vector<float> m_Levels;  // Zoom of each level
+		uint8_t m_CurrentLevel = 0;
+		qreal m_DevicePixelRatio = 0;
+		std::vector<STile> m_Tiles;
+		flat_hash_map<uint32_t> m_TileIndexByKey;
+		size_t m_ByteCount = 0;
+		uint32_t m_Frame = 0;
+		std::vector<uint32_t> m_TempTileIndices;  // Tiles to render
+		std::vector<uint32_t> m_TempVisibleTileIndices;
+	};
+}
@@ -0,0 +1,142 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <QtGui/qpainter.h>
+#include <jass/Debug.h>
+#include "GraphWidget.hpp"
+#include "TileRenderWorker.hpp"
+
+namespace jass
+{
+	CTileRenderWorker::CTileRenderWorker()
+	{
+	}
+
+	CTileRenderWorker::~CTileRenderWorker()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Queue.clear();
+		}
+
+		if (m_RenderThreadResult.valid())
+		{
+			m_RenderThreadResult.wait();
+		}
+	}
+
+	void CTileRenderWorker::Submit(SFrame&& frame)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			ASSERT(std::none_of(m_Queue.begin(), m_Queue.end(), [&](const SFrame& queued_frame) { return queued_frame.Owner == frame.Owner; }) && "Withdraw the queued frame first");
+			m_Queue.push_back(std::move(frame));
+			if (m_ThreadIsRunning)
+			{
+				// Running thread will pick up the frame
+				return;
+			}
+			m_ThreadIsRunning = true;
+		}
+
+		m_RenderThreadResult = std::async(std::launch::async, &CTileRenderWorker::RenderThread, this);
+	}
+
+	bool CTileRenderWorker::TryWithdraw(const CTileCache* owner, SFrame& out_frame)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		auto it = std::find_if(m_Queue.begin(), m_Queue.end(), [&](const SFrame& frame) { return frame.Owner == owner; });
+		if (it == m_Queue.end())
+		{
+			return false;
+		}
+
+		out_frame = std::move(*it);
+		m_Queue.erase(it);
+
+		return true;
+	}
+
+	bool CTileRenderWorker::TryGrabRendered(SFrame& out_frame)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		if (m_Rendered.empty())
+		{
+			return false;
+		}
+
+		out_frame = std::move(m_Rendered.front());
+		m_Rendered.erase(m_Rendered.begin());
+
+		return true;
+	}
+
+	void CTileRenderWorker::RenderThread()
+	{
+		while (true)
+		{
+			SFrame frame;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				if (m_Queue.empty())
+				{
+					m_ThreadIsRunning = false;
+					return;
+				}
+				frame = std::move(m_Queue.front());
+				m_Queue.pop_front();
+			}
+
+			for (auto& tile : frame.Tiles)
+			{
+				RenderTile(frame.Snapshots, tile);
+			}
+			// Release the snapshots here rather than on the UI thread
+			frame.Snapshots.clear();
+
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Rendered.push_back(std::move(frame));
+			}
+
+			emit FrameRendered();
+		}
+	}
+
+	void CTileRenderWorker::RenderTile(const snapshots_t& snapshots, STile& tile)
+	{
+		// Painting detaches the image from the one the UI thread goes on drawing until this is done
+		const auto rc_dirty_local = tile.Dirty.translated(-tile.Position);
+		QPainter painter(&tile.Image);
+		painter.setCompositionMode(QPainter::CompositionMode_Source);
+		painter.fillRect(rc_dirty_local, Qt::transparent);
+		painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+		painter.setClipRect(rc_dirty_local);
+		painter.translate(-tile.Position);
+		for (const auto& snapshot : snapshots)
+		{
+			snapshot->Paint(painter, tile.Dirty);
+		}
+	}
+}
+
+#include <moc_TileRenderWorker.cpp>
@@ -0,0 +1,85 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <QtCore/qobject.h>
+#include <QtCore/qrect.h>
+#include <QtGui/qimage.h>
+
+namespace jass
+{
+	class CTileCache;
+	class IGraphLayerSnapshot;
+
+	// Renders tiles of tile caches from layer snapshots on a background thread. Each cache keeps
+	// at most one frame queued, and withdraws it to merge into its next frame, so that frames
+	// submitted faster than they can be rendered are dropped rather than piling up.
+	class CTileRenderWorker: public QObject
+	{
+		Q_OBJECT
+	public:
+		typedef std::vector<std::shared_ptr<const IGraphLayerSnapshot>> snapshots_t;
+
+		struct STile
+		{
+			uint64_t Key;
+			uint32_t Generation;
+			QImage   Image;     // Tile as last rendered, which gets 'Dirty' rendered over
+			QPoint   Position;  // Screen position of the tile when the snapshots were taken
+			QRect    Dirty;     // Screen coordinates
+		};
+
+		struct SFrame
+		{
+			const CTileCache* Owner = nullptr;
+			snapshots_t Snapshots;  // Painted in order
+			std::vector<STile> Tiles;
+		};
+
+		CTileRenderWorker();
+		~CTileRenderWorker();
+
+		void Submit(SFrame&& frame);
+
+		// Takes back the frame of 'owner' if it hasn't started rendering yet
+		bool TryWithdraw(const CTileCache* owner, SFrame& out_frame);
+
+		bool TryGrabRendered(SFrame& out_frame);
+
+	Q_SIGNALS:
+		void FrameRendered();
+
+	private:
+		void RenderThread();
+
+		static void RenderTile(const snapshots_t& snapshots, STile& tile);
+
+		std::deque<SFrame> m_Queue;
+		std::vector<SFrame> m_Rendered;
+		bool m_ThreadIsRunning = false;
+		std::mutex m_Mutex;
+		std::future<void> m_RenderThreadResult;
+	};
+}
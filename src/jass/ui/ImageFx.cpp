@@ -17,12 +17,15 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <vector>
 
 #include <QtGui/QImage>
 
 #include "../math/Gaussian.h"
+#include "ImageFx.h"
 
 namespace jass
 {
@@ -55,7 +58,122 @@ namespace jass
 		return (color & 0xFFFFFF) | ((unsigned int)alpha << 24);
 	}
 
-	void DropShadow(QImage& img, QColor color, unsigned int radius, int offs_x, int offs_y, float sigma_range)
+	// The blurs below work on w x h float buffers and treat pixels outside as 0. Inner loops run
+	// along rows without branches, so that they can be vectorized.
+
+	static void ConvolveRows(const float* src, float* dst, int width, int height, const std::span<const float>& kernel)
+	{
+		const int radius = ((int)kernel.size() - 1) / 2;
+		std::fill(dst, dst + (size_t)width * height, 0.0f);
+		for (int y = 0; y < height; ++y)
+		{
+			const float* src_row = src + (size_t)y * width;
+			float* dst_row = dst + (size_t)y * width;
+			for (int i = -radius; i <= radius; ++i)
+			{
+				const float k = kernel[i + radius];
+				const int x_end = std::min(width, width - i);
+				for (int x = std::max(0, -i); x < x_end; ++x)
+				{
+					dst_row[x] += k * src_row[x + i];
+				}
+			}
+		}
+	}
+
+	static void ConvolveColumns(const float* src, float* dst, int width, int height, const std::span<const float>& kernel)
+	{
+		const int radius = ((int)kernel.size() - 1) / 2;
+		std::fill(dst, dst + (size_t)width * height, 0.0f);
+		for (int y = 0; y < height; ++y)
+		{
+			float* dst_row = dst + (size_t)y * width;
+			const int i_end = std::min(radius, height - 1 - y);
+			for (int i = std::max(-radius, -y); i <= i_end; ++i)
+			{
+				const float k = kernel[i + radius];
+				const float* src_row = src + (size_t)(y + i) * width;
+				for (int x = 0; x < width; ++x)
+				{
+					dst_row[x] += k * src_row[x];
+				}
+			}
+		}
+	}
+
+	static void BoxBlurRows(const float* src, float* dst, int width, int height, int radius)
+	{
+		const float scale = 1.0f / (2 * radius + 1);
+		for (int y = 0; y < height; ++y)
+		{
+			const float* src_row = src + (size_t)y * width;
+			float* dst_row = dst + (size_t)y * width;
+			float sum = 0.0f;
+			for (int x = 0; x < std::min(radius, width); ++x)
+			{
+				sum += src_row[x];
+			}
+			for (int x = 0; x < width; ++x)
+			{
+				if (x + radius < width)
+					sum += src_row[x + radius];
+				dst_row[x] = sum * scale;
+				if (x - radius >= 0)
+					sum -= src_row[x - radius];
+			}
+		}
+	}
+
+	static void BoxBlurColumns(const float* src, float* dst, int width, int height, int radius, std::vector<float>& sums)
+	{
+		const float scale = 1.0f / (2 * radius + 1);
+		sums.assign(width, 0.0f);
+		auto add_row = [&](int y, float sign)
+			{
+				const float* src_row = src + (size_t)y * width;
+				for (int x = 0; x < width; ++x)
+				{
+					sums[x] += sign * src_row[x];
+				}
+			};
+		for (int y = 0; y < std::min(radius, height); ++y)
+		{
+			add_row(y, 1.0f);
+		}
+		for (int y = 0; y < height; ++y)
+		{
+			if (y + radius < height)
+				add_row(y + radius, 1.0f);
+			float* dst_row = dst + (size_t)y * width;
+			for (int x = 0; x < width; ++x)
+			{
+				dst_row[x] = sums[x] * scale;
+			}
+			if (y - radius >= 0)
+				add_row(y - radius, -1.0f);
+		}
+	}
+
+	// Radii of three consecutive box blurs that together approximate a Gaussian with the given
+	// standard deviation (in pixels)
+	static void BoxRadiiForGaussian(float sigma, int (&out_radii)[3])
+	{
+		const int n = (int)std::size(out_radii);
+		const float ideal_width = std::sqrt(12.0f * sigma * sigma / n + 1.0f);
+		int width_lower = (int)ideal_width;
+		if (0 == width_lower % 2)
+			--width_lower;
+		width_lower = std::max(1, width_lower);
+		const int width_upper = width_lower + 2;
+		const float ideal_lower_count = (12.0f * sigma * sigma - n * width_lower * width_lower - 4.0f * n * width_lower - 3.0f * n) / (-4.0f * width_lower - 4.0f);
+		const int lower_count = (int)std::round(ideal_lower_count);
+		for (int i = 0; i < n; ++i)
+		{
+			out_radii[i] = ((i < lower_count ? width_lower : width_upper) - 1) / 2;
+		}
+	}
+
+	void DropShadow(QImage& img, QColor color, unsigned int radius, int offs_x, int offs_y, float sigma_range, EBlurQuality quality)
 	{
 		using namespace std;
 
@@ -64,51 +182,76 @@ namespace jass
 			throw std::runtime_error("Unsupported image format");
 		}
 
-		auto* blur_kernel = (float*)alloca((radius + 1) * sizeof(float));
-		GenerateGaussianKernel(sigma_range, std::span<float>(blur_kernel, radius + 1));
-
-		std::vector<float> tmp(img.width() * img.height());
-
+		const int width = img.width();
+		const int height = img.height();
 		unsigned char* const bits = img.bits();
 		const unsigned int   stride = img.bytesPerLine();
 
-		// Vertical pass
-		auto* dst = tmp.data();
-		for (int y = 0; y < (int)img.height(); ++y)
+		// Alpha of the image, in a buffer that also covers where it is seen from shifted by the shadow
+		// offset. Pixels shifted out of the image still blur into it.
+		const int buffer_width = width + abs(offs_x);
+		const int buffer_height = height + abs(offs_y);
+		std::vector<float> shadow((size_t)buffer_width * buffer_height, 0.0f);
+		for (int y = 0; y < height; ++y)
+		{
+			const auto* src = bits + y * stride;
+			float* dst = shadow.data() + (size_t)(y + max(0, offs_y)) * buffer_width + max(0, offs_x);
+			for (int x = 0; x < width; ++x)
+			{
+				dst[x] = (1.0f / 255.0f) * src[x * 4 + 3];
+			}
+		}
+
+		std::vector<float> tmp(shadow.size());
+		if (radius > 0)
 		{
-			const int y_min = -min(y - offs_y, (int)radius);
-			const int y_max = min((int)img.height() - y - 1 + offs_y, (int)radius);
-			for (int x = 0; x < (int)img.width(); ++x)
+			// Three box blurs only pay off from about this radius, so smaller ones are exact anyway
+			if (EBlurQuality::Exact == quality || radius < 5)
 			{
-				float s = 0.0f;
-				for (int i = y_min; i <= y_max; ++i)
+				auto* half_kernel = (float*)alloca((radius + 1) * sizeof(float));
+				GenerateGaussianKernel(sigma_range, std::span<float>(half_kernel, radius + 1));
+				std::vector<float> kernel(2 * radius + 1);
+				for (int i = 0; i <= (int)radius; ++i)
 				{
-					const auto alpha = bits[(y - offs_y + i) * stride + (x * 4) + 3];
-					s += blur_kernel[abs(i)] * (1.0f / 255.0f) * alpha;
+					kernel[radius - i] = kernel[radius + i] = half_kernel[i];
+				}
+				ConvolveColumns(shadow.data(), tmp.data(), buffer_width, buffer_height, kernel);
+				ConvolveRows(tmp.data(), shadow.data(), buffer_width, buffer_height, kernel);
+			}
+			else
+			{
+				// Same standard deviation as the kernel GenerateGaussianKernel makes
+				const float sigma = (0.5f + radius) / sigma_range;
+				int box_radii[3];
+				BoxRadiiForGaussian(sigma, box_radii);
+				std::vector<float> sums;
+				for (const auto box_radius : box_radii)
+				{
+					if (box_radius > 0)
+					{
+						BoxBlurColumns(shadow.data(), tmp.data(), buffer_width, buffer_height, box_radius, sums);
+						BoxBlurRows(tmp.data(), shadow.data(), buffer_width, buffer_height, box_radius);
+					}
 				}
-				*dst++ = s;
 			}
 		}
 
 		QRgb shadow_color = color.rgba();
 		const float opacity = (float)qAlpha(shadow_color) / 255.0f;
 
-		// Horizontal pass
-		const auto* src = tmp.data();
-		for (int y = 0; y < (int)img.height(); ++y)
+		for (int y = 0; y < height; ++y)
 		{
-			for (int x = 0; x < (int)img.width(); ++x)
+			auto* row = (QRgb*)(bits + y * stride);
+			const float* src = shadow.data() + (size_t)(y + max(0, -offs_y)) * buffer_width + max(0, -offs_x);
+			for (int x = 0; x < width; ++x)
 			{
-				const int x_min = -min(x - offs_x, (int)radius);
-				const int x_max = min((int)img.width() - x - 1 + offs_x, (int)radius);
-				float s = 0.0f;
-				for (int i = x_min; i <= x_max; ++i)
-					s += blur_kernel[abs(i)] * (*(src + i - offs_x));
-
-				shadow_color = qSetAlpha(shadow_color, (unsigned char)(0.5f + 255.0f * (s * opacity)));
-				auto& color = *(QRgb*)&bits[y * stride + (x * 4)];
-				color = AddOver(color, shadow_color);
-				++src;
+				const auto shadow_alpha = (unsigned char)(0.5f + 255.0f * std::clamp(src[x] * opacity, 0.0f, 1.0f));
+				// Nothing shows of the shadow under opaque pixels, and transparent shadow changes nothing
+				if (0 == shadow_alpha || 255 == qAlpha(row[x]))
+				{
+					continue;
+				}
+				row[x] = AddOver(row[x], qSetAlpha(shadow_color, shadow_alpha));
 			}
 		}
 	}
@@ -29,5 +29,13 @@ namespace jass
 		
 	QRgb AddOver(QRgb over, QRgb under);
 	
-	void DropShadow(QImage& img, QColor color, unsigned int radius, int offs_x, int offs_y, float sigma_range);
+	enum class EBlurQuality
+	{
+		Fast,   // Three box blurs approximating the Gaussian, cost independent of radius
+		Exact,  // Truncated Gaussian kernel
+	};
+
+	// Draws a blurred shadow of the image under it. 'radius' pixels of blur cover 'sigma_range'
+	// standard deviations of the Gaussian.
+	void DropShadow(QImage& img, QColor color, unsigned int radius, int offs_x, int offs_y, float sigma_range, EBlurQuality quality = EBlurQuality::Fast);
 }
\ No newline at end of file
@@ -17,45 +17,95 @@ You should have received a copy of the GNU General Public License along
 with JASS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+
 #include "bitvec.h"
 
 namespace jass
 {
-	bitvec& bitvec::bitwise_xor(const bitvec& a, const bitvec& b)
+	template <class TOp>
+	bitvec& bitvec::bitwise_op(const bitvec& a, const bitvec& b, TOp&& op)
 	{
+		const auto a_word_count = a.m_Words.size();
+		const auto b_word_count = b.m_Words.size();
 		resize(std::max(a.size(), b.size()));
-		const auto n = std::min(a.m_Words.size(), b.m_Words.size());
+
+		// Plain loops over raw words, which compilers vectorize
+		const word_t* a_words = a.m_Words.data();
+		const word_t* b_words = b.m_Words.data();
+		word_t* out_words = m_Words.data();
+		const auto n = std::min(a_word_count, b_word_count);
 		for (size_t i = 0; i < n; ++i)
 		{
-			m_Words[i] = a.m_Words[i] ^ b.m_Words[i];
+			out_words[i] = op(a_words[i], b_words[i]);
 		}
-		for (size_t i = n; i < a.m_Words.size(); ++i)
+		for (size_t i = n; i < a_word_count; ++i)
 		{
-			m_Words[i] = a.m_Words[i];
+			out_words[i] = op(a_words[i], (word_t)0);
 		}
-		for (size_t i = n; i < b.m_Words.size(); ++i)
+		for (size_t i = n; i < b_word_count; ++i)
 		{
-			m_Words[i] = b.m_Words[i];
+			out_words[i] = op((word_t)0, b_words[i]);
 		}
 		return *this;
 	}
 
+	bitvec& bitvec::bitwise_xor(const bitvec& a, const bitvec& b)
+	{
+		return bitwise_op(a, b, [](word_t x, word_t y) { return x ^ y; });
+	}
+
 	bitvec& bitvec::bitwise_or(const bitvec& a, const bitvec& b)
 	{
-		resize(std::max(a.size(), b.size()));
-		const auto n = std::min(a.m_Words.size(), b.m_Words.size());
-		for (size_t i = 0; i < n; ++i)
-		{
-			m_Words[i] = a.m_Words[i] | b.m_Words[i];
-		}
-		for (size_t i = n; i < a.m_Words.size(); ++i)
+		return bitwise_op(a, b, [](word_t x, word_t y) { return x | y; });
+	}
+
+	bitvec& bitvec::bitwise_and(const bitvec& a, const bitvec& b)
+	{
+		return bitwise_op(a, b, [](word_t x, word_t y) { return x & y; });
+	}
+
+	bitvec& bitvec::bitwise_andnot(const bitvec& a, const bitvec& b)
+	{
+		return bitwise_op(a, b, [](word_t x, word_t y) { return x & ~y; });
+	}
+
+	void bitvec::set_range(size_t first, size_t count)
+	{
+		fill_range(first, count, true);
+	}
+
+	void bitvec::clear_range(size_t first, size_t count)
+	{
+		fill_range(first, count, false);
+	}
+
+	void bitvec::fill_range(size_t first, size_t count, bool value)
+	{
+		QAPP_ASSERT(first + count <= m_Size);
+		if (0 == count)
 		{
-			m_Words[i] = a.m_Words[i];
+			return;
 		}
-		for (size_t i = n; i < b.m_Words.size(); ++i)
+
+		const auto last = first + count - 1;
+		const auto first_word = first / WORD_BIT_COUNT;
+		const auto last_word = last / WORD_BIT_COUNT;
+		const auto first_mask = (word_t)-1 << (first % WORD_BIT_COUNT);
+		const auto last_mask = (word_t)-1 >> (WORD_BIT_COUNT - 1 - last % WORD_BIT_COUNT);
+
+		auto apply = [&](word_t& w, word_t mask)
+			{
+				w = value ? (w | mask) : (w & ~mask);
+			};
+
+		if (first_word == last_word)
 		{
-			m_Words[i] = b.m_Words[i];
+			apply(m_Words[first_word], first_mask & last_mask);
+			return;
 		}
-		return *this;
+		apply(m_Words[first_word], first_mask);
+		std::fill(m_Words.begin() + first_word + 1, m_Words.begin() + last_word, value ? (word_t)-1 : (word_t)0);
+		apply(m_Words[last_word], last_mask);
 	}
-}
\ No newline at end of file
+}
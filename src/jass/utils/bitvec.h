@@ -45,6 +45,11 @@ namespace jass
 
 		inline void set_all();
 
+		// Sets or clears bits [first, first + count)
+		void set_range(size_t first, size_t count);
+
+		void clear_range(size_t first, size_t count);
+
 		inline size_t size() const;
 
 		inline bool empty() const;
@@ -65,15 +70,32 @@ namespace jass
 
 		inline size_t count_set_bits() const;
 
+		inline bool any() const;
+
+		// The result has the size of the larger operand, and the smaller operand is treated as
+		// zero-extended. Either operand may be *this.
 		bitvec& bitwise_xor(const bitvec& a, const bitvec& b);
 
 		bitvec& bitwise_or(const bitvec& a, const bitvec& b);
 
+		bitvec& bitwise_and(const bitvec& a, const bitvec& b);
+
+		// a & ~b
+		bitvec& bitwise_andnot(const bitvec& a, const bitvec& b);
+
+		// Returns npos if there is no set bit at or after start_index
 		inline size_t find_next_set_bit(size_t start_index = 0) const;
 
+		// Returns npos if there is no clear bit at or after start_index
+		inline size_t find_next_clear_bit(size_t start_index = 0) const;
+
 		template <class TLambda>
 		void for_each_set_bit(TLambda&& fn) const;
 
+		// Calls fn(first, count) for every run of consecutive set bits
+		template <class TLambda>
+		void for_each_set_bit_run(TLambda&& fn) const;
+
 		void* data() { return m_Words.data(); }
 
 		const void* data() const { return m_Words.data(); }
@@ -81,10 +103,15 @@ namespace jass
 		size_t dataByteSize() const { return m_Words.size() * sizeof(word_t); }
 
 	private:
+		typedef size_t word_t;
+		static constexpr size_t WORD_BIT_COUNT = sizeof(word_t) * 8;
+
 		inline void clear_overflow_bits();
 
-		typedef size_t word_t;
-		const word_t WORD_BIT_COUNT = sizeof(word_t) * 8;
+		template <class TOp>
+		bitvec& bitwise_op(const bitvec& a, const bitvec& b, TOp&& op);
+
+		void fill_range(size_t first, size_t count, bool value);
 		
 		size_t m_Size = 0;
 		std::vector<word_t> m_Words;
@@ -182,14 +209,26 @@ namespace jass
 		return count;
 	}
 
-	size_t bitvec::find_next_set_bit(size_t start_index) const
+	inline bool bitvec::any() const
+	{
+		for (auto word : m_Words)
+		{
+			if (word)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline size_t bitvec::find_next_set_bit(size_t start_index) const
 	{
 		if (start_index >= m_Size)
 		{
 			return bitvec::npos;
 		}
-		auto word_index = start_index >> WORD_BIT_COUNT;
-		auto w = m_Words[word_index] & ((size_t)-1 << (start_index % WORD_BIT_COUNT));
+		auto word_index = start_index / WORD_BIT_COUNT;
+		auto w = m_Words[word_index] & ((word_t)-1 << (start_index % WORD_BIT_COUNT));
 		while (0 == w)
 		{
 			++word_index;
@@ -199,7 +238,28 @@ namespace jass
 			}
 			w = m_Words[word_index];
 		}
-		return (w << WORD_BIT_COUNT) + std::countr_zero(w);
+		return word_index * WORD_BIT_COUNT + std::countr_zero(w);
+	}
+
+	inline size_t bitvec::find_next_clear_bit(size_t start_index) const
+	{
+		if (start_index >= m_Size)
+		{
+			return bitvec::npos;
+		}
+		auto word_index = start_index / WORD_BIT_COUNT;
+		auto w = ~m_Words[word_index] & ((word_t)-1 << (start_index % WORD_BIT_COUNT));
+		while (0 == w)
+		{
+			++word_index;
+			if (word_index >= m_Words.size())
+			{
+				return bitvec::npos;
+			}
+			w = ~m_Words[word_index];
+		}
+		const auto index = word_index * WORD_BIT_COUNT + std::countr_zero(w);
+		return (index < m_Size) ? index : bitvec::npos;  // Overflow bits are clear
 	}
 
 	template <class TLambda>
@@ -218,9 +278,24 @@ namespace jass
 		}
 	}
 
+	template <class TLambda>
+	void bitvec::for_each_set_bit_run(TLambda&& fn) const
+	{
+		for (auto first = find_next_set_bit(); bitvec::npos != first; )
+		{
+			auto end = find_next_clear_bit(first);
+			if (bitvec::npos == end)
+			{
+				end = m_Size;
+			}
+			fn(first, end - first);
+			first = find_next_set_bit(end);
+		}
+	}
+
 	inline void bitvec::clear_overflow_bits()
 	{
-		if (!m_Words.empty())
+		if (0 != m_Size % WORD_BIT_COUNT)
 		{
 			m_Words.back() &= ((word_t)-1 >> (WORD_BIT_COUNT - (m_Size % WORD_BIT_COUNT)));
 		}
@@ -238,7 +313,7 @@ namespace jass
 		class Iterator
 		{
 		public:
-			Iterator(const bitvec& bits, size_t index) : m_Bits(bits) {}
+			Iterator(const bitvec& bits, size_t index) : m_Bits(bits), m_Index(index) {}
 
 			TIndex operator*() const
 			{
@@ -248,7 +323,7 @@ namespace jass
 			Iterator& operator++()
 			{
 				QAPP_ASSERT(m_Index != bitvec::npos);
-				m_Index = m_Bits.find_next_set_bit(m_Index);
+				m_Index = m_Bits.find_next_set_bit(m_Index + 1);
 				return *this;
 			}
 
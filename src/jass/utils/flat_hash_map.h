@@ -0,0 +1,276 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <jass/Debug.h>
+
+namespace jass
+{
+	// Open-addressing hash map with linear probing for 64-bit integer keys. Entries are stored
+	// inline in a single array, and erase shifts following entries back instead of leaving
+	// tombstones. 'EmptyKey' is reserved: it is never found, and inserting it fails.
+	template <typename TValue, uint64_t EmptyKey = (uint64_t)-1>
+	class flat_hash_map
+	{
+	public:
+		typedef uint64_t key_type;
+		typedef TValue mapped_type;
+
+		inline size_t size() const { return m_Size; }
+
+		inline bool empty() const { return 0 == m_Size; }
+
+		inline void clear();
+
+		inline void reserve(size_t count);
+
+		// Returns nullptr if key is not in map
+		inline const TValue* find(key_type key) const;
+		inline TValue* find(key_type key);
+
+		// Returns false, and leaves the map unchanged, if key is already in map or is EmptyKey
+		inline bool insert(key_type key, const TValue& value);
+
+		// Returns false if key is not in map
+		inline bool erase(key_type key);
+
+		// Calls fn(key, value&) for every entry, in no particular order
+		template <typename TFunc>
+		inline void for_each(TFunc&& fn);
+		template <typename TFunc>
+		inline void for_each(TFunc&& fn) const;
+
+		// Replaces every value with fn(value) in a single pass over the table
+		template <typename TFunc>
+		inline void remap_values(TFunc&& fn);
+
+	private:
+		struct slot
+		{
+			key_type key;
+			TValue value;
+		};
+
+		static constexpr size_t MIN_CAPACITY = 16;
+
+		inline static size_t hash(key_type key);
+
+		inline size_t home_index(key_type key) const { return hash(key) & (m_Slots.size() - 1); }
+
+		inline size_t find_index(key_type key) const;
+
+		inline void rehash(size_t capacity);
+
+		std::vector<slot> m_Slots;  // Size is zero or a power of two
+		size_t m_Size = 0;
+	};
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline void flat_hash_map<TValue, EmptyKey>::clear()
+	{
+		for (auto& s : m_Slots)
+		{
+			s.key = EmptyKey;
+		}
+		m_Size = 0;
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline void flat_hash_map<TValue, EmptyKey>::reserve(size_t count)
+	{
+		// Keep load factor at most 3/4
+		size_t capacity = m_Slots.empty() ? MIN_CAPACITY : m_Slots.size();
+		while (capacity * 3 < count * 4)
+		{
+			capacity *= 2;
+		}
+		if (capacity != m_Slots.size())
+		{
+			rehash(capacity);
+		}
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline const TValue* flat_hash_map<TValue, EmptyKey>::find(key_type key) const
+	{
+		ASSERT(EmptyKey != key);
+		const auto index = find_index(key);
+		return (index < m_Slots.size()) ? &m_Slots[index].value : nullptr;
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline TValue* flat_hash_map<TValue, EmptyKey>::find(key_type key)
+	{
+		ASSERT(EmptyKey != key);
+		const auto index = find_index(key);
+		return (index < m_Slots.size()) ? &m_Slots[index].value : nullptr;
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline bool flat_hash_map<TValue, EmptyKey>::insert(key_type key, const TValue& value)
+	{
+		ASSERT(EmptyKey != key);
+		if (EmptyKey == key)
+		{
+			return false;
+		}
+		reserve(m_Size + 1);
+		const auto mask = m_Slots.size() - 1;
+		for (auto index = home_index(key); ; index = (index + 1) & mask)
+		{
+			auto& s = m_Slots[index];
+			if (EmptyKey == s.key)
+			{
+				s.key = key;
+				s.value = value;
+				++m_Size;
+				return true;
+			}
+			if (key == s.key)
+			{
+				return false;
+			}
+		}
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline bool flat_hash_map<TValue, EmptyKey>::erase(key_type key)
+	{
+		ASSERT(EmptyKey != key);
+		auto index = find_index(key);
+		if (index >= m_Slots.size())
+		{
+			return false;
+		}
+
+		// Shift back following entries in the probe sequence that would become unreachable
+		const auto mask = m_Slots.size() - 1;
+		for (auto next = (index + 1) & mask; EmptyKey != m_Slots[next].key; next = (next + 1) & mask)
+		{
+			const auto home = home_index(m_Slots[next].key);
+			if (((next - home) & mask) >= ((next - index) & mask))
+			{
+				m_Slots[index] = std::move(m_Slots[next]);
+				index = next;
+			}
+		}
+		m_Slots[index].key = EmptyKey;
+		--m_Size;
+		return true;
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	template <typename TFunc>
+	inline void flat_hash_map<TValue, EmptyKey>::for_each(TFunc&& fn)
+	{
+		for (auto& s : m_Slots)
+		{
+			if (EmptyKey != s.key)
+			{
+				fn(s.key, s.value);
+			}
+		}
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	template <typename TFunc>
+	inline void flat_hash_map<TValue, EmptyKey>::for_each(TFunc&& fn) const
+	{
+		for (const auto& s : m_Slots)
+		{
+			if (EmptyKey != s.key)
+			{
+				fn(s.key, s.value);
+			}
+		}
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	template <typename TFunc>
+	inline void flat_hash_map<TValue, EmptyKey>::remap_values(TFunc&& fn)
+	{
+		for (auto& s : m_Slots)
+		{
+			if (EmptyKey != s.key)
+			{
+				s.value = fn(s.value);
+			}
+		}
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline size_t flat_hash_map<TValue, EmptyKey>::hash(key_type key)
+	{
+		// Finalizer from MurmurHash3
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdull;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ull;
+		key ^= key >> 33;
+		return (size_t)key;
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline size_t flat_hash_map<TValue, EmptyKey>::find_index(key_type key) const
+	{
+		if (m_Slots.empty() || EmptyKey == key)
+		{
+			return (size_t)-1;
+		}
+		const auto mask = m_Slots.size() - 1;
+		for (auto index = home_index(key); ; index = (index + 1) & mask)
+		{
+			const auto& s = m_Slots[index];
+			if (key == s.key)
+			{
+				return index;
+			}
+			if (EmptyKey == s.key)
+			{
+				return (size_t)-1;
+			}
+		}
+	}
+
+	template <typename TValue, uint64_t EmptyKey>
+	inline void flat_hash_map<TValue, EmptyKey>::rehash(size_t capacity)
+	{
+		std::vector<slot> old_slots(capacity, slot{ EmptyKey, TValue() });
+		std::swap(old_slots, m_Slots);
+		const auto mask = capacity - 1;
+		for (auto& old_slot : old_slots)
+		{
+			if (EmptyKey == old_slot.key)
+			{
+				continue;
+			}
+			auto index = home_index(old_slot.key);
+			while (EmptyKey != m_Slots[index].key)
+			{
+				index = (index + 1) & mask;
+			}
+			m_Slots[index] = std::move(old_slot);
+		}
+	}
+}
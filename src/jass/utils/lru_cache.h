@@ -0,0 +1,107 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+namespace jass
+{
+	// Fixed capacity key-value cache that evicts the least recently used entry
+	template <typename TKey, typename TValue>
+	class lru_cache
+	{
+	public:
+		lru_cache(size_t capacity) : m_Capacity(capacity) {}
+
+		inline size_t size() const { return m_Entries.size(); }
+
+		inline size_t capacity() const { return m_Capacity; }
+
+		// Evicts least recently used entries that no longer fit
+		inline void set_capacity(size_t capacity);
+
+		inline void clear();
+
+		// Returns nullptr if key is not in cache. A hit marks the entry as most recently used.
+		inline const TValue* find(const TKey& key);
+
+		// Inserts or replaces the value for 'key', evicting the least recently used entry if full.
+		inline const TValue& insert(const TKey& key, TValue&& value);
+
+	private:
+		typedef std::list<std::pair<TKey, TValue>> entries_t;
+
+		size_t m_Capacity;
+		entries_t m_Entries;
+		std::unordered_map<TKey, typename entries_t::iterator> m_Index;
+	};
+
+	template <typename TKey, typename TValue>
+	inline void lru_cache<TKey, TValue>::clear()
+	{
+		m_Entries.clear();
+		m_Index.clear();
+	}
+
+	template <typename TKey, typename TValue>
+	inline void lru_cache<TKey, TValue>::set_capacity(size_t capacity)
+	{
+		m_Capacity = capacity;
+		while (m_Entries.size() > m_Capacity)
+		{
+			m_Index.erase(m_Entries.back().first);
+			m_Entries.pop_back();
+		}
+	}
+
+	template <typename TKey, typename TValue>
+	inline const TValue* lru_cache<TKey, TValue>::find(const TKey& key)
+	{
+		auto it = m_Index.find(key);
+		if (it == m_Index.end())
+		{
+			return nullptr;
+		}
+		m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+		return &it->second->second;
+	}
+
+	template <typename TKey, typename TValue>
+	inline const TValue& lru_cache<TKey, TValue>::insert(const TKey& key, TValue&& value)
+	{
+		auto it = m_Index.find(key);
+		if (it != m_Index.end())
+		{
+			it->second->second = std::move(value);
+			m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+			return it->second->second;
+		}
+		if (m_Entries.size() >= m_Capacity && !m_Entries.empty())
+		{
+			m_Index.erase(m_Entries.back().first);
+			m_Entries.pop_back();
+		}
+		m_Entries.emplace_front(key, std::move(value));
+		m_Index[key] = m_Entries.begin();
+		return m_Entries.front().second;
+	}
+}
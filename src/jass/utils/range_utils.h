@@ -19,7 +19,9 @@ with JASS. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <algorithm>
 #include <span>
+#include <utility>
 #include <vector>
 #include <jass/Debug.h>
 
@@ -177,6 +179,78 @@ namespace jass
 		ASSERT(insert_indices.size() + out_table.size() == n);
 	}
 
+	// Index moves, as (from, to) pairs, that remove 'remove_indices' from 'count' elements by moving
+	// elements from the end into the holes, instead of shifting every following element. Only
+	// O(remove_indices.size()) elements are touched. 'remove_indices' must be sorted.
+	template <class TIndex>
+	void build_remove_moves(TIndex count, const std::span<const TIndex>& remove_indices, std::vector<std::pair<TIndex, TIndex>>& out_moves)
+	{
+		out_moves.clear();
+		const auto new_count = (TIndex)(count - remove_indices.size());
+		auto it_hole = remove_indices.begin();
+		auto it_removed_from_end = std::lower_bound(remove_indices.begin(), remove_indices.end(), new_count);
+		for (TIndex from = new_count; from < count; ++from)
+		{
+			if (it_removed_from_end != remove_indices.end() && *it_removed_from_end == from)
+			{
+				++it_removed_from_end;
+				continue;
+			}
+			ASSERT(it_hole + 1 >= remove_indices.end() || *it_hole < *(it_hole + 1));  // Verify sorted
+			out_moves.push_back({ from, *it_hole++ });
+		}
+		ASSERT(it_removed_from_end == remove_indices.end());
+	}
+
+	// Inverse of build_remove_moves: moves that make room for 'insert_indices', the indices of new
+	// elements AFTER insertion, by moving the elements at those indices to the end. Removing and
+	// then inserting the same indices restores the original order. 'insert_indices' must be sorted.
+	template <class TIndex>
+	void build_insert_moves(TIndex count, const std::span<const TIndex>& insert_indices, std::vector<std::pair<TIndex, TIndex>>& out_moves)
+	{
+		out_moves.clear();
+		const auto new_count = (TIndex)(count + insert_indices.size());
+		auto it_hole = insert_indices.begin();
+		auto it_inserted_at_end = std::lower_bound(insert_indices.begin(), insert_indices.end(), count);
+		for (TIndex to = count; to < new_count; ++to)
+		{
+			if (it_inserted_at_end != insert_indices.end() && *it_inserted_at_end == to)
+			{
+				++it_inserted_at_end;
+				continue;
+			}
+			ASSERT(it_hole + 1 >= insert_indices.end() || *it_hole < *(it_hole + 1));  // Verify sorted
+			out_moves.push_back({ *it_hole++, to });
+		}
+		ASSERT(it_inserted_at_end == insert_indices.end());
+	}
+
+	// Applies moves from build_remove_moves
+	template <class T, class TIndex>
+	void remove_by_moves(std::vector<T>& v, const std::span<const std::pair<TIndex, TIndex>>& moves, size_t new_size)
+	{
+		for (const auto& move : moves)
+		{
+			v[move.second] = std::move(v[move.first]);
+		}
+		v.resize(new_size);
+	}
+
+	// Applies moves from build_insert_moves, and sets new elements to 'empty_value'
+	template <class T, class TIndex>
+	void insert_by_moves(std::vector<T>& v, const std::span<const TIndex>& insert_indices, const std::span<const std::pair<TIndex, TIndex>>& moves, T empty_value = T())
+	{
+		v.resize(v.size() + insert_indices.size());
+		for (const auto& move : moves)
+		{
+			v[move.second] = std::move(v[move.first]);
+		}
+		for (const auto index : insert_indices)
+		{
+			v[index] = empty_value;
+		}
+	}
+
 	template <class TIndex>
 	void remap_indices(const std::span<TIndex>& indices, const std::span<const TIndex>& remap_table)
 	{
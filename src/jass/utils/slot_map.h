@@ -0,0 +1,175 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <jass/Debug.h>
+
+namespace jass
+{
+	// Handle to a slot_map element. Stays valid until the element is erased, after which
+	// lookups fail even if the slot has been reused, since the generation no longer matches.
+	struct slot_map_handle
+	{
+		uint32_t index = (uint32_t)-1;
+		uint32_t generation = 0;
+
+		inline bool operator==(const slot_map_handle& rhs) const { return index == rhs.index && generation == rhs.generation; }
+		inline bool operator!=(const slot_map_handle& rhs) const { return !(*this == rhs); }
+	};
+
+	// Values are stored densely in insertion order, except that erase moves the last value into
+	// the hole. Handles resolve through a slot table, and freed slots are reused via a free list.
+	template <typename T>
+	class slot_map
+	{
+	public:
+		typedef slot_map_handle handle;
+
+		inline size_t size() const { return m_Values.size(); }
+
+		inline bool empty() const { return m_Values.empty(); }
+
+		inline void clear();
+
+		inline handle insert(T value);
+
+		// Returns false if handle is stale
+		inline bool erase(handle h);
+
+		inline bool contains(handle h) const { return nullptr != find(h); }
+
+		// Returns nullptr if handle is stale
+		inline const T* find(handle h) const;
+		inline T* find(handle h);
+
+		inline std::span<const T> values() const { return m_Values; }
+		inline std::span<T> values() { return m_Values; }
+
+		// Handle of the value at 'dense_index' in values()
+		inline handle handle_at(size_t dense_index) const;
+
+	private:
+		static constexpr uint32_t END_OF_FREE_LIST = (uint32_t)-1;
+
+		struct slot
+		{
+			uint32_t dense_index_or_next_free;
+			uint32_t generation;
+		};
+
+		std::vector<slot> m_Slots;
+		std::vector<T> m_Values;
+		std::vector<uint32_t> m_DenseToSlot;
+		uint32_t m_FirstFreeSlot = END_OF_FREE_LIST;
+	};
+
+	template <typename T>
+	inline void slot_map<T>::clear()
+	{
+		// Bump generations so that outstanding handles become stale
+		for (const auto slot_index : m_DenseToSlot)
+		{
+			auto& s = m_Slots[slot_index];
+			++s.generation;
+			s.dense_index_or_next_free = m_FirstFreeSlot;
+			m_FirstFreeSlot = slot_index;
+		}
+		m_Values.clear();
+		m_DenseToSlot.clear();
+	}
+
+	template <typename T>
+	inline typename slot_map<T>::handle slot_map<T>::insert(T value)
+	{
+		uint32_t slot_index;
+		if (END_OF_FREE_LIST != m_FirstFreeSlot)
+		{
+			slot_index = m_FirstFreeSlot;
+			m_FirstFreeSlot = m_Slots[slot_index].dense_index_or_next_free;
+		}
+		else
+		{
+			slot_index = (uint32_t)m_Slots.size();
+			m_Slots.push_back({ 0, 0 });
+		}
+
+		auto& s = m_Slots[slot_index];
+		s.dense_index_or_next_free = (uint32_t)m_Values.size();
+		m_Values.push_back(std::move(value));
+		m_DenseToSlot.push_back(slot_index);
+
+		return handle{ slot_index, s.generation };
+	}
+
+	template <typename T>
+	inline bool slot_map<T>::erase(handle h)
+	{
+		if (!contains(h))
+		{
+			return false;
+		}
+
+		auto& s = m_Slots[h.index];
+		const auto dense_index = s.dense_index_or_next_free;
+		const auto last_dense_index = (uint32_t)m_Values.size() - 1;
+		if (dense_index != last_dense_index)
+		{
+			m_Values[dense_index] = std::move(m_Values[last_dense_index]);
+			m_DenseToSlot[dense_index] = m_DenseToSlot[last_dense_index];
+			m_Slots[m_DenseToSlot[dense_index]].dense_index_or_next_free = dense_index;
+		}
+		m_Values.pop_back();
+		m_DenseToSlot.pop_back();
+
+		++s.generation;
+		s.dense_index_or_next_free = m_FirstFreeSlot;
+		m_FirstFreeSlot = h.index;
+
+		return true;
+	}
+
+	template <typename T>
+	inline const T* slot_map<T>::find(handle h) const
+	{
+		if (h.index >= m_Slots.size())
+		{
+			return nullptr;
+		}
+		const auto& s = m_Slots[h.index];
+		return (s.generation == h.generation) ? &m_Values[s.dense_index_or_next_free] : nullptr;
+	}
+
+	template <typename T>
+	inline T* slot_map<T>::find(handle h)
+	{
+		return const_cast<T*>(const_cast<const slot_map<T>*>(this)->find(h));
+	}
+
+	template <typename T>
+	inline typename slot_map<T>::handle slot_map<T>::handle_at(size_t dense_index) const
+	{
+		ASSERT(dense_index < m_DenseToSlot.size());
+		const auto slot_index = m_DenseToSlot[dense_index];
+		return handle{ slot_index, m_Slots[slot_index].generation };
+	}
+}
@@ -0,0 +1,355 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include <jass/Debug.h>
+
+#include "bitvec.h"
+
+namespace jass
+{
+	// Compressed bit set for masks where only a few bits out of a large index space are set.
+	// The index space is split into chunks of 2^16 bits. Only chunks with set bits are stored,
+	// each either as a sorted array of 16-bit offsets or, once it gets dense, as a plain bitmap.
+	// Memory and iteration cost is proportional to the number of set bits rather than to the
+	// highest index.
+	class sparse_bitvec
+	{
+	public:
+		inline void clear();
+
+		inline bool empty() const { return m_Chunks.empty(); }
+
+		inline void set(size_t index);
+
+		inline void set(size_t index, bool set);
+
+		inline void clear(size_t index);
+
+		inline bool get(size_t index) const;
+
+		inline bool operator[](size_t index) const { return get(index); }
+
+		// Sets bits [first, first + count)
+		inline void set_range(size_t first, size_t count);
+
+		inline size_t count_set_bits() const;
+
+		// Calls fn(index) for every set bit, in increasing order
+		template <class TLambda>
+		void for_each_set_bit(TLambda&& fn) const;
+
+		inline void assign(const bitvec& bits);
+
+		// Sets the corresponding bits in 'bits', which must be large enough to hold all set bits
+		inline void copy_to(bitvec& bits) const;
+
+	private:
+		typedef uint64_t word_t;
+
+		static constexpr size_t CHUNK_BIT_COUNT = 16;
+		static constexpr size_t CHUNK_SIZE = (size_t)1 << CHUNK_BIT_COUNT;
+		static constexpr size_t WORD_BIT_COUNT = sizeof(word_t) * 8;
+		static constexpr size_t BITMAP_WORD_COUNT = CHUNK_SIZE / WORD_BIT_COUNT;
+		static constexpr size_t MAX_ARRAY_SIZE = 4096;  // Where an array outgrows a bitmap (8 KB)
+
+		struct chunk
+		{
+			size_t key;                   // index >> CHUNK_BIT_COUNT
+			size_t count = 0;
+			std::vector<uint16_t> values; // Sorted, used while words is empty
+			std::vector<word_t> words;    // BITMAP_WORD_COUNT words, or empty
+
+			inline bool is_bitmap() const { return !words.empty(); }
+		};
+
+		inline const chunk* find_chunk(size_t key) const;
+
+		inline chunk& find_or_add_chunk(size_t key);
+
+		inline static void convert_to_bitmap(chunk& c);
+
+		inline static void convert_to_array(chunk& c);
+
+		std::vector<chunk> m_Chunks;  // Sorted by key
+	};
+
+	inline void sparse_bitvec::clear()
+	{
+		m_Chunks.clear();
+	}
+
+	inline void sparse_bitvec::set(size_t index)
+	{
+		auto& c = find_or_add_chunk(index >> CHUNK_BIT_COUNT);
+		const auto offset = (uint16_t)(index & (CHUNK_SIZE - 1));
+		if (c.is_bitmap())
+		{
+			auto& word = c.words[offset / WORD_BIT_COUNT];
+			const auto mask = (word_t)1 << (offset % WORD_BIT_COUNT);
+			c.count += (word & mask) ? 0 : 1;
+			word |= mask;
+			return;
+		}
+		auto it = std::lower_bound(c.values.begin(), c.values.end(), offset);
+		if (it != c.values.end() && *it == offset)
+		{
+			return;
+		}
+		c.values.insert(it, offset);
+		++c.count;
+		if (c.count > MAX_ARRAY_SIZE)
+		{
+			convert_to_bitmap(c);
+		}
+	}
+
+	inline void sparse_bitvec::set(size_t index, bool set)
+	{
+		if (set)
+		{
+			this->set(index);
+		}
+		else
+		{
+			clear(index);
+		}
+	}
+
+	inline void sparse_bitvec::clear(size_t index)
+	{
+		const auto key = index >> CHUNK_BIT_COUNT;
+		auto chunk_it = std::lower_bound(m_Chunks.begin(), m_Chunks.end(), key, [](const chunk& c, size_t key) { return c.key < key; });
+		if (chunk_it == m_Chunks.end() || chunk_it->key != key)
+		{
+			return;
+		}
+		auto& c = *chunk_it;
+		const auto offset = (uint16_t)(index & (CHUNK_SIZE - 1));
+		if (c.is_bitmap())
+		{
+			auto& word = c.words[offset / WORD_BIT_COUNT];
+			const auto mask = (word_t)1 << (offset % WORD_BIT_COUNT);
+			c.count -= (word & mask) ? 1 : 0;
+			word &= ~mask;
+			// Convert back well below the threshold, so that toggling a bit at the boundary
+			// does not convert back and forth.
+			if (c.count <= MAX_ARRAY_SIZE / 2)
+			{
+				convert_to_array(c);
+			}
+		}
+		else
+		{
+			auto it = std::lower_bound(c.values.begin(), c.values.end(), offset);
+			if (it == c.values.end() || *it != offset)
+			{
+				return;
+			}
+			c.values.erase(it);
+			--c.count;
+		}
+		if (0 == c.count)
+		{
+			m_Chunks.erase(chunk_it);
+		}
+	}
+
+	inline bool sparse_bitvec::get(size_t index) const
+	{
+		const auto* c = find_chunk(index >> CHUNK_BIT_COUNT);
+		if (!c)
+		{
+			return false;
+		}
+		const auto offset = (uint16_t)(index & (CHUNK_SIZE - 1));
+		if (c->is_bitmap())
+		{
+			return 0 != (c->words[offset / WORD_BIT_COUNT] & ((word_t)1 << (offset % WORD_BIT_COUNT)));
+		}
+		return std::binary_search(c->values.begin(), c->values.end(), offset);
+	}
+
+	inline void sparse_bitvec::set_range(size_t first, size_t count)
+	{
+		const auto end = first + count;
+		while (first < end)
+		{
+			const auto key = first >> CHUNK_BIT_COUNT;
+			const auto chunk_begin = key << CHUNK_BIT_COUNT;
+			const auto lo = first - chunk_begin;
+			const auto hi = std::min(end - chunk_begin, CHUNK_SIZE);
+			first = chunk_begin + hi;
+
+			auto& c = find_or_add_chunk(key);
+			if (!c.is_bitmap() && c.count + (hi - lo) <= MAX_ARRAY_SIZE)
+			{
+				// Merge the run into the sorted array
+				std::vector<uint16_t> merged;
+				merged.reserve(c.count + (hi - lo));
+				auto it = c.values.begin();
+				for (; it != c.values.end() && *it < lo; ++it)
+				{
+					merged.push_back(*it);
+				}
+				for (auto offset = lo; offset < hi; ++offset)
+				{
+					merged.push_back((uint16_t)offset);
+				}
+				for (; it != c.values.end(); ++it)
+				{
+					if (*it >= hi)
+					{
+						merged.push_back(*it);
+					}
+				}
+				c.values = std::move(merged);
+				c.count = c.values.size();
+				continue;
+			}
+
+			if (!c.is_bitmap())
+			{
+				convert_to_bitmap(c);
+			}
+			const auto first_word = lo / WORD_BIT_COUNT;
+			const auto last_word = (hi - 1) / WORD_BIT_COUNT;
+			for (auto w = first_word; w <= last_word; ++w)
+			{
+				auto mask = (word_t)-1;
+				if (w == first_word)
+				{
+					mask &= (word_t)-1 << (lo % WORD_BIT_COUNT);
+				}
+				if (w == last_word)
+				{
+					mask &= (word_t)-1 >> (WORD_BIT_COUNT - 1 - (hi - 1) % WORD_BIT_COUNT);
+				}
+				c.count += std::popcount(mask & ~c.words[w]);
+				c.words[w] |= mask;
+			}
+		}
+	}
+
+	inline size_t sparse_bitvec::count_set_bits() const
+	{
+		size_t count = 0;
+		for (const auto& c : m_Chunks)
+		{
+			count += c.count;
+		}
+		return count;
+	}
+
+	template <class TLambda>
+	void sparse_bitvec::for_each_set_bit(TLambda&& fn) const
+	{
+		for (const auto& c : m_Chunks)
+		{
+			const auto chunk_begin = c.key << CHUNK_BIT_COUNT;
+			if (!c.is_bitmap())
+			{
+				for (const auto offset : c.values)
+				{
+					fn(chunk_begin + offset);
+				}
+				continue;
+			}
+			for (size_t word_index = 0; word_index < BITMAP_WORD_COUNT; ++word_index)
+			{
+				for (auto w = c.words[word_index]; w; w &= w - 1)
+				{
+					fn(chunk_begin + word_index * WORD_BIT_COUNT + std::countr_zero(w));
+				}
+			}
+		}
+	}
+
+	inline void sparse_bitvec::assign(const bitvec& bits)
+	{
+		clear();
+		bits.for_each_set_bit_run([&](size_t first, size_t count)
+			{
+				set_range(first, count);
+			});
+	}
+
+	inline void sparse_bitvec::copy_to(bitvec& bits) const
+	{
+		for_each_set_bit([&](size_t index)
+			{
+				bits.set(index);
+			});
+	}
+
+	inline const sparse_bitvec::chunk* sparse_bitvec::find_chunk(size_t key) const
+	{
+		auto it = std::lower_bound(m_Chunks.begin(), m_Chunks.end(), key, [](const chunk& c, size_t key) { return c.key < key; });
+		return (it != m_Chunks.end() && it->key == key) ? &*it : nullptr;
+	}
+
+	inline sparse_bitvec::chunk& sparse_bitvec::find_or_add_chunk(size_t key)
+	{
+		// Bits are usually set in increasing order, so check the last chunk first
+		if (!m_Chunks.empty() && m_Chunks.back().key == key)
+		{
+			return m_Chunks.back();
+		}
+		auto it = std::lower_bound(m_Chunks.begin(), m_Chunks.end(), key, [](const chunk& c, size_t key) { return c.key < key; });
+		if (it != m_Chunks.end() && it->key == key)
+		{
+			return *it;
+		}
+		it = m_Chunks.insert(it, chunk());
+		it->key = key;
+		return *it;
+	}
+
+	inline void sparse_bitvec::convert_to_bitmap(chunk& c)
+	{
+		ASSERT(!c.is_bitmap());
+		c.words.assign(BITMAP_WORD_COUNT, 0);
+		for (const auto offset : c.values)
+		{
+			c.words[offset / WORD_BIT_COUNT] |= (word_t)1 << (offset % WORD_BIT_COUNT);
+		}
+		c.values = std::vector<uint16_t>();
+	}
+
+	inline void sparse_bitvec::convert_to_array(chunk& c)
+	{
+		ASSERT(c.is_bitmap());
+		c.values.clear();
+		c.values.reserve(c.count);
+		for (size_t word_index = 0; word_index < BITMAP_WORD_COUNT; ++word_index)
+		{
+			for (auto w = c.words[word_index]; w; w &= w - 1)
+			{
+				c.values.push_back((uint16_t)(word_index * WORD_BIT_COUNT + std::countr_zero(w)));
+			}
+		}
+		c.words = std::vector<word_t>();
+	}
+}
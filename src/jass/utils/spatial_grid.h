@@ -0,0 +1,476 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <jass/Debug.h>
+
+#include "flat_hash_map.h"
+
+namespace jass
+{
+	// Uniform grid of square cells over axis aligned boxes, addressed by dense item index. Cells
+	// are hashed, so the grid is unbounded and only occupied cells take up memory. An item is
+	// listed in every cell its box overlaps, except items covering very many cells, which are
+	// kept in a separate list that every query visits.
+	class spatial_grid
+	{
+	public:
+		typedef uint32_t index_t;
+
+		static constexpr index_t npos = (index_t)-1;
+
+		struct box
+		{
+			float x0, y0, x1, y1;
+		};
+
+		inline float cell_size() const { return m_CellSize; }
+
+		// Number of item indices, whether present in the grid or not
+		inline size_t size() const { return m_Items.size(); }
+
+		// Removes all items
+		inline void reset(float cell_size, size_t size);
+
+		// New indices are empty, and items at removed indices are erased
+		inline void resize(size_t size);
+
+		inline bool contains(index_t index) const { return m_Items[index].present(); }
+
+		inline void insert(index_t index, const box& b);
+
+		inline void erase(index_t index);
+
+		// Same as erase followed by insert, but cheap when the item stays within the same cells
+		inline void update(index_t index, const box& b);
+
+		// Moves the item at 'from' to 'to', which must be empty, leaving 'from' empty
+		inline void move(index_t from, index_t to);
+
+		// Moves item i to index remap_table[i], or erases it if remap_table[i] is npos. Indices
+		// not in the range of the table are left empty.
+		inline void remap(std::span<const index_t> remap_table, size_t new_size);
+
+		// Calls fn(index) once for every item listed in a cell overlapping 'b', which is a superset
+		// of the items with boxes overlapping 'b'. Not reentrant, even though const.
+		template <typename TFunc>
+		inline void query(const box& b, TFunc&& fn) const;
+
+		// Returns the item with the smallest distance(index) not greater than 'max_distance', or
+		// npos. distance(index) must not be less than the distance from (x, y) to the item's box.
+		template <typename TDistance>
+		inline index_t nearest(float x, float y, float max_distance, TDistance&& distance) const;
+
+	private:
+		typedef flat_hash_map<std::vector<index_t>>::key_type cell_key_t;
+
+		static constexpr int32_t MAX_CELL_COORD = 1 << 30;
+		static constexpr int64_t MAX_CELLS_PER_ITEM = 256;
+
+		struct cell_range
+		{
+			int32_t x0 = 1, y0 = 1, x1 = 0, y1 = 0;
+			bool oversized = false;
+
+			inline bool present() const { return x0 <= x1; }
+			inline int64_t cell_count() const { return ((int64_t)x1 - x0 + 1) * ((int64_t)y1 - y0 + 1); }
+			inline bool operator==(const cell_range& rhs) const { return x0 == rhs.x0 && y0 == rhs.y0 && x1 == rhs.x1 && y1 == rhs.y1; }
+		};
+
+		inline int32_t cell_coord(float v) const;
+
+		inline cell_range cell_range_from_box(const box& b) const;
+
+		// Offsetting coordinates to be non-negative keeps keys clear of the reserved empty key
+		inline static cell_key_t cell_key(int32_t x, int32_t y) { return ((cell_key_t)(x + MAX_CELL_COORD) << 32) | (cell_key_t)(y + MAX_CELL_COORD); }
+		inline static int32_t cell_key_x(cell_key_t key) { return (int32_t)(key >> 32) - MAX_CELL_COORD; }
+		inline static int32_t cell_key_y(cell_key_t key) { return (int32_t)(key & 0xFFFFFFFF) - MAX_CELL_COORD; }
+
+		inline void add_to_cells(index_t index, const cell_range& range);
+
+		inline void remove_from_cells(index_t index, const cell_range& range);
+
+		template <typename TFunc>
+		inline void for_each_cell_in_range(const cell_range& range, TFunc&& fn) const;
+
+		inline void begin_visit() const;
+
+		inline bool visit(index_t index) const;
+
+		float m_CellSize = 1;
+		std::vector<cell_range> m_Items;
+		flat_hash_map<std::vector<index_t>> m_Cells;
+		std::vector<index_t> m_OversizedItems;
+		mutable std::vector<uint32_t> m_VisitStamps;
+		mutable uint32_t m_VisitStamp = 0;
+	};
+
+	inline void spatial_grid::reset(float cell_size, size_t size)
+	{
+		ASSERT(cell_size > 0);
+		m_CellSize = cell_size;
+		m_Items.clear();
+		m_Items.resize(size);
+		m_Cells = decltype(m_Cells)();
+		m_OversizedItems.clear();
+		m_VisitStamps.clear();
+		m_VisitStamps.resize(size, 0);
+		m_VisitStamp = 0;
+	}
+
+	inline void spatial_grid::resize(size_t size)
+	{
+		for (auto index = size; index < m_Items.size(); ++index)
+		{
+			erase((index_t)index);
+		}
+		m_Items.resize(size);
+		m_VisitStamps.resize(size, 0);
+	}
+
+	inline void spatial_grid::insert(index_t index, const box& b)
+	{
+		auto& item = m_Items[index];
+		ASSERT(!item.present());
+		item = cell_range_from_box(b);
+		add_to_cells(index, item);
+	}
+
+	inline void spatial_grid::erase(index_t index)
+	{
+		auto& item = m_Items[index];
+		if (item.present())
+		{
+			remove_from_cells(index, item);
+			item = cell_range();
+		}
+	}
+
+	inline void spatial_grid::update(index_t index, const box& b)
+	{
+		auto& item = m_Items[index];
+		const auto range = cell_range_from_box(b);
+		if (item.present() && range == item)
+		{
+			return;
+		}
+		erase(index);
+		item = range;
+		add_to_cells(index, item);
+	}
+
+	inline void spatial_grid::move(index_t from, index_t to)
+	{
+		ASSERT(!m_Items[to].present());
+		const auto item = m_Items[from];
+		if (!item.present())
+		{
+			return;
+		}
+		auto replace_index = [&](std::vector<index_t>& indices)
+			{
+				auto it = std::find(indices.begin(), indices.end(), from);
+				ASSERT(it != indices.end());
+				*it = to;
+			};
+		if (item.oversized)
+		{
+			replace_index(m_OversizedItems);
+		}
+		else
+		{
+			for_each_cell_in_range(item, [&](cell_key_t key)
+				{
+					auto* indices = m_Cells.find(key);
+					ASSERT(indices);
+					replace_index(*indices);
+				});
+		}
+		m_Items[to] = item;
+		m_Items[from] = cell_range();
+	}
+
+	inline void spatial_grid::remap(std::span<const index_t> remap_table, size_t new_size)
+	{
+		auto remap_index = [&](index_t index) { return index < remap_table.size() ? remap_table[index] : npos; };
+
+		std::vector<cell_key_t> empty_cells;
+		m_Cells.for_each([&](cell_key_t key, std::vector<index_t>& indices)
+			{
+				size_t to = 0;
+				for (const auto index : indices)
+				{
+					const auto new_index = remap_index(index);
+					if (npos != new_index)
+					{
+						indices[to++] = new_index;
+					}
+				}
+				indices.resize(to);
+				if (indices.empty())
+				{
+					empty_cells.push_back(key);
+				}
+			});
+		for (const auto key : empty_cells)
+		{
+			m_Cells.erase(key);
+		}
+
+		size_t to = 0;
+		for (const auto index : m_OversizedItems)
+		{
+			const auto new_index = remap_index(index);
+			if (npos != new_index)
+			{
+				m_OversizedItems[to++] = new_index;
+			}
+		}
+		m_OversizedItems.resize(to);
+
+		std::vector<cell_range> new_items(new_size);
+		for (index_t index = 0; index < (index_t)m_Items.size(); ++index)
+		{
+			const auto new_index = remap_index(index);
+			if (npos != new_index)
+			{
+				new_items[new_index] = m_Items[index];
+			}
+		}
+		m_Items = std::move(new_items);
+		m_VisitStamps.resize(new_size, 0);
+	}
+
+	template <typename TFunc>
+	inline void spatial_grid::query(const box& b, TFunc&& fn) const
+	{
+		begin_visit();
+
+		const auto range = cell_range_from_box(b);
+		auto visit_cell = [&](const std::vector<index_t>& indices)
+			{
+				for (const auto index : indices)
+				{
+					if (visit(index))
+					{
+						fn(index);
+					}
+				}
+			};
+
+		if (range.cell_count() > (int64_t)m_Cells.size())
+		{
+			// Cheaper to test every occupied cell than to look up every cell in range
+			m_Cells.for_each([&](cell_key_t key, const std::vector<index_t>& indices)
+				{
+					const auto x = cell_key_x(key);
+					const auto y = cell_key_y(key);
+					if (x >= range.x0 && x <= range.x1 && y >= range.y0 && y <= range.y1)
+					{
+						visit_cell(indices);
+					}
+				});
+		}
+		else
+		{
+			for_each_cell_in_range(range, [&](cell_key_t key)
+				{
+					if (const auto* indices = m_Cells.find(key))
+					{
+						visit_cell(*indices);
+					}
+				});
+		}
+
+		visit_cell(m_OversizedItems);
+	}
+
+	template <typename TDistance>
+	inline spatial_grid::index_t spatial_grid::nearest(float x, float y, float max_distance, TDistance&& distance) const
+	{
+		index_t best_index = npos;
+		float best_distance = max_distance;
+		auto test = [&](index_t index)
+			{
+				const float d = distance(index);
+				if (d <= best_distance)
+				{
+					best_distance = d;
+					best_index = index;
+				}
+			};
+
+		// Search rings of cells around the cell of (x, y). Cells of ring r are at least (r - 1)
+		// cells away from (x, y), so we are done once the best distance is within that.
+		begin_visit();
+		const auto cx = cell_coord(x);
+		const auto cy = cell_coord(y);
+		auto test_cell = [&](int32_t cell_x, int32_t cell_y)
+			{
+				if (const auto* indices = m_Cells.find(cell_key(cell_x, cell_y)))
+				{
+					for (const auto index : *indices)
+					{
+						if (visit(index))
+						{
+							test(index);
+						}
+					}
+				}
+			};
+		const auto max_ring = (int32_t)std::min<float>(std::ceil(max_distance / m_CellSize), (float)MAX_CELL_COORD);
+		for (int32_t ring = 0; ring <= max_ring; ++ring)
+		{
+			if (npos != best_index && best_distance <= (ring - 1) * m_CellSize)
+			{
+				break;
+			}
+			const auto ring_width = 2 * (int64_t)ring + 1;
+			if (ring_width * ring_width > (int64_t)m_Cells.size() * 4)
+			{
+				// Rings have outgrown the occupied cells, settle for a single query
+				query({ x - best_distance, y - best_distance, x + best_distance, y + best_distance }, test);
+				return best_index;
+			}
+			if (0 == ring)
+			{
+				test_cell(cx, cy);
+				continue;
+			}
+			for (auto cell_x = cx - ring; cell_x <= cx + ring; ++cell_x)
+			{
+				test_cell(cell_x, cy - ring);
+				test_cell(cell_x, cy + ring);
+			}
+			for (auto cell_y = cy - ring + 1; cell_y < cy + ring; ++cell_y)
+			{
+				test_cell(cx - ring, cell_y);
+				test_cell(cx + ring, cell_y);
+			}
+		}
+
+		for (const auto index : m_OversizedItems)
+		{
+			test(index);
+		}
+
+		return best_index;
+	}
+
+	inline int32_t spatial_grid::cell_coord(float v) const
+	{
+		const float c = std::floor(v / m_CellSize);
+		return (c != c) ? 0 : (int32_t)std::clamp(c, (float)-MAX_CELL_COORD, (float)(MAX_CELL_COORD - 1));
+	}
+
+	inline spatial_grid::cell_range spatial_grid::cell_range_from_box(const box& b) const
+	{
+		cell_range range;
+		range.x0 = cell_coord(std::min(b.x0, b.x1));
+		range.y0 = cell_coord(std::min(b.y0, b.y1));
+		range.x1 = cell_coord(std::max(b.x0, b.x1));
+		range.y1 = cell_coord(std::max(b.y0, b.y1));
+		return range;
+	}
+
+	inline void spatial_grid::add_to_cells(index_t index, const cell_range& range)
+	{
+		auto& item = m_Items[index];
+		item.oversized = range.cell_count() > MAX_CELLS_PER_ITEM;
+		if (item.oversized)
+		{
+			m_OversizedItems.push_back(index);
+			return;
+		}
+		for_each_cell_in_range(range, [&](cell_key_t key)
+			{
+				auto* indices = m_Cells.find(key);
+				if (!indices)
+				{
+					m_Cells.insert(key, std::vector<index_t>());
+					indices = m_Cells.find(key);
+				}
+				indices->push_back(index);
+			});
+	}
+
+	inline void spatial_grid::remove_from_cells(index_t index, const cell_range& range)
+	{
+		auto remove_index = [&](std::vector<index_t>& indices)
+			{
+				auto it = std::find(indices.begin(), indices.end(), index);
+				ASSERT(it != indices.end());
+				*it = indices.back();
+				indices.pop_back();
+			};
+
+		if (m_Items[index].oversized)
+		{
+			remove_index(m_OversizedItems);
+			return;
+		}
+		for_each_cell_in_range(range, [&](cell_key_t key)
+			{
+				auto* indices = m_Cells.find(key);
+				ASSERT(indices);
+				remove_index(*indices);
+				if (indices->empty())
+				{
+					m_Cells.erase(key);
+				}
+			});
+	}
+
+	template <typename TFunc>
+	inline void spatial_grid::for_each_cell_in_range(const cell_range& range, TFunc&& fn) const
+	{
+		for (auto y = range.y0; y <= range.y1; ++y)
+		{
+			for (auto x = range.x0; x <= range.x1; ++x)
+			{
+				fn(cell_key(x, y));
+			}
+		}
+	}
+
+	inline void spatial_grid::begin_visit() const
+	{
+		if (0 == ++m_VisitStamp)
+		{
+			std::fill(m_VisitStamps.begin(), m_VisitStamps.end(), 0);
+			m_VisitStamp = 1;
+		}
+	}
+
+	inline bool spatial_grid::visit(index_t index) const
+	{
+		if (m_VisitStamps[index] == m_VisitStamp)
+		{
+			return false;
+		}
+		m_VisitStamps[index] = m_VisitStamp;
+		return true;
+	}
+}
@@ -0,0 +1,150 @@
+/*
+Copyright Ioanna Stavroulaki 2023
+
+This file is part of JASS.
+
+JASS is free software: you can redistribute it and/or modify it under 
+the terms of the GNU General Public License as published by the Free
+Software Foundation, either version 3 of the License, or (at your option)
+any later version.
+
+JASS is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License along 
+with JASS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <jass/Debug.h>
+
+#include "flat_hash_map.h"
+
+namespace jass
+{
+	// Append-only arena of interned UTF-16 strings. Equal strings get the same 32-bit id, and id 0
+	// is always the empty string. Strings are never freed, as the set of distinct strings, such as
+	// node names, stays small compared to the number of references to them.
+	class string_pool
+	{
+	public:
+		typedef uint32_t id_t;
+
+		static constexpr id_t empty_id = 0;
+		static constexpr id_t npos = (id_t)-1;
+
+		inline string_pool() { clear(); }
+
+		// Number of distinct strings, including the empty string
+		inline size_t size() const { return m_Entries.size(); }
+
+		inline void clear();
+
+		inline id_t intern(std::u16string_view s);
+
+		// Returns npos if 's' has not been interned
+		inline id_t find(std::u16string_view s) const;
+
+		// Only valid until the next call to intern
+		inline std::u16string_view view(id_t id) const;
+
+	private:
+		typedef flat_hash_map<id_t>::key_type hash_t;
+
+		static constexpr hash_t EMPTY_HASH = (hash_t)-1;  // Reserved by flat_hash_map
+
+		struct entry
+		{
+			uint32_t offset;
+			uint32_t length;
+			id_t next_with_same_hash;  // empty_id ends the chain
+		};
+
+		inline static hash_t hash(std::u16string_view s);
+
+		std::vector<char16_t> m_Chars;
+		std::vector<entry> m_Entries;
+		flat_hash_map<id_t> m_FirstIdByHash;
+	};
+
+	inline void string_pool::clear()
+	{
+		m_Chars.clear();
+		m_Entries.clear();
+		m_Entries.push_back({ 0, 0, empty_id });
+		m_FirstIdByHash.clear();
+	}
+
+	inline string_pool::id_t string_pool::intern(std::u16string_view s)
+	{
+		if (s.empty())
+		{
+			return empty_id;
+		}
+
+		const auto h = hash(s);
+		auto* first_id = m_FirstIdByHash.find(h);
+		for (auto id = first_id ? *first_id : empty_id; empty_id != id; id = m_Entries[id].next_with_same_hash)
+		{
+			if (view(id) == s)
+			{
+				return id;
+			}
+		}
+
+		ASSERT(m_Chars.size() + s.size() < (size_t)UINT32_MAX && m_Entries.size() < (size_t)npos);
+		const auto new_id = (id_t)m_Entries.size();
+		m_Entries.push_back({ (uint32_t)m_Chars.size(), (uint32_t)s.size(), first_id ? *first_id : empty_id });
+		m_Chars.insert(m_Chars.end(), s.begin(), s.end());
+		if (first_id)
+		{
+			*first_id = new_id;
+		}
+		else
+		{
+			m_FirstIdByHash.insert(h, new_id);
+		}
+		return new_id;
+	}
+
+	inline string_pool::id_t string_pool::find(std::u16string_view s) const
+	{
+		if (s.empty())
+		{
+			return empty_id;
+		}
+
+		const auto* first_id = m_FirstIdByHash.find(hash(s));
+		for (auto id = first_id ? *first_id : empty_id; empty_id != id; id = m_Entries[id].next_with_same_hash)
+		{
+			if (view(id) == s)
+			{
+				return id;
+			}
+		}
+		return npos;
+	}
+
+	inline std::u16string_view string_pool::view(id_t id) const
+	{
+		const auto& e = m_Entries[id];
+		return std::u16string_view(m_Chars.data() + e.offset, e.length);
+	}
+
+	inline string_pool::hash_t string_pool::hash(std::u16string_view s)
+	{
+		// FNV-1a
+		hash_t h = 0xcbf29ce484222325ull;
+		for (const auto c : s)
+		{
+			h = (h ^ (hash_t)c) * 0x100000001b3ull;
+		}
+		return (EMPTY_HASH == h) ? h - 1 : h;
+	}
+}